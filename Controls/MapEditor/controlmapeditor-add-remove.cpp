@@ -18,6 +18,8 @@
 */
 
 #include "controlmapeditor.h"
+#include <QBitArray>
+#include <QStack>
 
 // -------------------------------------------------------
 
@@ -48,7 +50,9 @@ void ControlMapEditor::addRemove(MapEditorSelectionKind selection,
         }
     }
 
-    // Avoid pointing to a deleted element before the next raycasting
+    // Avoid pointing to a deleted element before the next raycasting, the
+    // land one being only a copy
+    delete m_elementOnLand;
     m_elementOnLand = nullptr;
     m_elementOnSprite = nullptr;
 }
@@ -131,32 +135,22 @@ void ControlMapEditor::addLand(Position& p, MapEditorSubSelectionKind kind,
         return;
 
     LandDatas* land;
-    QRect* shortTexture;
     bool up = m_camera->cameraUp();
 
     // Pencil
     switch (drawKind) {
     case DrawKind::Pencil:
     {
+        MapEditTransaction transaction;
         if (tileset.width() == 1 && tileset.height() == 1) {
             QList<Position> positions;
             traceLine(m_previousMouseCoords, p, positions);
             for (int i = 0; i < positions.size(); i++) {
-                QRect* rect = new QRect(tileset.x(),
-                                        tileset.y(),
-                                        tileset.width(),
-                                        tileset.height());
-                switch (kind) {
-                case MapEditorSubSelectionKind::Floors:
-                    land = new FloorDatas(rect, up);
-                    break;
-                case MapEditorSubSelectionKind::Autotiles:
-                    land = new AutotileDatas(specialID, rect, up);
-                    break;
-                default:
-                    break;
+                land = getLandAfter(kind, specialID, tileset, up);
+                if (land != nullptr) {
+                    transaction.add(positions[i], MapEditorSelectionKind::Land,
+                                    kind, land);
                 }
-                stockLand(positions[i], land, kind, layerOn);
             }
         }
         for (int i = 0; i < tileset.width(); i++) {
@@ -168,21 +162,17 @@ void ControlMapEditor::addLand(Position& p, MapEditorSubSelectionKind kind,
                     break;
 
                 Position shortPosition(p.x() + i, 0, 0, p.z() + j, p.layer());
-                shortTexture = new QRect(tileset.x() + i, tileset.y() + j,
-                                         1, 1);
-                switch (kind) {
-                case MapEditorSubSelectionKind::Floors:
-                    land = new FloorDatas(shortTexture, up);
-                    break;
-                case MapEditorSubSelectionKind::Autotiles:
-                    land = new AutotileDatas(specialID, shortTexture, up);
-                    break;
-                default:
-                    break;
+                QRect shortTexture(tileset.x() + i, tileset.y() + j, 1, 1);
+                land = getLandAfter(kind, specialID, shortTexture, up);
+                if (land != nullptr) {
+                    transaction.add(shortPosition, MapEditorSelectionKind::Land,
+                                    kind, land);
                 }
-                stockLand(shortPosition, land, kind, layerOn);
             }
         }
+        updateTransactionLayer(transaction, m_distanceLand, layerOn,
+                               MapEditorSelectionKind::Land);
+        applyTransaction(transaction);
         break;
     }
     case DrawKind::Rectangle:
@@ -217,61 +207,111 @@ void ControlMapEditor::paintPinLand(Position& p,
             QRect textureAfterReduced;
             getFloorTextureReduced(textureAfter, textureAfterReduced, 0, 0);
 
-            // If the texture is different, start the algorithm
+            // If the texture is different, fill the region in one edit
             if (!areLandsEquals(landBefore, textureAfterReduced, kindAfter)){
-                QList<Position> tab;
-                tab.push_back(p);
-                if (kindAfter == MapEditorSubSelectionKind::None)
-                    eraseLand(p);
-                else
-                    stockLand(p, getLandAfter(kindAfter, specialIDAfter,
-                                              textureAfterReduced, up),
-                              kindAfter, false);
-
-                while(!tab.isEmpty()){
-                    QList<Position> adjacent;
-                    Position firstPosition = tab.at(0);
-                    int x = firstPosition.x();
-                    int y = firstPosition.y();
-                    int yPlus = firstPosition.yPlus();
-                    int z = firstPosition.z();
-                    int layer = firstPosition.layer();
-
-                    // Getting all the adjacent squares
-                    adjacent << Position(x - 1, y, yPlus, z, layer);
-                    adjacent << Position(x + 1, y, yPlus, z, layer);
-                    adjacent << Position(x, y, yPlus, z + 1, layer);
-                    adjacent << Position(x, y, yPlus, z - 1, layer);
-
-                    tab.removeAt(0);
-                    for (int i = 0; i < adjacent.size(); i++){
-                        Position adjacentPosition = adjacent.at(i);
-                        int localX = adjacentPosition.x() - p.x();
-                        int localZ = adjacentPosition.z() - p.z();
-                        getFloorTextureReduced(textureAfter,
-                                               textureAfterReduced,
-                                               localX, localZ);
-                        if (m_map->isInGrid(adjacentPosition)){
-                            m_map->getLocalPortion(adjacentPosition, portion);
-                            if (m_map->isInPortion(portion)){
-                                LandDatas* landHere = getLand(portion,
-                                                              adjacentPosition);
-                                if (areLandsEquals(landHere, textureBefore,
-                                                   kindBefore))
-                                {
-                                    if (kindAfter ==
-                                            MapEditorSubSelectionKind::None)
-                                        eraseLand(adjacentPosition);
-                                    else
-                                        stockLand(adjacentPosition,
-                                                  getLandAfter(
-                                                      kindAfter, specialIDAfter,
-                                                      textureAfterReduced, up),
-                                                  kindAfter, false);
-                                    tab.push_back(adjacentPosition);
-                                }
-                            }
-                        }
+                QList<Position> positions;
+                getPinLandPositions(p, textureBefore, kindBefore, positions);
+                stockPinLands(p, positions, kindAfter, specialIDAfter,
+                              textureAfter, up);
+            }
+            delete landBefore;
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+void ControlMapEditor::getPinLandPositions(Position& p, QRect& textureBefore,
+                                           MapEditorSubSelectionKind kindBefore,
+                                           QList<Position>& positions)
+{
+    QRect bounds;
+    QBitArray fillable;
+    QStack<Position> seeds;
+
+    // The plane is read once, a filled square is not fillable anymore
+    fillPinGrid(p, textureBefore, kindBefore, bounds, fillable);
+
+    // Scanline: fill a whole span on x, then look for spans on z - 1/z + 1
+    seeds.push(p);
+    while (!seeds.isEmpty()) {
+        Position seed = seeds.pop();
+        int y = seed.y(), yPlus = seed.yPlus(), z = seed.z();
+        int layer = seed.layer();
+        int left = seed.x();
+        int right = seed.x();
+
+        if (!isPinFillable(left, z, bounds, fillable))
+            continue;
+        while (isPinFillable(left - 1, z, bounds, fillable))
+            left--;
+        while (isPinFillable(right + 1, z, bounds, fillable))
+            right++;
+
+        for (int x = left; x <= right; x++) {
+            fillable.clearBit((z - bounds.y()) * bounds.width() +
+                              (x - bounds.x()));
+            positions.append(Position(x, y, yPlus, z, layer));
+        }
+        for (int k = z - 1; k <= z + 1; k += 2) {
+            bool inSpan = false;
+            for (int x = left; x <= right; x++) {
+                bool isFillable = isPinFillable(x, k, bounds, fillable);
+                if (isFillable && !inSpan)
+                    seeds.push(Position(x, y, yPlus, k, layer));
+                inSpan = isFillable;
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+void ControlMapEditor::fillPinGrid(Position& p, QRect& textureBefore,
+                                   MapEditorSubSelectionKind kindBefore,
+                                   QRect& bounds, QBitArray& fillable)
+{
+    int size = Wanok::portionSize;
+    int ray = m_map->portionsRay() - 1;
+    Portion portion;
+
+    // Squares of the loaded portions of the plane, in the map
+    m_map->getLocalPortion(p, portion);
+    portion.setX(-ray);
+    portion.setZ(-ray);
+    Portion first = m_map->getGlobalFromLocalPortion(portion);
+    bounds = QRect(first.x() * size, first.z() * size, (2 * ray + 1) * size,
+                   (2 * ray + 1) * size) &
+            QRect(0, 0, m_map->mapProperties()->length(),
+                  m_map->mapProperties()->width());
+    fillable = QBitArray(bounds.width() * bounds.height());
+
+    // Each square is compared once, portion by portion
+    Position position(0, p.y(), p.yPlus(), 0, p.layer());
+    QRect texture;
+    for (int i = -ray; i <= ray; i++) {
+        for (int k = -ray; k <= ray; k++) {
+            portion.setX(i);
+            portion.setZ(k);
+            MapPortion* mapPortion = m_map->mapPortion(portion);
+            if (mapPortion == nullptr)
+                continue;
+
+            Portion global = m_map->getGlobalFromLocalPortion(portion);
+            QRect squares = QRect(global.x() * size, global.z() * size, size,
+                                  size) & bounds;
+            for (int z = squares.top(); z <= squares.bottom(); z++) {
+                for (int x = squares.left(); x <= squares.right(); x++) {
+                    position.setX(x);
+                    position.setZ(z);
+                    MapEditorSubSelectionKind kind = mapPortion->getLandKind(
+                                position, texture);
+                    if (kind == kindBefore &&
+                        (kind == MapEditorSubSelectionKind::None ||
+                         texture == textureBefore))
+                    {
+                        fillable.setBit((z - bounds.y()) * bounds.width() +
+                                        (x - bounds.x()));
                     }
                 }
             }
@@ -281,6 +321,50 @@ void ControlMapEditor::paintPinLand(Position& p,
 
 // -------------------------------------------------------
 
+bool ControlMapEditor::isPinFillable(int x, int z, const QRect& bounds,
+                                     const QBitArray& fillable)
+{
+    return bounds.contains(x, z) &&
+           fillable.testBit((z - bounds.y()) * bounds.width() +
+                            (x - bounds.x()));
+}
+
+// -------------------------------------------------------
+
+void ControlMapEditor::stockPinLands(Position& p, QList<Position>& positions,
+                                     MapEditorSubSelectionKind kindAfter,
+                                     int specialIDAfter, QRect& textureAfter,
+                                     bool up)
+{
+    MapEditTransaction transaction;
+    QRect textureAfterReduced;
+
+    for (int i = 0; i < positions.size(); i++) {
+        Position& position = positions[i];
+        if (kindAfter == MapEditorSubSelectionKind::None) {
+            transaction.add(position, MapEditorSelectionKind::Land, kindAfter,
+                            nullptr);
+        }
+        else {
+            getFloorTextureReduced(textureAfter, textureAfterReduced,
+                                   position.x() - p.x(), position.z() - p.z());
+            LandDatas* land = getLandAfter(kindAfter, specialIDAfter,
+                                           textureAfterReduced, up);
+            if (land != nullptr) {
+                transaction.add(position, MapEditorSelectionKind::Land,
+                                kindAfter, land);
+            }
+        }
+    }
+
+    // The whole region is on the layer of the first square
+    updateTransactionLayer(transaction, m_distanceLand, false,
+                           MapEditorSelectionKind::Land);
+    applyTransaction(transaction);
+}
+
+// -------------------------------------------------------
+
 void ControlMapEditor::stockLand(Position& p, LandDatas *landDatas,
                                  MapEditorSubSelectionKind kind, bool layerOn,
                                  bool undoRedo)
@@ -318,11 +402,10 @@ void ControlMapEditor::stockLand(Position& p, LandDatas *landDatas,
                     m_portionsToSave += mapPortion;
                 }
             }
-
-            return;
         }
     }
 
+    // The land is copied by the portion
     delete landDatas;
 }
 
@@ -339,10 +422,17 @@ void ControlMapEditor::removeLand(Position& p, DrawKind drawKind) {
         // Pencil
         switch (drawKind) {
         case DrawKind::Pencil:
+        {
+            MapEditTransaction transaction;
             traceLine(m_previousMouseCoords, p, positions);
-            for (int i = 0; i < positions.size(); i++)
-                eraseLand(positions[i]);
-            eraseLand(p);
+            positions.append(p);
+            for (int i = 0; i < positions.size(); i++) {
+                transaction.add(positions[i], MapEditorSelectionKind::Land,
+                                MapEditorSubSelectionKind::None, nullptr);
+            }
+            applyTransaction(transaction);
+            break;
+        }
         case DrawKind::Rectangle:
             break;
         case DrawKind::Pin:
@@ -409,16 +499,23 @@ void ControlMapEditor::addSprite(Position& p, MapEditorSubSelectionKind kind,
     // Pencil
     switch (drawKind) {
     case DrawKind::Pencil:
+    {
+        MapEditTransaction transaction;
         sprite = getCompleteSprite(kind, xOffset, yOffset, zOffset, tileset,
                                    front, layerOn);
-        stockSprite(p, sprite, kind, layerOn);
+        transaction.add(p, MapEditorSelectionKind::Sprites, kind, sprite);
         traceLine(m_previousMouseCoords, p, positions);
         for (int i = 0; i < positions.size(); i++) {
             sprite = getCompleteSprite(kind, xOffset, yOffset, zOffset, tileset,
                                        front, layerOn);
-            stockSprite(positions[i], sprite, kind, layerOn);
+            transaction.add(positions[i], MapEditorSelectionKind::Sprites, kind,
+                            sprite);
         }
+        updateTransactionLayer(transaction, m_distanceSprite, layerOn,
+                               MapEditorSelectionKind::Sprites);
+        applyTransaction(transaction);
         break;
+    }
     case DrawKind::Pin:
         break;
     case DrawKind::Rectangle:
@@ -440,11 +537,18 @@ void ControlMapEditor::addSpriteWall(DrawKind drawKind, int specialID)
     // Pencil
     switch (drawKind) {
     case DrawKind::Pencil:
+    {
+        MapEditTransaction transaction;
         getWallSpritesPositions(positions);
-        for (int i = 0; i < positions.size(); i++)
-            stockSpriteWall(positions[i], new SpriteWallDatas(specialID));
+        for (int i = 0; i < positions.size(); i++) {
+            transaction.add(positions[i], MapEditorSelectionKind::Sprites,
+                            MapEditorSubSelectionKind::SpritesWall,
+                            new SpriteWallDatas(specialID));
+        }
+        applyTransaction(transaction);
         removePreviewElements();
         break;
+    }
     case DrawKind::Pin:
         break;
     case DrawKind::Rectangle:
@@ -554,11 +658,17 @@ void ControlMapEditor::removeSprite(Position& p, DrawKind drawKind) {
         switch (drawKind) {
         case DrawKind::Pencil:
         case DrawKind::Pin:
+        {
+            MapEditTransaction transaction;
             traceLine(m_previousMouseCoords, p, positions);
-            for (int i = 0; i < positions.size(); i++)
-                eraseSprite(positions[i]);
-            eraseSprite(p);
+            positions.append(p);
+            for (int i = 0; i < positions.size(); i++) {
+                transaction.add(positions[i], MapEditorSelectionKind::Sprites,
+                                MapEditorSubSelectionKind::None, nullptr);
+            }
+            applyTransaction(transaction);
             break;
+        }
         case DrawKind::Rectangle:
             break;
         }
@@ -575,10 +685,16 @@ void ControlMapEditor::removeSpriteWall(DrawKind drawKind) {
     // Pencil
     switch (drawKind) {
     case DrawKind::Pencil:
+    {
+        MapEditTransaction transaction;
         getWallSpritesPositions(positions);
-        for (int i = 0; i < positions.size(); i++)
-            eraseSpriteWall(positions[i]);
+        for (int i = 0; i < positions.size(); i++) {
+            transaction.add(positions[i], MapEditorSelectionKind::Sprites,
+                            MapEditorSubSelectionKind::SpritesWall, nullptr);
+        }
+        applyTransaction(transaction);
         break;
+    }
     case DrawKind::Pin:
         break;
     case DrawKind::Rectangle:
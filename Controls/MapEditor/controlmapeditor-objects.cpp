@@ -218,6 +218,7 @@ bool ControlMapEditor::isObjectInCursor(Position3D& p) {
 
 void ControlMapEditor::updateObjectEdition(MapPortion* mapPortion) {
     m_map->writeObjects(true);
-    m_map->savePortionMap(mapPortion);
+    if (!m_map->savePortionMap(mapPortion))
+        warnPortionsNotSaved();
     m_needMapObjectsUpdate = true;
 }
@@ -54,6 +54,10 @@ void ControlMapEditor::updatePreviewElements(
     else
         updatePreviewOthers(kind, subKind, front, layerOn, tileset,
                             xOffset, yOffset, zOffset);
+
+    // Lands and sprites previews only go to the overlay of the map
+    m_map->updatePreview(m_portionsPreviousPreview);
+    m_needPreviewUpdate = false;
 }
 
 // -------------------------------------------------------
@@ -64,11 +68,13 @@ void ControlMapEditor::removePreviewElements() {
          i != m_portionsPreviousPreview.end(); i++)
     {
         MapPortion* mapPortion = *i;
-        m_portionsToUpdate += mapPortion;
         mapPortion->clearPreview();
+        if (mapPortion->layersToUpdate() != 0)
+            m_portionsToUpdate += mapPortion;
     }
 
     m_portionsPreviousPreview.clear();
+    m_needPreviewUpdate = true;
 }
 
 // -------------------------------------------------------
@@ -195,7 +201,8 @@ void ControlMapEditor::updatePreviewElement(Position &p, Portion& portion,
 
     if (mapPortion != nullptr) {
         mapPortion->addPreview(p, element);
-        m_portionsToUpdate += mapPortion;
+        if (mapPortion->layersToUpdate() != 0)
+            m_portionsToUpdate += mapPortion;
         m_portionsPreviousPreview += mapPortion;
     }
     else
@@ -25,9 +25,26 @@
 
 // -------------------------------------------------------
 
+bool ControlMapEditor::isRaycastingOutdated(bool layerOn) const {
+    return m_needRaycasting || m_raycastingMouse != m_mouse ||
+           m_raycastingLayerOn != layerOn ||
+           m_raycastingGeneration != m_map->generation() ||
+           m_raycastingCamera != m_camera->projection() * m_camera->view();
+}
+
+// -------------------------------------------------------
+
 void ControlMapEditor::updateRaycasting(bool layerOn){
     QList<Portion> portions;
 
+    // Keep the inputs to know when the result is outdated
+    m_raycastingCount++;
+    m_raycastingCamera = m_camera->projection() * m_camera->view();
+    m_raycastingMouse = m_mouse;
+    m_raycastingGeneration = m_map->generation();
+    m_raycastingLayerOn = layerOn;
+    m_needRaycasting = false;
+
     // Raycasting plane
     QMatrix4x4 projection = m_camera->projection();
     QMatrix4x4 view = m_camera->view();
@@ -46,6 +63,7 @@ void ControlMapEditor::updateRaycasting(bool layerOn){
     // Others
     m_distanceLand = 0;
     m_distanceSprite = 0;
+    delete m_elementOnLand;
     m_elementOnLand = nullptr;
     m_elementOnSprite = nullptr;
     for (int i = portions.size() - 1; i >= 0; i--) {
@@ -0,0 +1,206 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "controlmapeditor.h"
+#include "autotilesregion.h"
+
+// -------------------------------------------------------
+
+void ControlMapEditor::updateTransactionLayer(MapEditTransaction& transaction,
+                                              float d, bool layerOn,
+                                              MapEditorSelectionKind kind)
+{
+    // Same layer as the first square drawn, like for one square
+    for (int i = 0; i < transaction.count(); i++) {
+        Position& position = transaction.position(i);
+        Portion portion;
+        if (!m_map->isInGrid(position))
+            continue;
+
+        MapPortion* mapPortion = getMapPortion(position, portion, false);
+        if (mapPortion != nullptr) {
+            m_currentLayer = getLayer(mapPortion, d, position, layerOn, kind);
+            for (int j = 0; j < transaction.count(); j++)
+                transaction.position(j).setLayer(m_currentLayer);
+            return;
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+void ControlMapEditor::applyTransaction(MapEditTransaction& transaction,
+                                        bool undoRedo)
+{
+    QHash<Portion, QList<int>> changesByPortion;
+    QHash<Portion, MapPortion*> portionsChanged;
+    QSet<Position> autotiles;
+    QSet<Portion> portionsOverflow;
+    Portion portion;
+
+    // Group the changes by portion, keeping their order
+    for (int i = 0; i < transaction.count(); i++) {
+        Position& position = transaction.position(i);
+        if (m_map->isInGrid(position)) {
+            m_map->getLocalPortion(position, portion);
+            changesByPortion[portion].append(i);
+        }
+    }
+
+    // Apply all the changes of a portion in one pass
+    QHash<Portion, QList<int>>::iterator i;
+    for (i = changesByPortion.begin(); i != changesByPortion.end(); i++) {
+        QList<int>& indexes = i.value();
+        MapPortion* mapPortion = getMapPortion(
+                    transaction.position(indexes.first()), portion, undoRedo);
+        if (mapPortion == nullptr)
+            continue;
+
+        bool changed = false;
+        for (int j = 0; j < indexes.size(); j++) {
+            changed |= applyTransactionChange(transaction, indexes.at(j),
+                                              mapPortion, autotiles,
+                                              portionsOverflow, undoRedo);
+        }
+        if (changed)
+            portionsChanged.insert(portion, mapPortion);
+    }
+
+    // Autotiles around the changes are updated once for the whole region
+    updateTransactionAutotiles(autotiles, portionsChanged);
+
+    // Update and save each portion touched once
+    QHash<Portion, MapPortion*>::iterator j;
+    for (j = portionsChanged.begin(); j != portionsChanged.end(); j++) {
+        portion = j.key();
+        if (m_map->isInPortion(portion, 0)) {
+            m_portionsToUpdate += j.value();
+            m_portionsToSave += j.value();
+        }
+    }
+    if (!portionsChanged.isEmpty() && m_map->saved())
+        setToNotSaved();
+    updatePortionsToSaveOverflow(portionsOverflow);
+
+    // One undo entry for the whole transaction
+    if (!undoRedo && !transaction.isUndoEmpty()) {
+        QJsonObject obj;
+        transaction.writeUndo(obj);
+        m_changes.append(obj);
+    }
+}
+
+// -------------------------------------------------------
+
+bool ControlMapEditor::applyTransactionChange(
+        MapEditTransaction& transaction, int i, MapPortion* mapPortion,
+        QSet<Position>& autotiles, QSet<Portion>& portionsOverflow,
+        bool undoRedo)
+{
+    Position& position = transaction.position(i);
+    MapEditorSubSelectionKind kind = transaction.kind(i);
+    MapElement* element = transaction.element(i);
+    QList<QJsonObject> previousList;
+    QList<MapEditorSubSelectionKind> previousTypeList;
+    QList<Position> positions;
+    QJsonObject previous;
+    MapEditorSubSelectionKind previousType = MapEditorSubSelectionKind::None;
+    bool changed = false;
+
+    switch (transaction.selection(i)) {
+    case MapEditorSelectionKind::Land:
+        if (element == nullptr) {
+            changed = mapPortion->deleteLand(
+                        position, previousList, previousTypeList, positions,
+                        m_portionsToUpdate, m_portionsToSave, false);
+        }
+        else {
+            changed = mapPortion->addLand(
+                        position, (LandDatas*) element, previous,
+                        previousType, m_portionsToUpdate, m_portionsToSave,
+                        false);
+        }
+        autotiles += position;
+        for (int j = 0; j < positions.size(); j++)
+            autotiles += positions.at(j);
+        break;
+    case MapEditorSelectionKind::Sprites:
+        if (kind == MapEditorSubSelectionKind::SpritesWall) {
+            if (element == nullptr) {
+                changed = mapPortion->deleteSpriteWall(position, previous,
+                                                       previousType);
+            }
+            else {
+                changed = mapPortion->addSpriteWall(
+                            position, (SpriteWallDatas*) element, previous,
+                            previousType);
+            }
+        }
+        else {
+            if (element == nullptr) {
+                changed = mapPortion->deleteSprite(
+                            portionsOverflow, position, previousList,
+                            previousTypeList, positions);
+            }
+            else {
+                changed = mapPortion->addSprite(
+                            portionsOverflow, position, (SpriteDatas*) element,
+                            previous, previousType);
+            }
+            if (changed)
+                m_needMapInfosToSave = true;
+        }
+        break;
+    default:
+        return false;
+    }
+    transaction.releaseElement(i);
+
+    // Keep the previous squares for undo / redo
+    if (changed && !undoRedo) {
+        if (element == nullptr) {
+            for (int j = 0; j < previousList.size(); j++) {
+                transaction.addUndo(previousList.at(j), previousTypeList.at(j),
+                                    nullptr, MapEditorSubSelectionKind::None,
+                                    positions.at(j));
+            }
+            if (previousList.isEmpty()) {
+                transaction.addUndo(previous, previousType, nullptr,
+                                    MapEditorSubSelectionKind::None, position);
+            }
+        }
+        else
+            transaction.addUndo(previous, previousType, element, kind, position);
+    }
+
+    // A land is copied by the portion
+    if (transaction.selection(i) == MapEditorSelectionKind::Land)
+        delete element;
+
+    return changed;
+}
+
+// -------------------------------------------------------
+
+void ControlMapEditor::updateTransactionAutotiles(
+        QSet<Position>& autotiles, QHash<Portion, MapPortion*>& portionsChanged)
+{
+    AutotilesRegion region(m_map);
+    region.update(autotiles, portionsChanged);
+}
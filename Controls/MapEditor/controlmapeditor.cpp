@@ -22,6 +22,8 @@
 #include "wanok.h"
 #include <QTime>
 #include <QApplication>
+#include <QMessageBox>
+#include <cmath>
 
 // -------------------------------------------------------
 
@@ -30,6 +32,9 @@
 #include "controlmapeditor-add-remove.cpp"
 #include "controlmapeditor-objects.cpp"
 
+const int ControlMapEditor::PREFETCH_TIME = 1000;
+const int ControlMapEditor::PREFETCH_MAX_PORTIONS = 3;
+
 // -------------------------------------------------------
 //
 //  CONSTRUCTOR / DESTRUCTOR / GET / SET
@@ -48,7 +53,9 @@ ControlMapEditor::ControlMapEditor() :
     m_positionPreviousPreview(-1, 0, 0, -1, 0),
     m_previousMouseCoords(-500, 0, 0, -500),
     m_needMapInfosToSave(false),
+    m_isPortionsNotSavedWarned(false),
     m_needMapObjectsUpdate(false),
+    m_needPreviewUpdate(false),
     m_displayGrid(true),
     m_displaySquareInformations(true),
     m_treeMapNode(nullptr),
@@ -56,7 +63,17 @@ ControlMapEditor::ControlMapEditor() :
     m_isDeletingWall(false),
     m_isDeleting(false),
     m_isCtrlPressed(false),
-    m_isMovingObject(false)
+    m_isMovingObject(false),
+    m_raycastingCount(0),
+    m_raycastingGeneration(0),
+    m_raycastingLayerOn(false),
+    m_needRaycasting(true),
+    m_isRaycastingUpdated(false),
+    m_wallIndicatorRaycasting(0),
+    m_squareInfosRaycasting(0),
+    m_squareInfosKind(MapEditorSelectionKind::Land),
+    m_squareInfosSubKind(MapEditorSubSelectionKind::None),
+    m_squareInfosLayerOn(false)
 {
 
 }
@@ -120,6 +137,11 @@ Map* ControlMapEditor::loadMap(int idMap, QVector3D* position,
                                double cameraVerticalAngle)
 {
     clearPortionsToUpdate();
+    m_needRaycasting = true;
+
+    // The history of a map is forgotten with its temp files
+    if (!Wanok::mapsUndoRedo.contains(idMap))
+        m_controlUndoRedo.clearHistory(idMap);
 
     // Map & cursor
     m_map = new Map(idMap);
@@ -129,6 +151,10 @@ Map* ControlMapEditor::loadMap(int idMap, QVector3D* position,
     // Update current portion and load all the local portions
     m_currentPortion = cursor()->getPortion();
     m_map->loadPortions(m_currentPortion);
+    m_previousCursorPosition = QVector3D(cursor()->getX(), cursor()->getY(),
+                                         cursor()->getZ());
+    m_cursorVelocity = QVector3D();
+    m_timerPrefetch.start();
 
     // Grid
     m_grid = new Grid;
@@ -175,8 +201,14 @@ Map* ControlMapEditor::loadMap(int idMap, QVector3D* position,
 
 void ControlMapEditor::deleteMap(bool updateCamera){
     clearPortionsToUpdate();
+    m_isPortionsNotSavedWarned = false;
     removePreviewElements();
 
+    // Land under the mouse
+    delete m_elementOnLand;
+    m_elementOnLand = nullptr;
+    m_elementOnSprite = nullptr;
+
     // Cursors
     if (m_cursorObject != nullptr){
         delete m_cursorObject;
@@ -240,12 +272,17 @@ void ControlMapEditor::update(bool layerOn)
     saveTempPortions();
     clearPortionsToUpdate();
     updateMovingPortions();
+    updatePrefetchPortions();
+    m_map->updatePortionsLoaded();
+    m_map->updateTexturesLoaded();
 
     // Camera
     m_camera->update(cursor(), m_map->squareSize());
 
-    // Raycasting
-    updateRaycasting(layerOn);
+    // Raycasting, only if the mouse, the camera or the map changed
+    m_isRaycastingUpdated = isRaycastingOutdated(layerOn);
+    if (m_isRaycastingUpdated)
+        updateRaycasting(layerOn);
 
     // Mouse update
     m_mouseBeforeUpdate = m_mouseMove;
@@ -253,6 +290,14 @@ void ControlMapEditor::update(bool layerOn)
 
 // -------------------------------------------------------
 
+bool ControlMapEditor::isIdle() {
+    return !m_isRaycastingUpdated && m_portionsToUpdate.isEmpty() &&
+           !m_needPreviewUpdate && !m_map->isLoadingPortions() &&
+           !m_map->isLoadingTextures();
+}
+
+// -------------------------------------------------------
+
 void ControlMapEditor::updateMouse(QPoint point, bool layerOn) {
     updateMousePosition(point);
     m_mouseMove = point;
@@ -282,6 +327,10 @@ bool ControlMapEditor::mousePositionChanged(QPoint point) {
 // -------------------------------------------------------
 
 void ControlMapEditor::updateWallIndicator() {
+    if (m_wallIndicatorRaycasting == m_raycastingCount)
+        return;
+    m_wallIndicatorRaycasting = m_raycastingCount;
+
     if (!m_isDrawingWall && !m_isDeletingWall) {
         m_beginWallIndicator->setPosition(m_positionOnPlaneWallIndicator,
                                           m_map->mapProperties()->length(),
@@ -299,6 +348,10 @@ void ControlMapEditor::updatePortions() {
         m_needMapObjectsUpdate = false;
         m_map->updateMapObjects();
     }
+    if (m_needPreviewUpdate) {
+        m_needPreviewUpdate = false;
+        m_map->updatePreview(m_portionsPreviousPreview);
+    }
 
     QSet<MapPortion*>::iterator i;
     for (i = m_portionsToUpdate.begin(); i != m_portionsToUpdate.end(); i++) {
@@ -433,10 +486,68 @@ void ControlMapEditor::updateMovingPortionsUpDown(Portion&){
 
 // -------------------------------------------------------
 
+void ControlMapEditor::updatePrefetchPortions() {
+    QVector3D position(cursor()->getX(), cursor()->getY(), cursor()->getZ());
+    qint64 elapsed = m_timerPrefetch.restart();
+
+    // Smoothed cursor velocity, in pixels per millisecond
+    if (elapsed > 0) {
+        QVector3D velocity = (position - m_previousCursorPosition) / elapsed;
+        m_cursorVelocity = m_cursorVelocity * 0.8f + velocity * 0.2f;
+    }
+    m_previousCursorPosition = position;
+
+    // Number of portions crossed during the prefetch time
+    float coef = PREFETCH_TIME / (float) (Wanok::portionSize *
+                                          m_map->squareSize());
+    prefetchPortions(m_cursorVelocity.x() * coef, true);
+    prefetchPortions(m_cursorVelocity.z() * coef, false);
+}
+
+// -------------------------------------------------------
+
+void ControlMapEditor::prefetchPortions(float portions, bool isX) {
+    if (qFuzzyIsNull(portions))
+        return;
+
+    int r = m_map->portionsRay();
+    int direction = portions > 0 ? 1 : -1;
+    int count = qMin(PREFETCH_MAX_PORTIONS, (int) std::ceil(qAbs(portions)));
+
+    // The next columns / rows that updateMovingPortions will load
+    for (int n = 1; n <= count; n++) {
+        int offset = direction * (r + n);
+        for (int l = -r; l <= r; l++) {
+            if (isX) {
+                m_map->prefetchPortion(m_currentPortion.x() + offset,
+                                       m_currentPortion.y(),
+                                       m_currentPortion.z() + l);
+            }
+            else {
+                m_map->prefetchPortion(m_currentPortion.x() + l,
+                                       m_currentPortion.y(),
+                                       m_currentPortion.z() + offset);
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------
+
 void ControlMapEditor::removePortion(int i, int j, int k){
-    MapPortion* mapPortion = m_map->mapPortion(i, j, k);
-    if (mapPortion != nullptr)
-        delete mapPortion;
+    int index = m_map->portionIndex(i, j, k);
+    MapPortion* mapPortion = m_map->mapPortionBrut(index);
+    if (mapPortion != nullptr) {
+
+        // A portion displaying a preview is not worth keeping
+        if (m_portionsPreviousPreview.remove(mapPortion)) {
+            m_needPreviewUpdate = true;
+            m_map->cancelPortionLoading(mapPortion);
+            delete mapPortion;
+        }
+        else
+            m_map->cachePortion(mapPortion);
+    }
 }
 
 // -------------------------------------------------------
@@ -460,13 +571,16 @@ void ControlMapEditor::loadPortion(int a, int b, int c, int i, int j, int k)
 // -------------------------------------------------------
 
 void ControlMapEditor::saveTempPortions(){
+    bool saved = true;
     QSet<MapPortion*>::iterator i;
     for (i = m_portionsToSave.begin(); i != m_portionsToSave.end(); i++)
-        m_map->savePortionMap(*i);
+        saved = m_map->savePortionMap(*i) && saved;
 
     QHash<Portion, MapPortion*>::iterator j;
     for (j = m_portionsGlobalSave.begin(); j != m_portionsGlobalSave.end(); j++)
-        m_map->savePortionMap(*j);
+        saved = m_map->savePortionMap(*j) && saved;
+    if (!saved)
+        warnPortionsNotSaved();
 
     // Save file infos
     if (m_needMapInfosToSave) {
@@ -477,6 +591,22 @@ void ControlMapEditor::saveTempPortions(){
 
 // -------------------------------------------------------
 
+void ControlMapEditor::warnPortionsNotSaved() {
+
+    // Only once per map, the next edits would fail the same way
+    if (m_isPortionsNotSavedWarned)
+        return;
+    m_isPortionsNotSavedWarned = true;
+
+    QMessageBox::information(nullptr, "Warning",
+                             "Some edits couldn't be written in the "
+                             "temporary files of the map (the disk may be "
+                             "full). They will be lost when the map is "
+                             "closed.");
+}
+
+// -------------------------------------------------------
+
 void ControlMapEditor::clearPortionsToUpdate(){
     m_portionsToUpdate.clear();
     m_portionsToSave.clear();
@@ -686,6 +816,10 @@ MapPortion* ControlMapEditor::getMapPortion(Position& p, Portion& portion,
         }
     }
 
+    // A portion that couldn't be read is never edited
+    if (mapPortion != nullptr && mapPortion->isReadOnly())
+        return nullptr;
+
     return mapPortion;
 }
 
@@ -923,9 +1057,19 @@ void ControlMapEditor::redo() {
 
 void ControlMapEditor::undoRedo(QJsonArray& states, bool reverseAction) {
     for (int i = 0; i < states.size(); i++) {
-        QJsonObject objState = states.at(i).toObject(), objBefore, objAfter;
+        QJsonObject objState = states.at(reverseAction ? states.size() - 1 - i
+                                                       : i).toObject();
+        QJsonObject objBefore, objAfter;
         MapEditorSubSelectionKind kindBefore, kindAfter;
         Position position;
+
+        // Transaction: all its squares in one pass
+        if (MapEditTransaction::isTransaction(objState)) {
+            MapEditTransaction transaction;
+            transaction.readUndo(objState, reverseAction);
+            applyTransaction(transaction, true);
+            continue;
+        }
         m_controlUndoRedo.getStateInfos(objState, kindBefore, kindAfter,
                                         objBefore, objAfter, position);
         if (reverseAction) {
@@ -1073,7 +1217,14 @@ QString ControlMapEditor::getSquareInfos(MapEditorSelectionKind kind,
                                          MapEditorSubSelectionKind subKind,
                                          bool layerOn, bool focus)
 {
-    if (focus) {
+    if (focus && (m_squareInfosRaycasting != m_raycastingCount ||
+                  m_squareInfosKind != kind || m_squareInfosSubKind != subKind
+                  || m_squareInfosLayerOn != layerOn))
+    {
+        m_squareInfosRaycasting = m_raycastingCount;
+        m_squareInfosKind = kind;
+        m_squareInfosSubKind = subKind;
+        m_squareInfosLayerOn = layerOn;
         Position position;
         MapElement* element = getPositionSelected(position, kind, subKind,
                                                   layerOn, true);
@@ -1091,6 +1242,27 @@ QString ControlMapEditor::getSquareInfos(MapEditorSelectionKind kind,
 
 // -------------------------------------------------------
 
+QString ControlMapEditor::getDebugInfos() const {
+    MapPortionsCache& cache = m_map->portionsCache();
+
+    return "Portions cache: " + QString::number(cache.count()) + " (" +
+            QString::number(cache.memorySize() / 1024) + " / " +
+            QString::number(cache.memoryBudget() / 1024) + " KB), hits: " +
+            QString::number(cache.hits()) + ", misses: " +
+            QString::number(cache.misses()) + ", evictions: " +
+            QString::number(cache.evictions()) + "\nGPU buffers: " +
+            QString::number((Map::arenaStatic.used() + Map::arenaFace.used() +
+                             Map::arenaIndexes.used()) / 1024) + " / " +
+            QString::number((Map::arenaStatic.capacity() +
+                             Map::arenaFace.capacity() +
+                             Map::arenaIndexes.capacity()) / 1024) + " KB" +
+            "\nDraw calls: " + QString::number(m_map->drawCalls()) +
+            " (render list: " + QString::number(m_map->renderList().count()) +
+            ")";
+}
+
+// -------------------------------------------------------
+
 bool ControlMapEditor::isVisible(Position3D& position) {
     Portion portion;
     m_map->getLocalPortion(position, portion);
@@ -1203,6 +1375,9 @@ void ControlMapEditor::onMouseReleased(MapEditorSelectionKind,
     m_isDeleting = false;
     m_isMovingObject = false;
 
+    // Wall indicator and square informations depend on the states above
+    m_needRaycasting = true;
+
     // Update the undo redo
     m_controlUndoRedo.addState(m_map->mapProperties()->id(), m_changes);
 }
@@ -21,6 +21,8 @@
 #define CONTROLMAPEDITOR_H
 
 #include <QMouseEvent>
+#include <QElapsedTimer>
+#include <QBitArray>
 #include "map.h"
 #include "grid.h"
 #include "camera.h"
@@ -30,6 +32,7 @@
 #include "contextmenulist.h"
 #include "wallindicator.h"
 #include "controlundoredo.h"
+#include "mapedittransaction.h"
 
 // -------------------------------------------------------
 //
@@ -46,6 +49,8 @@ class ControlMapEditor
 public:
     ControlMapEditor();
     virtual ~ControlMapEditor();
+    static const int PREFETCH_TIME;
+    static const int PREFETCH_MAX_PORTIONS;
     Map* map() const;
     Grid* grid() const;
     Cursor* cursor() const;
@@ -71,7 +76,9 @@ public:
     void updateMousePosition(QPoint point);
     void updateMouseMove(QPoint point);
     bool mousePositionChanged(QPoint point);
+    bool isRaycastingOutdated(bool layerOn) const;
     void updateRaycasting(bool layerOn);
+    bool isIdle();
     void getPortionsInRay(QList<Portion>& portions);
     void updatePortionsInRay(QList<Portion>& portions,
                              QList<Portion> &adjacents);
@@ -112,11 +119,14 @@ public:
     void updateMovingPortionsEastWest(Portion& newPortion);
     void updateMovingPortionsNorthSouth(Portion& newPortion);
     void updateMovingPortionsUpDown(Portion&);
+    void updatePrefetchPortions();
+    void prefetchPortions(float portions, bool isX);
     void removePortion(int i, int j, int k);
     void setPortion(int i, int j, int k, int m, int n, int o, bool visible);
     void loadPortion(int a, int b, int c, int i, int j, int k);
     void updatePortions();
     void saveTempPortions();
+    void warnPortionsNotSaved();
     void clearPortionsToUpdate();
     void setToNotSaved();
     void save();
@@ -139,6 +149,29 @@ public:
     void paintPinLand(Position& p, MapEditorSubSelectionKind kindAfter,
                       int specialIDAfter, QRect &textureAfter,
                       bool up);
+    void updateTransactionLayer(MapEditTransaction& transaction, float d,
+                                bool layerOn, MapEditorSelectionKind kind);
+    void applyTransaction(MapEditTransaction& transaction,
+                          bool undoRedo = false);
+    bool applyTransactionChange(MapEditTransaction& transaction, int i,
+                                MapPortion* mapPortion,
+                                QSet<Position>& autotiles,
+                                QSet<Portion>& portionsOverflow,
+                                bool undoRedo);
+    void updateTransactionAutotiles(
+            QSet<Position>& autotiles,
+            QHash<Portion, MapPortion*>& portionsChanged);
+    void getPinLandPositions(Position& p, QRect& textureBefore,
+                             MapEditorSubSelectionKind kindBefore,
+                             QList<Position>& positions);
+    void fillPinGrid(Position& p, QRect& textureBefore,
+                     MapEditorSubSelectionKind kindBefore, QRect& bounds,
+                     QBitArray& fillable);
+    static bool isPinFillable(int x, int z, const QRect& bounds,
+                              const QBitArray& fillable);
+    void stockPinLands(Position& p, QList<Position>& positions,
+                       MapEditorSubSelectionKind kindAfter, int specialIDAfter,
+                       QRect& textureAfter, bool up);
     LandDatas* getLand(Portion& portion, Position& p);
     void getFloorTextureReduced(QRect &rect, QRect& rectAfter,
                                 int localX, int localZ);
@@ -200,6 +233,7 @@ public:
     QString getSquareInfos(MapEditorSelectionKind kind,
                            MapEditorSubSelectionKind subKind, bool layerOn,
                            bool focus);
+    QString getDebugInfos() const;
     bool isVisible(Position3D &position);
 
     void paintGL(QMatrix4x4& modelviewProjection,
@@ -246,7 +280,7 @@ private:
     Position m_positionOnLand;
     Position m_positionOnSprite;
     Position m_positionRealOnSprite;
-    MapElement* m_elementOnLand;
+    MapElement* m_elementOnLand; // Copy of the land, owned here
     MapElement* m_elementOnSprite;
     float m_distancePlane;
     float m_distanceLand;
@@ -256,11 +290,16 @@ private:
     bool m_isGridOnTop;
     Position m_previousMouseCoords;
     Portion m_currentPortion;
+    QVector3D m_previousCursorPosition;
+    QVector3D m_cursorVelocity;
+    QElapsedTimer m_timerPrefetch;
     QSet<MapPortion*> m_portionsToUpdate;
     QSet<MapPortion*> m_portionsToSave;
     QHash<Portion, MapPortion*> m_portionsGlobalSave;
     bool m_needMapInfosToSave;
+    bool m_isPortionsNotSavedWarned;
     bool m_needMapObjectsUpdate;
+    bool m_needPreviewUpdate;
     bool m_displayGrid;
     bool m_displaySquareInformations;
     QStandardItem* m_treeMapNode;
@@ -273,6 +312,20 @@ private:
     bool m_isMovingObject;
     int m_currentLayer = -1;
     QString m_lastSquareInfos;
+
+    // Inputs of the last raycasting
+    unsigned int m_raycastingCount;
+    QMatrix4x4 m_raycastingCamera;
+    QPoint m_raycastingMouse;
+    unsigned int m_raycastingGeneration;
+    bool m_raycastingLayerOn;
+    bool m_needRaycasting;
+    bool m_isRaycastingUpdated;
+    unsigned int m_wallIndicatorRaycasting;
+    unsigned int m_squareInfosRaycasting;
+    MapEditorSelectionKind m_squareInfosKind;
+    MapEditorSubSelectionKind m_squareInfosSubKind;
+    bool m_squareInfosLayerOn;
 };
 
 #endif // CONTROLMAPEDITOR_H
@@ -20,7 +20,6 @@
 #include "controlundoredo.h"
 #include "wanok.h"
 #include "common.h"
-#include <QFile>
 
 const QString ControlUndoRedo::jsonBefore = "before";
 const QString ControlUndoRedo::jsonBeforeType = "beforeT";
@@ -29,6 +28,7 @@ const QString ControlUndoRedo::jsonAfterType = "afterT";
 const QString ControlUndoRedo::jsonPos = "pos";
 const QString ControlUndoRedo::jsonStates = "states";
 const int ControlUndoRedo::MAX_SIZE = 50;
+const QString ControlUndoRedo::JOURNAL_FILE_NAME = "history.bin";
 
 // -------------------------------------------------------
 //
@@ -41,6 +41,13 @@ ControlUndoRedo::ControlUndoRedo()
 
 }
 
+ControlUndoRedo::~ControlUndoRedo()
+{
+    QHash<int, UndoRedoHistory*>::iterator i;
+    for (i = m_histories.begin(); i != m_histories.end(); i++)
+        delete i.value();
+}
+
 // -------------------------------------------------------
 //
 //  INTERMEDIARY FUNCTIONS
@@ -78,42 +85,10 @@ void ControlUndoRedo::addState(int idMap, QJsonArray& tab) {
     if (tab.isEmpty())
         return;
 
-    QJsonObject obj;
-    obj[jsonStates] = tab;
-    int currentState = updateMapCurrentState(idMap);
-    int state;
-
     // Add to undeoRedo idMaps in project
     Wanok::mapsUndoRedo += idMap;
 
-    // If max size reached, remove the first state and move the others
-    QString path = getTempFile(idMap, currentState - 1);
-    if (currentState == MAX_SIZE && QFile::exists(path)) {
-        state = 0;
-        QString pathSource = getTempFile(idMap, state + 1);
-        QString pathTarget = getTempFile(idMap, state);
-
-        while (QFile::exists(pathSource)) {
-            QFile::remove(pathTarget);
-            QFile::copy(pathSource, pathTarget);
-            state++;
-            pathSource = getTempFile(idMap, state + 1);
-            pathTarget = getTempFile(idMap, state);
-        }
-
-        QFile::remove(pathTarget);
-    }
-
-    // Save in temp file
-    Common::writeOtherJSON(path, obj);
-
-    // Remove all the state > state
-    state = currentState;
-    path = getTempFile(idMap, state);
-    while (QFile::exists(path)) {
-        QFile(path).remove();
-        path = getTempFile(idMap, ++state);
-    }
+    getHistory(idMap)->add(encodeStates(tab));
 
     // Clear the changes from map editor control
     for (int i = tab.size() - 1; i >= 0; i--)
@@ -122,27 +97,25 @@ void ControlUndoRedo::addState(int idMap, QJsonArray& tab) {
 
 // -------------------------------------------------------
 
-int ControlUndoRedo::getMapCurrentState(int idMap) const {
-    if (m_states.contains(idMap))
-        return m_states.value(idMap);
+UndoRedoHistory* ControlUndoRedo::getHistory(int idMap) {
+    UndoRedoHistory* history = m_histories.value(idMap);
+
+    if (history == nullptr) {
+        history = new UndoRedoHistory(
+                    Common::pathCombine(getTempDir(idMap), JOURNAL_FILE_NAME),
+                    MAX_SIZE);
+        m_histories.insert(idMap, history);
+    }
+    history->setMemoryBudget(Wanok::get()->engineSettings()
+                             ->undoRedoMemory() * 1024);
 
-    return 0;
+    return history;
 }
 
 // -------------------------------------------------------
 
-int ControlUndoRedo::updateMapCurrentState(int idMap) {
-    if (m_states.contains(idMap)) {
-        int currentValue = m_states.value(idMap);
-        if (currentValue < MAX_SIZE)
-            currentValue++;
-        m_states[idMap] = currentValue;
-        return currentValue;
-    }
-    else {
-        m_states[idMap] = 1;
-        return 1;
-    }
+void ControlUndoRedo::clearHistory(int idMap) {
+    delete m_histories.take(idMap);
 }
 
 // -------------------------------------------------------
@@ -157,44 +130,40 @@ QString ControlUndoRedo::getTempDir(int idMap) const {
 
 // -------------------------------------------------------
 
-QString ControlUndoRedo::getTempFile(int idMap, int state) const {
-    return Common::pathCombine(getTempDir(idMap),
-                              QString::number(state) + ".json");
-}
-
-// -------------------------------------------------------
-
 void ControlUndoRedo::undo(int idMap, QJsonArray& states)
 {
-    undoRedo(idMap, -1, states);
+    QByteArray data;
+
+    if (getHistory(idMap)->undo(data))
+        decodeStates(data, states);
 }
 
 // -------------------------------------------------------
 
 void ControlUndoRedo::redo(int idMap, QJsonArray &states)
 {
-    undoRedo(idMap, 0, states);
+    QByteArray data;
+
+    if (getHistory(idMap)->redo(data))
+        decodeStates(data, states);
 }
 
 // -------------------------------------------------------
 
-void ControlUndoRedo::undoRedo(int idMap, int offset, QJsonArray &states)
-{
-    int state = getMapCurrentState(idMap) + offset;
+QByteArray ControlUndoRedo::encodeStates(QJsonArray& states) {
+    QJsonObject obj;
+    obj[jsonStates] = states;
+
+    return qCompress(QJsonDocument(obj).toBinaryData());
+}
 
-    QString path = getTempFile(idMap, state);
-    if (QFile(path).exists()) {
+// -------------------------------------------------------
 
-        // Get the states
-        QJsonDocument doc;
-        QJsonObject obj;
-        Common::readOtherJSON(path, doc);
-        obj = doc.object();
-        states = obj[jsonStates].toArray();
+void ControlUndoRedo::decodeStates(const QByteArray& data, QJsonArray& states)
+{
+    QJsonDocument doc = QJsonDocument::fromBinaryData(qUncompress(data));
 
-        // Update current state
-        m_states[idMap] = state + (offset == 0 ? 1 : 0);
-    }
+    states = doc.object()[jsonStates].toArray();
 }
 
 // -------------------------------------------------------
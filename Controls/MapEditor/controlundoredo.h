@@ -23,13 +23,15 @@
 #include <QHash>
 #include <QJsonDocument>
 #include "mapelement.h"
+#include "undoredohistory.h"
 
 // -------------------------------------------------------
 //
 //  CLASS ControlUndoRedo
 //
 //  The controler of the undo / redo system. This part is handling all the
-//  maps current stats and apply undo / redo stuffs.
+//  maps current stats and apply undo / redo stuffs. The states are kept in
+//  memory as compressed binary JSON in an history for each map.
 //
 // -------------------------------------------------------
 
@@ -37,6 +39,7 @@ class ControlUndoRedo
 {
 public:
     ControlUndoRedo();
+    virtual ~ControlUndoRedo();
     static const QString jsonBefore;
     static const QString jsonBeforeType;
     static const QString jsonAfter;
@@ -44,6 +47,7 @@ public:
     static const QString jsonPos;
     static const QString jsonStates;
     static const int MAX_SIZE;
+    static const QString JOURNAL_FILE_NAME;
 
     void updateJsonList(QJsonArray& list, const QJsonObject& previous,
                         MapEditorSubSelectionKind previousType,
@@ -51,13 +55,13 @@ public:
                         MapEditorSubSelectionKind afterType,
                         const Position &position, bool removeAll = false);
     void addState(int idMap, QJsonArray& tab);
-    int getMapCurrentState(int idMap) const;
-    int updateMapCurrentState(int idMap);
+    UndoRedoHistory* getHistory(int idMap);
+    void clearHistory(int idMap);
     QString getTempDir(int idMap) const;
-    QString getTempFile(int idMap, int state) const;
     void undo(int idMap, QJsonArray &states);
     void redo(int idMap, QJsonArray &states);
-    void undoRedo(int idMap, int offset, QJsonArray &states);
+    static QByteArray encodeStates(QJsonArray& states);
+    static void decodeStates(const QByteArray& data, QJsonArray& states);
     void getStateInfos(QJsonObject &objState,
                        MapEditorSubSelectionKind& beforeT,
                        MapEditorSubSelectionKind& afterT,
@@ -65,7 +69,7 @@ public:
                        Position& position);
 
 protected:
-    QHash<int, int> m_states;
+    QHash<int, UndoRedoHistory*> m_histories;
 };
 
 #endif // CONTROLUNDOREDO_H
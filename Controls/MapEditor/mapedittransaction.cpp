@@ -0,0 +1,238 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mapedittransaction.h"
+#include "floor.h"
+#include "autotile.h"
+#include "sprite.h"
+#include <QJsonDocument>
+
+const QString MapEditTransaction::jsonElements = "elements";
+const QString MapEditTransaction::jsonChanges = "changes";
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapEditTransaction::MapEditTransaction()
+{
+
+}
+
+MapEditTransaction::~MapEditTransaction()
+{
+    clear();
+}
+
+int MapEditTransaction::count() const { return m_positions.size(); }
+
+bool MapEditTransaction::isEmpty() const { return m_positions.isEmpty(); }
+
+Position& MapEditTransaction::position(int i) { return m_positions[i]; }
+
+MapEditorSelectionKind MapEditTransaction::selection(int i) const {
+    return m_selections.at(i);
+}
+
+MapEditorSubSelectionKind MapEditTransaction::kind(int i) const {
+    return m_kinds.at(i);
+}
+
+MapElement* MapEditTransaction::element(int i) const {
+    return m_elements.at(i);
+}
+
+bool MapEditTransaction::isUndoEmpty() const {
+    return m_undoChanges.isEmpty();
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+// The element now belongs to the map portion where it was added
+
+void MapEditTransaction::releaseElement(int i) {
+    m_elements[i] = nullptr;
+}
+
+// -------------------------------------------------------
+
+void MapEditTransaction::add(Position& p, MapEditorSelectionKind selection,
+                             MapEditorSubSelectionKind kind,
+                             MapElement* element)
+{
+    m_positions.append(p);
+    m_selections.append(selection);
+    m_kinds.append(kind);
+    m_elements.append(element);
+}
+
+// -------------------------------------------------------
+
+void MapEditTransaction::clear() {
+    for (int i = 0; i < m_elements.size(); i++)
+        delete m_elements.at(i);
+    m_positions.clear();
+    m_selections.clear();
+    m_kinds.clear();
+    m_elements.clear();
+}
+
+// -------------------------------------------------------
+
+MapEditorSelectionKind MapEditTransaction::getSelectionKind(
+        MapEditorSubSelectionKind kind)
+{
+    switch (kind) {
+    case MapEditorSubSelectionKind::Floors:
+    case MapEditorSubSelectionKind::Autotiles:
+    case MapEditorSubSelectionKind::Water:
+        return MapEditorSelectionKind::Land;
+    case MapEditorSubSelectionKind::SpritesFace:
+    case MapEditorSubSelectionKind::SpritesFix:
+    case MapEditorSubSelectionKind::SpritesDouble:
+    case MapEditorSubSelectionKind::SpritesQuadra:
+    case MapEditorSubSelectionKind::SpritesWall:
+        return MapEditorSelectionKind::Sprites;
+    default:
+        return MapEditorSelectionKind::None;
+    }
+}
+
+// -------------------------------------------------------
+
+MapElement* MapEditTransaction::createElement(MapEditorSubSelectionKind kind,
+                                              const QJsonObject& json)
+{
+    MapElement* element;
+
+    switch (kind) {
+    case MapEditorSubSelectionKind::Floors:
+        element = new FloorDatas;
+        break;
+    case MapEditorSubSelectionKind::Autotiles:
+        element = new AutotileDatas;
+        break;
+    case MapEditorSubSelectionKind::SpritesFace:
+    case MapEditorSubSelectionKind::SpritesFix:
+    case MapEditorSubSelectionKind::SpritesDouble:
+    case MapEditorSubSelectionKind::SpritesQuadra:
+        element = new SpriteDatas;
+        break;
+    case MapEditorSubSelectionKind::SpritesWall:
+        element = new SpriteWallDatas;
+        break;
+    default:
+        return nullptr;
+    }
+    element->read(json);
+
+    return element;
+}
+
+// -------------------------------------------------------
+
+bool MapEditTransaction::isTransaction(const QJsonObject& json) {
+    return json.contains(jsonChanges);
+}
+
+// -------------------------------------------------------
+
+int MapEditTransaction::getUndoElementIndex(const QJsonObject& json) {
+    QByteArray key = QJsonDocument(json).toJson(QJsonDocument::Compact);
+    int index = m_undoElementsIndexes.value(key, -1);
+
+    if (index == -1) {
+        index = m_undoElements.size();
+        m_undoElements.append(json);
+        m_undoElementsIndexes.insert(key, index);
+    }
+
+    return index;
+}
+
+// -------------------------------------------------------
+
+void MapEditTransaction::addUndo(const QJsonObject& previous,
+                                 MapEditorSubSelectionKind previousType,
+                                 MapElement* after,
+                                 MapEditorSubSelectionKind afterType,
+                                 const Position& position)
+{
+    QJsonArray change, positionJson;
+    QJsonObject afterJson;
+
+    if (after != nullptr)
+        after->write(afterJson);
+    position.write(positionJson);
+    change.append(previousType == MapEditorSubSelectionKind::None ?
+                      -1 : getUndoElementIndex(previous));
+    change.append(static_cast<int>(previousType));
+    change.append(after == nullptr ? -1 : getUndoElementIndex(afterJson));
+    change.append(static_cast<int>(afterType));
+    change.append(positionJson);
+    m_undoChanges.append(change);
+}
+
+// -------------------------------------------------------
+//
+//  READ / WRITE
+//
+// -------------------------------------------------------
+
+// Fill the changes putting back the state before (undo) or after (redo)
+
+void MapEditTransaction::readUndo(const QJsonObject& json, bool reverseAction)
+{
+    QJsonArray elements = json[jsonElements].toArray();
+    QJsonArray changes = json[jsonChanges].toArray();
+
+    clear();
+    for (int i = 0; i < changes.size(); i++) {
+        QJsonArray change = changes.at(reverseAction ? changes.size() - 1 - i
+                                                     : i).toArray();
+        int index = change.at(reverseAction ? 0 : 2).toInt();
+        MapEditorSubSelectionKind kind = static_cast<MapEditorSubSelectionKind>(
+                    change.at(reverseAction ? 1 : 3).toInt());
+        MapEditorSubSelectionKind otherKind =
+                static_cast<MapEditorSubSelectionKind>(
+                    change.at(reverseAction ? 3 : 1).toInt());
+        Position position;
+        position.read(change.at(4).toArray());
+
+        if (kind == MapEditorSubSelectionKind::None)
+            add(position, getSelectionKind(otherKind), otherKind, nullptr);
+        else {
+            add(position, getSelectionKind(kind), kind,
+                createElement(kind, elements.at(index).toObject()));
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+void MapEditTransaction::writeUndo(QJsonObject& json) const {
+    json[jsonElements] = m_undoElements;
+    json[jsonChanges] = m_undoChanges;
+}
@@ -0,0 +1,87 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPEDITTRANSACTION_H
+#define MAPEDITTRANSACTION_H
+
+#include <QVector>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "mapelement.h"
+
+// -------------------------------------------------------
+//
+//  CLASS MapEditTransaction
+//
+//  A set of squares changes (lands, sprites, walls) applied in one pass by
+//  the map editor controler. A change without element removes what is on
+//  the square. The transaction also records the applied changes as one
+//  compact undo / redo entry: each element is written once in a table and
+//  the changes only refer to it by index.
+//
+// -------------------------------------------------------
+
+class MapEditTransaction
+{
+public:
+    MapEditTransaction();
+    virtual ~MapEditTransaction();
+    static const QString jsonElements;
+    static const QString jsonChanges;
+
+    int count() const;
+    bool isEmpty() const;
+    Position& position(int i);
+    MapEditorSelectionKind selection(int i) const;
+    MapEditorSubSelectionKind kind(int i) const;
+    MapElement* element(int i) const;
+    void releaseElement(int i);
+    void add(Position& p, MapEditorSelectionKind selection,
+             MapEditorSubSelectionKind kind, MapElement* element);
+    void clear();
+    static MapEditorSelectionKind getSelectionKind(
+            MapEditorSubSelectionKind kind);
+    static MapElement* createElement(MapEditorSubSelectionKind kind,
+                                     const QJsonObject& json);
+    static bool isTransaction(const QJsonObject& json);
+
+    bool isUndoEmpty() const;
+    void addUndo(const QJsonObject& previous,
+                 MapEditorSubSelectionKind previousType, MapElement* after,
+                 MapEditorSubSelectionKind afterType,
+                 const Position& position);
+    void readUndo(const QJsonObject& json, bool reverseAction);
+    void writeUndo(QJsonObject& json) const;
+
+protected:
+    QVector<Position> m_positions;
+    QVector<MapEditorSelectionKind> m_selections;
+    QVector<MapEditorSubSelectionKind> m_kinds;
+    QVector<MapElement*> m_elements;
+
+    // Undo / redo
+    QJsonArray m_undoElements;
+    QHash<QByteArray, int> m_undoElementsIndexes;
+    QJsonArray m_undoChanges;
+
+    int getUndoElementIndex(const QJsonObject& json);
+};
+
+#endif // MAPEDITTRANSACTION_H
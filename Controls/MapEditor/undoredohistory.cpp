@@ -0,0 +1,243 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "undoredohistory.h"
+#include <QFile>
+
+// Memory used by the states of a map before using the journal (bytes)
+const int UndoRedoHistory::DEFAULT_MEMORY_BUDGET = 8 * 1024 * 1024;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+UndoRedoHistory::UndoRedoHistory(QString journalPath, int capacity,
+                                 int memoryBudget) :
+    m_journalPath(journalPath),
+    m_journalSize(0),
+    m_memoryBudget(memoryBudget),
+    m_memorySize(0),
+    m_first(0),
+    m_count(0),
+    m_current(0),
+    m_firstInMemory(0),
+    m_states(capacity),
+    m_offsets(capacity, -1),
+    m_sizes(capacity, 0)
+{
+    QFile::remove(m_journalPath);
+}
+
+UndoRedoHistory::~UndoRedoHistory()
+{
+    clear();
+}
+
+int UndoRedoHistory::count() const { return m_count; }
+
+int UndoRedoHistory::current() const { return m_current; }
+
+int UndoRedoHistory::memoryBudget() const { return m_memoryBudget; }
+
+void UndoRedoHistory::setMemoryBudget(int memoryBudget) {
+    m_memoryBudget = memoryBudget;
+    spill();
+}
+
+int UndoRedoHistory::memorySize() const { return m_memorySize; }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+int UndoRedoHistory::ringIndex(int i) const {
+    return (m_first + i) % m_states.size();
+}
+
+// -------------------------------------------------------
+
+void UndoRedoHistory::add(const QByteArray& state) {
+
+    // Adding a state removes the states that could be redone
+    while (m_count > m_current)
+        removeState(--m_count);
+    if (m_firstInMemory > m_count)
+        m_firstInMemory = m_count;
+
+    // If full, forget the oldest state
+    if (m_count == m_states.size()) {
+        removeState(0);
+        m_first = ringIndex(1);
+        m_count--;
+        m_current--;
+        if (m_firstInMemory > 0)
+            m_firstInMemory--;
+    }
+
+    int index = ringIndex(m_count++);
+    m_states[index] = state;
+    m_offsets[index] = -1;
+    m_sizes[index] = state.size();
+    m_memorySize += state.size();
+    m_current = m_count;
+
+    compactJournal();
+    spill();
+}
+
+// -------------------------------------------------------
+
+bool UndoRedoHistory::undo(QByteArray& state) {
+    QByteArray read;
+
+    // The history only moves if the state could be read
+    if (m_current == 0 || !readState(m_current - 1, read))
+        return false;
+    m_current--;
+    state = read;
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+bool UndoRedoHistory::redo(QByteArray& state) {
+    QByteArray read;
+
+    if (m_current == m_count || !readState(m_current, read))
+        return false;
+    m_current++;
+    state = read;
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+void UndoRedoHistory::clear() {
+    while (m_count > 0)
+        removeState(--m_count);
+    m_first = 0;
+    m_current = 0;
+    m_firstInMemory = 0;
+    m_journalSize = 0;
+    QFile::remove(m_journalPath);
+}
+
+// -------------------------------------------------------
+
+void UndoRedoHistory::removeState(int i) {
+    int index = ringIndex(i);
+
+    if (m_offsets.at(index) == -1)
+        m_memorySize -= m_sizes.at(index);
+    m_states[index] = QByteArray();
+    m_offsets[index] = -1;
+    m_sizes[index] = 0;
+}
+
+// -------------------------------------------------------
+
+bool UndoRedoHistory::readState(int i, QByteArray& state) const {
+    int index = ringIndex(i);
+    qint64 offset = m_offsets.at(index);
+
+    if (offset == -1) {
+        state = m_states.at(index);
+        return true;
+    }
+
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset))
+        return false;
+    state = file.read(m_sizes.at(index));
+
+    return state.size() == m_sizes.at(index);
+}
+
+// -------------------------------------------------------
+
+// Drop the forgotten states from the journal when they are most of it. The
+// states still in the journal are in the order of the file, so each one can
+// be moved down without overwriting the next ones
+
+void UndoRedoHistory::compactJournal() {
+    qint64 used = 0;
+    for (int i = 0; i < m_firstInMemory; i++)
+        used += m_sizes.at(ringIndex(i));
+
+    if (used == m_journalSize || used * 2 > m_journalSize)
+        return;
+    if (used == 0) {
+        m_journalSize = 0;
+        QFile::remove(m_journalPath);
+        return;
+    }
+
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadWrite))
+        return;
+
+    qint64 offset = 0;
+    for (int i = 0; i < m_firstInMemory; i++) {
+        int index = ringIndex(i);
+        if (!file.seek(m_offsets.at(index)))
+            return;
+        QByteArray state = file.read(m_sizes.at(index));
+        if (state.size() != m_sizes.at(index) || !file.seek(offset) ||
+            file.write(state) != state.size())
+        {
+            return;
+        }
+        m_offsets[index] = offset;
+        offset += state.size();
+    }
+    if (file.resize(offset))
+        m_journalSize = offset;
+}
+
+// -------------------------------------------------------
+
+// Move the oldest states to the journal, always keeping the last one
+
+void UndoRedoHistory::spill() {
+    if (m_memorySize <= m_memoryBudget || m_firstInMemory >= m_count - 1)
+        return;
+
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+        return;
+
+    while (m_memorySize > m_memoryBudget && m_firstInMemory < m_count - 1) {
+        int index = ringIndex(m_firstInMemory);
+        if (file.write(m_states.at(index)) != m_sizes.at(index)) {
+            m_journalSize = file.size();
+            break;
+        }
+        m_firstInMemory++;
+        m_offsets[index] = m_journalSize;
+        m_journalSize += m_sizes.at(index);
+        m_memorySize -= m_sizes.at(index);
+        m_states[index] = QByteArray();
+    }
+}
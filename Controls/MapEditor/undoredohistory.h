@@ -0,0 +1,77 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UNDOREDOHISTORY_H
+#define UNDOREDOHISTORY_H
+
+#include <QVector>
+#include <QByteArray>
+#include <QString>
+
+// -------------------------------------------------------
+//
+//  CLASS UndoRedoHistory
+//
+//  The undo / redo states of a map, in a ring buffer of capacity states.
+//  When the states are over the memory budget, the oldest ones are moved
+//  to a journal file (appended) and read back from it when needed. The
+//  journal is rewritten once most of it is forgotten states.
+//
+// -------------------------------------------------------
+
+class UndoRedoHistory
+{
+public:
+    UndoRedoHistory(QString journalPath, int capacity,
+                    int memoryBudget = DEFAULT_MEMORY_BUDGET);
+    virtual ~UndoRedoHistory();
+    static const int DEFAULT_MEMORY_BUDGET;
+    int count() const;
+    int current() const;
+    int memoryBudget() const;
+    void setMemoryBudget(int memoryBudget);
+    int memorySize() const;
+    void add(const QByteArray& state);
+    bool undo(QByteArray& state);
+    bool redo(QByteArray& state);
+    void clear();
+
+protected:
+    QString m_journalPath;
+    qint64 m_journalSize;
+    int m_memoryBudget;
+    int m_memorySize;
+    int m_first;
+    int m_count;
+    int m_current;
+    int m_firstInMemory;
+
+    // Ring buffer, a state in the journal has an empty data and an offset
+    QVector<QByteArray> m_states;
+    QVector<qint64> m_offsets;
+    QVector<int> m_sizes;
+
+    int ringIndex(int i) const;
+    void removeState(int i);
+    bool readState(int i, QByteArray& state) const;
+    void compactJournal();
+    void spill();
+};
+
+#endif // UNDOREDOHISTORY_H
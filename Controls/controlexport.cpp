@@ -20,6 +20,7 @@
 #include "controlexport.h"
 #include "wanok.h"
 #include "common.h"
+#include "projectupdater.h"
 #include <QDirIterator>
 
 // -------------------------------------------------------
@@ -208,6 +209,14 @@ void ControlExport::removeMapsTemp(QString pathDatas){
                                                    directories.fileName()),
                                 "temp")).removeRecursively();
     }
+
+    // The game only reads JSON portions and expects all of them
+    ProjectUpdater::convertMapsPortions(pathMaps, false);
+    QDirIterator maps(pathMaps, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (maps.hasNext()){
+        maps.next();
+        Map::writeEmptyPortions(maps.filePath());
+    }
 }
 
 // -------------------------------------------------------
@@ -26,6 +26,9 @@
 #include "wanok.h"
 #include <QMessageBox>
 
+// Repaint interval when nothing moves, this is the cursor frame duration
+const int WidgetMapEditor::ANIMATION_INTERVAL = 250;
+
 // -------------------------------------------------------
 //
 //  CONSTRUCTOR / DESTRUCTOR / GET / SET
@@ -38,14 +41,22 @@ WidgetMapEditor::WidgetMapEditor(QWidget *parent) :
     m_needUpdateMap(false),
     isGLInitialized(false),
     m_timerFirstPressure(new QTimer),
+    m_timerRender(new QTimer),
     m_firstPressure(false),
     m_spinBoxX(nullptr),
-    m_spinBoxZ(nullptr)
+    m_spinBoxZ(nullptr),
+    m_frameInterval(0),
+    m_frameTime(0)
 {
     // Timers
     m_timerFirstPressure->setSingleShot(true);
     connect(m_timerFirstPressure, SIGNAL(timeout()),
             this, SLOT(onFirstPressure()));
+    m_timerRender->setSingleShot(true);
+    connect(m_timerRender, SIGNAL(timeout()), this, SLOT(update()));
+
+    // Mouse moves wake up the widget when idle
+    this->setMouseTracking(true);
 
     m_contextMenu = ContextMenuList::createContextObject(this);
     m_control.setContextMenu(m_contextMenu);
@@ -57,6 +68,7 @@ WidgetMapEditor::~WidgetMapEditor()
 {
     makeCurrent();
     delete m_timerFirstPressure;
+    delete m_timerRender;
 }
 
 void WidgetMapEditor::setMenuBar(WidgetMenuBarMapEditor* m){ m_menuBar = m; }
@@ -111,7 +123,7 @@ void WidgetMapEditor::initializeGL(){
 
     // Initialize OpenGL Backend
     initializeOpenGLFunctions();
-    connect(this, SIGNAL(frameSwapped()), this, SLOT(update()));
+    connect(this, SIGNAL(frameSwapped()), this, SLOT(onFrameSwapped()));
 
     isGLInitialized = true;
     if (m_needUpdateMap)
@@ -127,6 +139,12 @@ void WidgetMapEditor::resizeGL(int width, int height){
 // -------------------------------------------------------
 
 void WidgetMapEditor::paintGL() {
+    QElapsedTimer timerPaint;
+    timerPaint.start();
+    if (m_timerFrame.isValid())
+        m_frameInterval = m_timerFrame.restart();
+    else
+        m_timerFrame.start();
     QPainter p(this);
 
     // Clear buffer
@@ -224,6 +242,14 @@ void WidgetMapEditor::paintGL() {
                 renderText(p, 20, 20 * (listInfos.size() - i),
                            listInfos.at(i), QFont(), QColor(255, 255, 255));
             }
+
+            // Debug informations on the bottom
+            listInfos = (m_control.getDebugInfos() + "\n" +
+                         getFrameInfos()).split("\n");
+            for (int i = 0; i < listInfos.size(); i++) {
+                renderText(p, 20, this->height() - 20 * (i + 1),
+                           listInfos.at(i), QFont(), QColor(255, 255, 255));
+            }
             p.end();
         }
 
@@ -232,12 +258,40 @@ void WidgetMapEditor::paintGL() {
     }
     else
         p.end();
+
+    m_frameTime = timerPaint.nsecsElapsed() / 1000000.0;
 }
 
 // -------------------------------------------------------
 
 void WidgetMapEditor::update(){
-    QOpenGLWidget::update();
+    int maxFPS = Wanok::get()->engineSettings()->maxFPS();
+    qint64 delay = 0;
+
+    // Frame pacing: never repaint faster than the max FPS
+    if (maxFPS > 0 && m_timerFrame.isValid())
+        delay = 1000 / maxFPS - m_timerFrame.elapsed();
+    if (delay > 0)
+        m_timerRender->start(delay);
+    else {
+        m_timerRender->stop();
+        QOpenGLWidget::update();
+    }
+}
+
+// -------------------------------------------------------
+
+void WidgetMapEditor::onFrameSwapped() {
+
+    // Keep repainting while something moves, else only animate the cursor
+    // if the window is active (not behind a dialog)
+    if (m_control.map() != nullptr && (!m_keysPressed.isEmpty() ||
+                                       !m_control.isIdle()))
+    {
+        update();
+    }
+    else if (m_control.map() != nullptr && this->isActiveWindow())
+        m_timerRender->start(ANIMATION_INTERVAL);
 }
 
 // -------------------------------------------------------
@@ -278,6 +332,7 @@ void WidgetMapEditor::initializeMap(){
     m_needUpdateMap = false;
     this->setFocus();
     updateSpinBoxes();
+    update();
 }
 
 // -------------------------------------------------------
@@ -347,6 +402,16 @@ void WidgetMapEditor::removePreviewElements() {
 
 // -------------------------------------------------------
 
+QString WidgetMapEditor::getFrameInfos() const {
+    int maxFPS = Wanok::get()->engineSettings()->maxFPS();
+
+    return "Frame: " + QString::number(m_frameTime, 'f', 2) + " ms, " +
+            QString::number(m_frameInterval) + " ms since previous (max FPS: "
+            + (maxFPS > 0 ? QString::number(maxFPS) : QString("none")) + ")";
+}
+
+// -------------------------------------------------------
+
 void WidgetMapEditor::renderText(QPainter &p, double x, double y,
                                  const QString &text, const QFont& font,
                                  const QColor& fontColor,
@@ -375,24 +440,28 @@ void WidgetMapEditor::renderText(QPainter &p, double x, double y,
 
 void WidgetMapEditor::showHideGrid() {
     m_control.showHideGrid();
+    update();
 }
 
 // -------------------------------------------------------
 
 void WidgetMapEditor::showHideSquareInformations() {
     m_control.showHideSquareInformations();
+    update();
 }
 
 // -------------------------------------------------------
 
 void WidgetMapEditor::undo() {
     m_control.undo();
+    update();
 }
 
 // -------------------------------------------------------
 
 void WidgetMapEditor::redo() {
     m_control.redo();
+    update();
 }
 
 // -------------------------------------------------------
@@ -408,7 +477,18 @@ void WidgetMapEditor::focusOutEvent(QFocusEvent*){
 
 // -------------------------------------------------------
 
+void WidgetMapEditor::changeEvent(QEvent* event) {
+    QOpenGLWidget::changeEvent(event);
+
+    // Resume the cursor animation when coming back from a dialog
+    if (event->type() == QEvent::ActivationChange)
+        update();
+}
+
+// -------------------------------------------------------
+
 void WidgetMapEditor::wheelEvent(QWheelEvent* event){
+    update();
     if (m_control.map() != nullptr){
         m_control.onMouseWheelMove(event);
     }
@@ -417,6 +497,7 @@ void WidgetMapEditor::wheelEvent(QWheelEvent* event){
 // -------------------------------------------------------
 
 void WidgetMapEditor::mouseMoveEvent(QMouseEvent* event){
+    update();
     if (m_control.map() != nullptr) {
 
         // Multi keys
@@ -453,6 +534,7 @@ void WidgetMapEditor::mouseMoveEvent(QMouseEvent* event){
 // -------------------------------------------------------
 
 void WidgetMapEditor::mousePressEvent(QMouseEvent* event){
+    update();
     this->setFocus();
     if (m_control.map() != nullptr){
         Qt::MouseButton button = event->button();
@@ -486,6 +568,7 @@ void WidgetMapEditor::mousePressEvent(QMouseEvent* event){
 // -------------------------------------------------------
 
 void WidgetMapEditor::mouseReleaseEvent(QMouseEvent* event){
+    update();
     this->setFocus();
     if (m_control.map() != nullptr && m_menuBar != nullptr){
         Qt::MouseButton button = event->button();
@@ -503,6 +586,7 @@ void WidgetMapEditor::mouseReleaseEvent(QMouseEvent* event){
 // -------------------------------------------------------
 
 void WidgetMapEditor::mouseDoubleClickEvent(QMouseEvent*){
+    update();
     this->setFocus();
     if (m_control.map() != nullptr){
         if (m_menuBar != nullptr){
@@ -515,6 +599,7 @@ void WidgetMapEditor::mouseDoubleClickEvent(QMouseEvent*){
 // -------------------------------------------------------
 
 void WidgetMapEditor::keyPressEvent(QKeyEvent* event){
+    update();
     if (m_control.map() != nullptr){
         if (m_keysPressed.isEmpty()){
             m_firstPressure = true;
@@ -621,6 +706,7 @@ void WidgetMapEditor::keyPressEvent(QKeyEvent* event){
 // -------------------------------------------------------
 
 void WidgetMapEditor::keyReleaseEvent(QKeyEvent* event){
+    update();
     if (m_control.map() != nullptr){
         if (!event->isAutoRepeat()){
             m_keysPressed -= event->key();
@@ -24,6 +24,7 @@
 #include <QOpenGLFunctions>
 #include <QVector3D>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QSpinBox>
 #include "widgetmenubarmapeditor.h"
 #include "paneltextures.h"
@@ -44,6 +45,7 @@ class WidgetMapEditor : public QOpenGLWidget,
 public:
     explicit WidgetMapEditor(QWidget *parent = 0);
     ~WidgetMapEditor();
+    static const int ANIMATION_INTERVAL;
     void setMenuBar(WidgetMenuBarMapEditor* m);
     void setPanelTextures(PanelTextures* m);
     void setTreeMapNode(QStandardItem* item);
@@ -72,6 +74,7 @@ public:
     void addObject();
     void deleteObject();
     void removePreviewElements();
+    QString getFrameInfos() const;
     void renderText(QPainter& p, double x, double y, const QString &text,
                     const QFont& font = QFont(),
                     const QColor& fontColor = QColor(),
@@ -90,6 +93,10 @@ private:
     int m_idMap;
     QSet<int> m_keysPressed;
     QTimer* m_timerFirstPressure;
+    QTimer* m_timerRender;
+    QElapsedTimer m_timerFrame;
+    qint64 m_frameInterval;
+    double m_frameTime;
     bool m_firstPressure;
     QSpinBox* m_spinBoxX;
     QSpinBox* m_spinBoxZ;
@@ -103,10 +110,12 @@ private:
 
 public slots:
     void update();
+    void onFrameSwapped();
     void onFirstPressure();
 
 protected slots:
     void focusOutEvent(QFocusEvent*);
+    void changeEvent(QEvent* event);
     void wheelEvent(QWheelEvent* event);
     void mouseMoveEvent(QMouseEvent *event);
     void mousePressEvent(QMouseEvent* event);
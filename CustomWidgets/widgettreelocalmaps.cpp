@@ -112,8 +112,10 @@ QStandardItemModel* WidgetTreeLocalMaps::getModel() const { return m_model; }
 
 void WidgetTreeLocalMaps::updateNodeSaved(QStandardItem* item){
     TreeMapTag* tag = (TreeMapTag*) item->data().value<quintptr>();
-    if (tag != nullptr)
-        item->setText(tag->name());
+    if (tag != nullptr) {
+        bool saved = tag->isDir() || !Wanok::mapsToSave.contains(tag->id());
+        item->setText(saved ? tag->name() : tag->name() + " *");
+    }
 }
 
 // -------------------------------------------------------
@@ -518,13 +520,19 @@ void WidgetTreeLocalMaps::contextEditMap(){
 
         DialogMapProperties dialog(properties);
         if (dialog.exec() == QDialog::Accepted){
-            QString pathTemp = Common::pathCombine(path,
-                                                  Wanok::TEMP_MAP_FOLDER_NAME);
-            if (Wanok::mapsToSave.contains(properties.id())) {
-                Common::copyAllFiles(pathTemp, path);
-                Common::deleteAllFiles(pathTemp);
+
+            // The map opened in the editor is saved through its own files,
+            // released while the map is corrected (it is reloaded after)
+            Map* map = Wanok::get()->project()->currentMap();
+            bool isCurrent = map != nullptr &&
+                    map->mapProperties()->id() == properties.id();
+            if (Wanok::mapsToSave.contains(properties.id()) &&
+                (isCurrent ? map->save() : Map::copyTempFiles(path)))
+            {
                 Wanok::mapsToSave.remove(properties.id());
             }
+            if (isCurrent)
+                map->closePortionsFiles();
             properties.save(path);
             tag->reset();
             Map::correctMap(path, previousProperties, properties);
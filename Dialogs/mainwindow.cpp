@@ -22,6 +22,7 @@
 #include <QProcess>
 #include <QJsonDocument>
 #include <QDebug>
+#include <QThread>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "dialognewproject.h"
@@ -38,6 +39,7 @@
 #include "widgettreelocalmaps.h"
 #include "dialoglocation.h"
 #include "dialogprogress.h"
+#include "mapssaver.h"
 #include "dialogspecialelements.h"
 #include "dialogdebugoptions.h"
 #include "dialogsongs.h"
@@ -159,10 +161,16 @@ bool MainWindow::closeProject(){
     Wanok::mapsToSave.clear();
     Wanok::mapsUndoRedo.clear();
     enableNoGame();
+
+    // The map textures are released in the project cache, deleted with the
+    // map editor context current
+    WidgetMapEditor* mapEditor = ((PanelProject*)mainPanel)->widgetMapEditor();
+    mapEditor->deleteMap();
+    project->texturesCache()->clear();
+    mapEditor->doneCurrent();
     delete project;
     project = nullptr;
     Wanok::get()->setProject(nullptr);
-    WidgetMapEditor* mapEditor = ((PanelProject*)mainPanel)->widgetMapEditor();
     mapEditor->setVisible(false);
     replaceMainPanel(new PanelMainMenu(this));
 
@@ -245,16 +253,46 @@ void MainWindow::enableGame(){ // When a project is opened
 // -------------------------------------------------------
 
 void MainWindow::saveAllMaps(){
-
-    // Save all the maps
-    QSet<int>::iterator i;
-    for (i = Wanok::mapsToSave.begin(); i != Wanok::mapsToSave.end(); i++){
-        Map map(*i);
-        map.save();
+    if (Wanok::mapsToSave.isEmpty())
+        return;
+
+    // The current map is still streamed by the editor while the other maps
+    // are saved in parallel: it is saved here, through its own files
+    QSet<int> ids = Wanok::mapsToSave;
+    Map* currentMap = project->currentMap();
+    if (currentMap != nullptr) {
+        int id = currentMap->mapProperties()->id();
+        if (ids.remove(id)) {
+            bool saved = currentMap->save();
+            if (saved)
+                Wanok::mapsToSave.remove(id);
+            currentMap->setSaved(saved);
+        }
+    }
+    if (ids.isEmpty()) {
+        ((PanelProject*)mainPanel)->widgetTreeLocalMaps()
+                ->updateAllNodesSaved();
+        return;
     }
-    if (project->currentMap() != nullptr)
-        project->currentMap()->setSaved(true);
-    Wanok::mapsToSave.clear();
+
+    DialogProgress dialog(this);
+    QThread thread;
+    MapsSaver saver(Common::pathCombine(project->pathCurrentProject(),
+                                        Wanok::pathMaps), ids);
+    saver.moveToThread(&thread);
+    connect(&thread, SIGNAL(started()), &saver, SLOT(save()));
+    connect(&saver, SIGNAL(progress(int, QString)),
+            &dialog, SLOT(setValueLabel(int, QString)));
+    connect(&saver, SIGNAL(count(int)), &dialog, SLOT(setCount(int)));
+    connect(&saver, SIGNAL(mapSaved()), &dialog, SLOT(addOne()));
+    connect(&saver, SIGNAL(finished()), &dialog, SLOT(accept()));
+    thread.start();
+    dialog.exec();
+    thread.quit();
+    thread.wait();
+
+    // The maps that couldn't be saved keep their edits
+    Wanok::mapsToSave.subtract(saver.savedMaps());
 
     // Remove *
     ((PanelProject*)mainPanel)->widgetTreeLocalMaps()->updateAllNodesSaved();
@@ -322,7 +360,8 @@ void MainWindow::on_actionBrowse_triggered(){
 
 void MainWindow::on_actionSave_triggered(){
     if (project->currentMap() != nullptr) {
-        project->saveCurrentMap();
+        if (!project->saveCurrentMap())
+            return;
         Wanok::mapsToSave.remove(project->currentMap()->mapProperties()->id());
         ((PanelProject*)mainPanel)->widgetMapEditor()->save();
     }
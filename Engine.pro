@@ -72,6 +72,17 @@ HEADERS += \
     CustomWidgets/widgetmenubarmapeditor.h \
     Enums/mapeditorselectionkind.h \
     MapEditor/mapportion.h \
+    MapEditor/mapportionscache.h \
+    MapEditor/mapportionscontainer.h \
+    MapEditor/mapeditjournal.h \
+    MapEditor/glbufferarena.h \
+    MapEditor/glelementsranges.h \
+    MapEditor/mapoverlay.h \
+    MapEditor/maprenderlist.h \
+    MapEditor/textureatlas.h \
+    MapEditor/raycastinglevels.h \
+    MapEditor/raycastingbvh.h \
+    MapEditor/landsgrid.h \
     MapEditor/floors.h \
     MapEditor/camera.h \
     MapEditor/grid.h \
@@ -189,6 +200,7 @@ HEADERS += \
     Models/GameDatas/picturesdatas.h \
     CustomWidgets/widgetpicturepreview.h \
     Enums/mapeditorsubselectionkind.h \
+    Enums/maprenderkind.h \
     CustomWidgets/paneltextures.h \
     CustomWidgets/widgetvariable.h \
     Models/GameDatas/variablesdatas.h \
@@ -209,6 +221,12 @@ HEADERS += \
     MapEditor/lands.h \
     MapEditor/vertexbillboard.h \
     MapEditor/threadmapportionloader.h \
+    MapEditor/threadmapsaver.h \
+    MapEditor/texturecomposition.h \
+    MapEditor/threadtextureloader.h \
+    MapEditor/texturesloader.h \
+    MapEditor/texturescache.h \
+    MapEditor/mapssaver.h \
     Dialogs/Commands/dialogcommandmovecamera.h \
     Models/projectupdater.h \
     Dialogs/dialogprogress.h \
@@ -229,6 +247,8 @@ HEADERS += \
     MapEditor/floor.h \
     Enums/cameraupdownkind.h \
     Controls/MapEditor/controlundoredo.h \
+    Controls/MapEditor/mapedittransaction.h \
+    Controls/MapEditor/undoredohistory.h \
     Dialogs/SpecialElements/dialogtilesetspecialelements.h \
     Dialogs/SpecialElements/dialogspecialelements.h \
     Dialogs/SpecialElements/panelspecialelements.h \
@@ -238,6 +258,7 @@ HEADERS += \
     MapEditor/autotiles.h \
     MapEditor/textureautotile.h \
     MapEditor/autotile.h \
+    MapEditor/autotilesregion.h \
     Dialogs/dialogcollisions.h \
     Models/collisionsquare.h \
     Enums/collisionresizekind.h \
@@ -282,6 +303,17 @@ SOURCES += \
     CustomWidgets/widgettextlang.cpp \
     CustomWidgets/widgetmenubarmapeditor.cpp \
     MapEditor/mapportion.cpp \
+    MapEditor/mapportionscache.cpp \
+    MapEditor/mapportionscontainer.cpp \
+    MapEditor/mapeditjournal.cpp \
+    MapEditor/glbufferarena.cpp \
+    MapEditor/glelementsranges.cpp \
+    MapEditor/mapoverlay.cpp \
+    MapEditor/maprenderlist.cpp \
+    MapEditor/textureatlas.cpp \
+    MapEditor/raycastinglevels.cpp \
+    MapEditor/raycastingbvh.cpp \
+    MapEditor/landsgrid.cpp \
     MapEditor/floors.cpp \
     MapEditor/camera.cpp \
     MapEditor/grid.cpp \
@@ -407,6 +439,12 @@ SOURCES += \
     MapEditor/lands.cpp \
     MapEditor/vertexbillboard.cpp \
     MapEditor/threadmapportionloader.cpp \
+    MapEditor/threadmapsaver.cpp \
+    MapEditor/texturecomposition.cpp \
+    MapEditor/threadtextureloader.cpp \
+    MapEditor/texturesloader.cpp \
+    MapEditor/texturescache.cpp \
+    MapEditor/mapssaver.cpp \
     Dialogs/Commands/dialogcommandmovecamera.cpp \
     Models/projectupdater.cpp \
     Dialogs/dialogprogress.cpp \
@@ -422,10 +460,13 @@ SOURCES += \
     MapEditor/land.cpp \
     MapEditor/floor.cpp \
     Controls/MapEditor/controlundoredo.cpp \
+    Controls/MapEditor/mapedittransaction.cpp \
+    Controls/MapEditor/undoredohistory.cpp \
     Controls/MapEditor/controlmapeditor-preview.cpp \
     Controls/MapEditor/controlmapeditor-raycasting.cpp \
     Controls/MapEditor/controlmapeditor-add-remove.cpp \
     Controls/MapEditor/controlmapeditor-objects.cpp \
+    Controls/MapEditor/controlmapeditor-transaction.cpp \
     Dialogs/SpecialElements/dialogspecialelements.cpp \
     Dialogs/SpecialElements/dialogtilesetspecialelements.cpp \
     Dialogs/SpecialElements/panelspecialelements.cpp \
@@ -438,6 +479,7 @@ SOURCES += \
     MapEditor/autotiles.cpp \
     MapEditor/textureautotile.cpp \
     MapEditor/autotile.cpp \
+    MapEditor/autotilesregion.cpp \
     Dialogs/dialogcollisions.cpp \
     Models/collisionsquare.cpp \
     Dialogs/dialogrect.cpp \
@@ -21,6 +21,7 @@
 #include "wanok.h"
 #include "systemmapobject.h"
 #include "common.h"
+#include <QDir>
 
 // -------------------------------------------------------
 //
@@ -29,6 +30,9 @@
 // -------------------------------------------------------
 
 Map::Map() :
+    m_stopPortionsLoaders(false),
+    m_drawCalls(0),
+    m_generation(0),
     m_mapProperties(new MapProperties),
     m_mapPortions(nullptr),
     m_cursor(nullptr),
@@ -43,6 +47,9 @@ Map::Map() :
 }
 
 Map::Map(int id) :
+    m_stopPortionsLoaders(false),
+    m_drawCalls(0),
+    m_generation(0),
     m_mapPortions(nullptr),
     m_cursor(nullptr),
     m_modelObjects(new QStandardItemModel),
@@ -57,13 +64,22 @@ Map::Map(int id) :
                                           Wanok::pathMaps);
     m_pathMap = Common::pathCombine(pathMaps, realName);
 
-    // Temp map files
+    // Temp map files, unless the journal still has the edits of a session
+    // that didn't end properly
+    QString pathTemp = Common::pathCombine(m_pathMap,
+                                          Wanok::TEMP_MAP_FOLDER_NAME);
+    QString pathJournal = Common::pathCombine(pathTemp,
+                                             MapEditJournal::FILE_NAME);
     if (!Wanok::mapsToSave.contains(id)) {
-        QString pathTemp = Common::pathCombine(m_pathMap,
-                                              Wanok::TEMP_MAP_FOLDER_NAME);
-        Common::deleteAllFiles(pathTemp);
-        QFile(Common::pathCombine(m_pathMap, Wanok::fileMapObjects)).copy(
-                    Common::pathCombine(pathTemp, Wanok::fileMapObjects));
+        MapEditJournal journal;
+        if (journal.open(pathJournal) && journal.count() > 0)
+            Wanok::mapsToSave.insert(id);
+        else {
+            journal.close();
+            Common::deleteAllFiles(pathTemp);
+            QFile(Common::pathCombine(m_pathMap, Wanok::fileMapObjects)).copy(
+                        Common::pathCombine(pathTemp, Wanok::fileMapObjects));
+        }
     }
     if (!Wanok::mapsUndoRedo.contains(id)) {
         Common::deleteAllFiles(
@@ -75,12 +91,22 @@ Map::Map(int id) :
     m_saved = !Wanok::mapsToSave.contains(id);
     m_portionsRay = Wanok::get()->getPortionsRay() + 1;
     m_squareSize = Wanok::get()->getSquareSize();
+    m_portionsCache.setMemoryBudget(Wanok::get()->engineSettings()
+                                    ->portionsCacheMemory() * 1024);
 
     // Loading textures
     loadTextures();
+
+    // Portions are streamed by a pool of loaders
+    openPortionsFiles();
+    readPortionsOccupied();
+    startPortionsLoaders();
 }
 
 Map::Map(MapProperties* properties) :
+    m_stopPortionsLoaders(false),
+    m_drawCalls(0),
+    m_generation(0),
     m_mapProperties(properties),
     m_mapPortions(nullptr),
     m_cursor(nullptr),
@@ -92,9 +118,11 @@ Map::Map(MapProperties* properties) :
 }
 
 Map::~Map() {
+    stopPortionsLoaders();
     delete m_cursor;
     delete m_mapProperties;
     deletePortions();
+    m_portionsCache.clear();
     SuperListItem::deleteModel(m_modelObjects);
 
     if (m_programStatic != nullptr)
@@ -121,17 +149,30 @@ void Map::setSaved(bool b){ m_saved = b; }
 
 QStandardItemModel* Map::modelObjects() const { return m_modelObjects; }
 
-MapPortion* Map::mapPortion(Portion &p) const {
+MapPortionsCache& Map::portionsCache() { return m_portionsCache; }
+
+const MapRenderList& Map::renderList() const { return m_renderList; }
+
+int Map::drawCalls() const { return m_drawCalls; }
+
+unsigned int Map::generation() const { return m_generation; }
+
+MapPortion* Map::mapPortion(Portion &p) {
     return mapPortion(p.x(), p.y(), p.z());
 }
 
-MapPortion* Map::mapPortion(int x, int y, int z) const {
+MapPortion* Map::mapPortion(int x, int y, int z) {
     int index = portionIndex(x, y, z);
+    MapPortion* mapPortion = mapPortionBrut(index);
 
-    return mapPortionBrut(index);
+    // The content of a portion still streamed can't be used yet
+    if (mapPortion != nullptr && !mapPortion->isLoaded())
+        waitPortionLoaded(mapPortion);
+
+    return mapPortion;
 }
 
-MapPortion* Map::mapPortionFromGlobal(Portion& p) const {
+MapPortion* Map::mapPortionFromGlobal(Portion& p) {
     Portion portion = getLocalFromGlobalPortion(p);
 
     return mapPortion(portion);
@@ -163,6 +204,8 @@ void Map::setMapPortion(int x, int y, int z, MapPortion* mapPortion) {
     int index = portionIndex(x, y, z);
 
     m_mapPortions[index] = mapPortion;
+    m_renderList.setDirty();
+    m_generation++;
 }
 
 void Map::setMapPortion(Portion &p, MapPortion* mapPortion) {
@@ -211,20 +254,30 @@ QString Map::getPortionPathMap(int i, int j, int k){
 
 // -------------------------------------------------------
 
-QString Map::getPortionPath(int i, int j, int k) {
-    QString tempPath = getPortionPathTemp(i, j, k);
-    if (QFile(tempPath).exists())
-        return tempPath;
-    else
-        return Common::pathCombine(m_pathMap, getPortionPathMap(i, j, k));
+QString Map::getPortionPathMapBinary(int i, int j, int k){
+    return QString::number(i) + "_" + QString::number(j) + "_" +
+            QString::number(k) + ".bin";
+}
+
+// -------------------------------------------------------
+
+QString Map::getPortionFile(QString path, int i, int j, int k) {
+    QString pathBinary = Common::pathCombine(path,
+                                            getPortionPathMapBinary(i, j, k));
+    if (QFile(pathBinary).exists())
+        return pathBinary;
+
+    QString pathJSON = Common::pathCombine(path, getPortionPathMap(i, j, k));
+    if (QFile(pathJSON).exists())
+        return pathJSON;
+
+    return "";
 }
 
 // -------------------------------------------------------
 
-QString Map::getPortionPathTemp(int i, int j, int k) {
-    return Common::pathCombine(m_pathMap, Common::pathCombine(
-                                  Wanok::TEMP_MAP_FOLDER_NAME,
-                                  getPortionPathMap(i, j, k)));
+QString Map::getPortionPath(int i, int j, int k) {
+    return getPortionFile(m_pathMap, i, j, k);
 }
 
 // -------------------------------------------------------
@@ -248,25 +301,68 @@ void Map::setModelObjects(QStandardItemModel* model){
 
 // -------------------------------------------------------
 
-MapPortion* Map::loadPortionMap(int i, int j, int k, bool force){
-
+bool Map::isPortionInMap(int i, int j, int k) const {
     int lx = (m_mapProperties->length() - 1) / Wanok::portionSize;
     int ly = (m_mapProperties->depth() + m_mapProperties->height() - 1) /
             Wanok::portionSize;;
     int lz = (m_mapProperties->width() - 1) / Wanok::portionSize;
 
-    if (force || (i >= 0 && i <= lx && j >= 0 && j <= ly && k >= 0 && k <= lz)){
+    return i >= 0 && i <= lx && j >= 0 && j <= ly && k >= 0 && k <= lz;
+}
+
+// -------------------------------------------------------
+
+void Map::readPortionsOccupied() {
+    QStringList filters;
+    filters << "*.json" << "*.bin";
+    QFileInfoList files;
+    Portion portion;
+
+    m_portionsOccupied = m_portionsContainer.portions().toSet();
+
+    // Saved files, then the journal edits that can hide them
+    files = QDir(m_pathMap).entryInfoList(filters, QDir::Files);
+    for (int i = 0; i < files.size(); i++) {
+        if (files.at(i).size() > 0 &&
+            getPortionFromFileName(files.at(i).fileName(), portion))
+        {
+            m_portionsOccupied += portion;
+        }
+    }
+    QList<Portion> portions = m_journal.portions();
+    for (int i = 0; i < portions.size(); i++) {
+        portion = portions.at(i);
+        if (m_journal.isPortionEmpty(portion))
+            m_portionsOccupied -= portion;
+        else
+            m_portionsOccupied += portion;
+    }
+}
+
+// -------------------------------------------------------
+
+bool Map::isPortionOccupied(Portion& portion) {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    return m_portionsOccupied.contains(portion);
+}
+
+// -------------------------------------------------------
+
+MapPortion* Map::loadPortionMap(int i, int j, int k, bool force){
+    if (force || isPortionInMap(i, j, k)) {
         Portion portion(i, j, k);
-        QString path = getPortionPath(i, j, k);
-        MapPortion* mapPortion = new MapPortion(portion);
-        Wanok::readJSON(path, *mapPortion);
-        mapPortion->setIsLoaded(false);
-        /*
-        ThreadMapPortionLoader thread(this, portion);
-        thread.start();
-        */
-        loadPortionThread(mapPortion);
-        mapPortion->setIsLoaded(true);
+        MapPortion* mapPortion = m_portionsCache.take(portion);
+
+        if (mapPortion == nullptr) {
+            MapPortion* prefetched = m_portionsPrefetching.take(portion);
+            if (prefetched != nullptr)
+                setPortionOutdated(prefetched);
+            mapPortion = new MapPortion(portion);
+            loadPortionThread(mapPortion);
+        }
+        loadPortionGL(mapPortion);
+
         return mapPortion;
     }
 
@@ -276,16 +372,28 @@ MapPortion* Map::loadPortionMap(int i, int j, int k, bool force){
 
 // -------------------------------------------------------
 
-void Map::savePortionMap(MapPortion* mapPortion){
+bool Map::savePortionMap(MapPortion* mapPortion){
+    if (mapPortion->isReadOnly())
+        return true;
+
     Portion portion;
     mapPortion->getGlobalPortion(portion);
-    QString path = getPortionPathTemp(portion.x(), portion.y(), portion.z());
-    if (mapPortion->isEmpty()) {
-        QJsonObject obj;
-        Common::writeOtherJSON(path, obj);
-    }
+
+    // Copies in memory are not up to date anymore
+    m_portionsCache.remove(portion);
+    MapPortion* prefetched = m_portionsPrefetching.take(portion);
+    if (prefetched != nullptr)
+        setPortionOutdated(prefetched);
+
+    m_mutexPortionsLoading.lock();
+    if (mapPortion->isEmpty())
+        m_portionsOccupied.remove(portion);
     else
-        Wanok::writeJSON(path, *mapPortion);
+        m_portionsOccupied.insert(portion);
+    m_mutexPortionsLoading.unlock();
+
+    // An empty record hides the saved portion until the map is saved
+    return m_journal.append(*mapPortion);
 }
 
 // -------------------------------------------------------
@@ -313,9 +421,31 @@ QString Map::getMapObjectsPath() const{
 void Map::loadPortion(int realX, int realY, int realZ, int x, int y, int z,
                       bool visible)
 {
-    MapPortion* newMapPortion = loadPortionMap(realX, realY, realZ);
-    if (newMapPortion != nullptr)
+    MapPortion* newMapPortion = nullptr;
+
+    if (isPortionInMap(realX, realY, realZ)) {
+        Portion portion(realX, realY, realZ);
+
+        // Already decoded by the prefetch (only the GL buffers are missing)
+        // or recently removed from the grid
+        newMapPortion = m_portionsCache.take(portion);
+        if (newMapPortion != nullptr) {
+            if (!newMapPortion->isLoaded()) {
+                QMutexLocker locker(&m_mutexPortionsLoading);
+                m_portionsLoaded.append(newMapPortion);
+            }
+        }
+        else {
+
+            // Still being prefetched: it simply becomes a regular loading
+            newMapPortion = m_portionsPrefetching.take(portion);
+            if (newMapPortion == nullptr) {
+                newMapPortion = new MapPortion(portion);
+                addPortionToLoad(newMapPortion);
+            }
+        }
         newMapPortion->setIsVisible(visible);
+    }
 
     setMapPortion(x, y, z, newMapPortion);
 }
@@ -324,11 +454,285 @@ void Map::loadPortion(int realX, int realY, int realZ, int x, int y, int z,
 
 void Map::loadPortionThread(MapPortion* portion)
 {
+    Portion globalPortion;
+    portion->getGlobalPortion(globalPortion);
+
+    // Known empty portions don't need any file access
+    if (isPortionOccupied(globalPortion)) {
+        bool read;
+        if (m_journal.contains(globalPortion))
+            read = m_journal.readPortion(*portion);
+        else {
+            QString path = getPortionPath(globalPortion.x(), globalPortion.y(),
+                                          globalPortion.z());
+            if (path.isEmpty())
+                read = m_portionsContainer.readPortion(*portion);
+            else
+                read = readPortion(path, *portion);
+        }
+
+        // An occupied portion that couldn't be read is not an empty portion
+        if (!read)
+            portion->setIsReadOnly(true);
+    }
     portion->initializeVertices(m_squareSize, m_textureTileset,
                                 m_texturesAutotiles, m_texturesCharacters,
                                 m_texturesSpriteWalls);
+}
+
+// -------------------------------------------------------
+
+void Map::loadPortionGL(MapPortion* portion)
+{
     portion->initializeGL(m_programStatic, m_programFaceSprite);
     portion->updateGL();
+    portion->setIsLoaded(true);
+    m_renderList.setDirty();
+    m_generation++;
+}
+
+// -------------------------------------------------------
+
+void Map::startPortionsLoaders() {
+    int count = qMax(1, QThread::idealThreadCount() - 1);
+
+    m_stopPortionsLoaders = false;
+    for (int i = 0; i < count; i++) {
+        ThreadMapPortionLoader* thread = new ThreadMapPortionLoader(this);
+        m_threadMapPortionLoaders.append(thread);
+        thread->start();
+    }
+}
+
+// -------------------------------------------------------
+
+void Map::stopPortionsLoaders() {
+    m_mutexPortionsLoading.lock();
+    m_stopPortionsLoaders = true;
+    m_conditionPortionsToLoad.wakeAll();
+    m_mutexPortionsLoading.unlock();
+
+    for (int i = 0; i < m_threadMapPortionLoaders.size(); i++) {
+        ThreadMapPortionLoader* thread = m_threadMapPortionLoaders.at(i);
+        thread->wait();
+        delete thread;
+    }
+    m_threadMapPortionLoaders.clear();
+}
+
+// -------------------------------------------------------
+
+void Map::addPortionToLoad(MapPortion* mapPortion) {
+
+    // Without any loader (maps not displayed), load it right now
+    if (m_threadMapPortionLoaders.isEmpty()) {
+        loadPortionThread(mapPortion);
+        loadPortionGL(mapPortion);
+        return;
+    }
+
+    QMutexLocker locker(&m_mutexPortionsLoading);
+    m_portionsToLoad.append(mapPortion);
+    m_conditionPortionsToLoad.wakeOne();
+}
+
+// -------------------------------------------------------
+
+MapPortion* Map::takePortionToLoad() {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    while (m_portionsToLoad.isEmpty() && !m_stopPortionsLoaders)
+        m_conditionPortionsToLoad.wait(&m_mutexPortionsLoading);
+    if (m_stopPortionsLoaders)
+        return nullptr;
+
+    MapPortion* mapPortion = m_portionsToLoad.takeFirst();
+    m_portionsLoading += mapPortion;
+
+    return mapPortion;
+}
+
+// -------------------------------------------------------
+
+void Map::setPortionThreadLoaded(MapPortion* mapPortion) {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+    m_portionsLoading.remove(mapPortion);
+    m_portionsLoaded.append(mapPortion);
+    m_conditionPortionsLoaded.wakeAll();
+}
+
+// -------------------------------------------------------
+
+void Map::waitPortionLoaded(MapPortion* mapPortion) {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    // Not taken by a loader yet: do it here instead of waiting for one
+    if (m_portionsToLoad.removeOne(mapPortion)) {
+        m_portionsLoading += mapPortion;
+        locker.unlock();
+        loadPortionThread(mapPortion);
+        setPortionThreadLoaded(mapPortion);
+        return;
+    }
+
+    while (m_portionsLoading.contains(mapPortion))
+        m_conditionPortionsLoaded.wait(&m_mutexPortionsLoading);
+}
+
+// -------------------------------------------------------
+
+void Map::waitPortionsLoading() {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    while (!m_portionsToLoad.isEmpty()) {
+        MapPortion* mapPortion = m_portionsToLoad.takeFirst();
+        m_portionsLoading += mapPortion;
+        locker.unlock();
+        loadPortionThread(mapPortion);
+        setPortionThreadLoaded(mapPortion);
+        locker.relock();
+    }
+    while (!m_portionsLoading.isEmpty())
+        m_conditionPortionsLoaded.wait(&m_mutexPortionsLoading);
+}
+
+// -------------------------------------------------------
+
+bool Map::cancelPortionLoading(MapPortion* mapPortion) {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    // Return false if the portion content was not read yet
+    if (m_portionsToLoad.removeOne(mapPortion))
+        return false;
+    while (m_portionsLoading.contains(mapPortion))
+        m_conditionPortionsLoaded.wait(&m_mutexPortionsLoading);
+    m_portionsLoaded.removeOne(mapPortion);
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+void Map::cachePortion(MapPortion* mapPortion) {
+    Portion portion;
+    mapPortion->getGlobalPortion(portion);
+
+    if (cancelPortionLoading(mapPortion)) {
+        mapPortion->setIsVisible(false);
+        m_portionsCache.add(portion, mapPortion);
+    }
+    else
+        delete mapPortion;
+    m_renderList.setDirty();
+    m_generation++;
+}
+
+// -------------------------------------------------------
+
+void Map::clearPortionsLoading() {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    m_portionsToLoad.clear();
+    while (!m_portionsLoading.isEmpty())
+        m_conditionPortionsLoaded.wait(&m_mutexPortionsLoading);
+    m_portionsLoaded.clear();
+
+    // Portions not in the grid are only owned here
+    QHash<Portion, MapPortion*>::iterator i;
+    for (i = m_portionsPrefetching.begin(); i != m_portionsPrefetching.end();
+         i++)
+    {
+        delete *i;
+    }
+    m_portionsPrefetching.clear();
+    QSet<MapPortion*>::iterator j;
+    for (j = m_portionsOutdated.begin(); j != m_portionsOutdated.end(); j++)
+        delete *j;
+    m_portionsOutdated.clear();
+}
+
+// -------------------------------------------------------
+
+void Map::updatePortionsLoaded() {
+    QList<MapPortion*> portions;
+
+    m_mutexPortionsLoading.lock();
+    portions = m_portionsLoaded;
+    m_portionsLoaded.clear();
+    m_mutexPortionsLoading.unlock();
+
+    for (int i = 0; i < portions.size(); i++) {
+        MapPortion* mapPortion = portions.at(i);
+        Portion portion;
+
+        if (m_portionsOutdated.remove(mapPortion)) {
+            delete mapPortion;
+            continue;
+        }
+
+        // Prefetched portions wait in the cache without GL buffers
+        mapPortion->getGlobalPortion(portion);
+        if (m_portionsPrefetching.value(portion) == mapPortion) {
+            m_portionsPrefetching.remove(portion);
+            m_portionsCache.add(portion, mapPortion);
+        }
+        else
+            loadPortionGL(mapPortion);
+    }
+}
+
+// -------------------------------------------------------
+
+bool Map::isLoadingPortions() {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    return !m_portionsToLoad.isEmpty() || !m_portionsLoading.isEmpty() ||
+           !m_portionsLoaded.isEmpty();
+}
+
+// -------------------------------------------------------
+
+void Map::setPortionOutdated(MapPortion* mapPortion) {
+    QMutexLocker locker(&m_mutexPortionsLoading);
+
+    if (m_portionsToLoad.removeOne(mapPortion))
+        delete mapPortion;
+    else
+        m_portionsOutdated += mapPortion;
+}
+
+// -------------------------------------------------------
+
+void Map::prefetchPortion(int i, int j, int k) {
+    Portion portion(i, j, k);
+
+    if (m_threadMapPortionLoaders.isEmpty() || !isPortionInMap(i, j, k) ||
+        m_portionsCache.contains(portion) ||
+        m_portionsPrefetching.contains(portion))
+    {
+        return;
+    }
+    Portion localPortion = getLocalFromGlobalPortion(portion);
+    if (isInPortion(localPortion, 0))
+        return;
+
+    MapPortion* mapPortion = new MapPortion(portion);
+    m_portionsPrefetching.insert(portion, mapPortion);
+    addPortionToLoad(mapPortion);
+}
+
+// -------------------------------------------------------
+
+void Map::clearPortionsCache() {
+    m_portionsCache.clear();
+
+    QHash<Portion, MapPortion*>::iterator i;
+    for (i = m_portionsPrefetching.begin(); i != m_portionsPrefetching.end();
+         i++)
+    {
+        setPortionOutdated(*i);
+    }
+    m_portionsPrefetching.clear();
 }
 
 // -------------------------------------------------------
@@ -336,7 +740,9 @@ void Map::loadPortionThread(MapPortion* portion)
 void Map::replacePortion(Portion& previousPortion, Portion& newPortion,
                          bool visible)
 {
-    MapPortion* mapPortion = this->mapPortion(newPortion);
+    MapPortion* mapPortion = mapPortionBrut(portionIndex(newPortion.x(),
+                                                         newPortion.y(),
+                                                         newPortion.z()));
     if (mapPortion != nullptr)
         mapPortion->setIsVisible(visible);
 
@@ -347,12 +753,35 @@ void Map::replacePortion(Portion& previousPortion, Portion& newPortion,
 
 void Map::updatePortion(MapPortion* mapPortion)
 {
-    mapPortion->updateSpriteWalls();
+    // Only rebuild the layers touched since the last update
+    int layers = mapPortion->layersToUpdate();
+    if (layers == 0)
+        layers = MapPortion::LAYER_ALL;
+
+    if (layers & MapPortion::LAYER_WALLS)
+        mapPortion->updateSpriteWalls();
     mapPortion->initializeVertices(m_squareSize, m_textureTileset,
                                    m_texturesAutotiles, m_texturesCharacters,
-                                   m_texturesSpriteWalls);
+                                   m_texturesSpriteWalls, layers);
     mapPortion->initializeGL(m_programStatic, m_programFaceSprite);
-    mapPortion->updateGL();
+    mapPortion->updateGL(layers);
+    mapPortion->clearLayersToUpdate();
+    m_renderList.setDirty();
+    m_generation++;
+}
+
+// -------------------------------------------------------
+
+void Map::updatePreview(QSet<MapPortion*>& portions) {
+    m_overlay.clearVertices();
+    QSet<MapPortion*>::iterator i;
+    for (i = portions.begin(); i != portions.end(); i++) {
+        (*i)->initializeVerticesPreview(m_overlay, m_squareSize,
+                                        m_textureTileset, m_texturesAutotiles);
+    }
+    m_overlay.initializeGL(m_programStatic, m_programFaceSprite);
+    m_overlay.updateGL();
+    m_generation++;
 }
 
 // -------------------------------------------------------
@@ -360,6 +789,8 @@ void Map::updatePortion(MapPortion* mapPortion)
 void Map::updateMapObjects() {
 
     // First, we need to reload only the characters textures
+    clearPortionsCache();
+    waitPortionsLoading();
     deleteCharactersTextures();
     loadCharactersTextures();
 
@@ -377,6 +808,8 @@ void Map::updateMapObjects() {
             mapPortion->updateGLObjects();
         }
     }
+    m_renderList.setDirty();
+    m_generation++;
 }
 
 // -------------------------------------------------------
@@ -434,12 +867,16 @@ void Map::loadPortions(Portion portion){
 // -------------------------------------------------------
 
 void Map::deletePortions(){
+    clearPortionsLoading();
     if (m_mapPortions != nullptr) {
         int totalSize = getMapPortionTotalSize();
         for (int i = 0; i < totalSize; i++)
             delete this->mapPortionBrut(i);
         delete[] m_mapPortions;
     }
+    m_renderList.clear();
+    m_renderList.setDirty();
+    m_generation++;
 }
 
 // -------------------------------------------------------
@@ -21,12 +21,21 @@
 #define MAP_H
 
 #include "mapportion.h"
+#include "mapportionscache.h"
+#include "mapportionscontainer.h"
+#include "mapeditjournal.h"
 #include "mapobjects.h"
 #include "mapproperties.h"
 #include "systemcommonobject.h"
 #include "threadmapportionloader.h"
 #include "cursor.h"
 #include "textureautotile.h"
+#include "glbufferarena.h"
+#include "maprenderlist.h"
+#include "textureatlas.h"
+#include "texturesloader.h"
+#include <QMutex>
+#include <QWaitCondition>
 
 // -------------------------------------------------------
 //
@@ -51,9 +60,13 @@ public:
     bool saved() const;
     void setSaved(bool b);
     QStandardItemModel* modelObjects() const;
-    MapPortion* mapPortion(Portion& p) const;
-    MapPortion* mapPortionFromGlobal(Portion& p) const;
-    MapPortion* mapPortion(int x, int y, int z) const;
+    MapPortionsCache& portionsCache();
+    const MapRenderList& renderList() const;
+    int drawCalls() const;
+    unsigned int generation() const;
+    MapPortion* mapPortion(Portion& p);
+    MapPortion* mapPortionFromGlobal(Portion& p);
+    MapPortion* mapPortion(int x, int y, int z);
     MapPortion* mapPortionBrut(int index) const;
     int portionIndex(int x, int y, int z) const;
     int getMapPortionSize() const;
@@ -91,16 +104,29 @@ public:
     static QString writeMap(QString path, MapProperties& properties,
                             QJsonArray &jsonObject);
     static QString getPortionPathMap(int i, int j, int k);
+    static QString getPortionPathMapBinary(int i, int j, int k);
+    static QString getPortionFile(QString path, int i, int j, int k);
+    static bool readPortion(QString path, MapPortion& mapPortion);
+    static bool writePortion(QString path, MapPortion& mapPortion,
+                             bool binary);
+    static bool getPortionFromFileName(QString fileName, Portion& portion);
+    static bool copyTempFiles(QString path);
+    static bool packPortions(QString path, MapEditJournal* journal = nullptr);
+    static void unpackPortions(QString path, bool binary);
+    static void writeEmptyPortions(QString path);
     static void setModelObjects(QStandardItemModel* model);
 
-    static void updateGLStatic(QOpenGLBuffer& vertexBuffer,
-                               QOpenGLBuffer& indexBuffer,
+    static GLBufferArena arenaStatic;
+    static GLBufferArena arenaFace;
+    static GLBufferArena arenaIndexes;
+    static void updateGLStatic(GLBufferRange& vertexRange,
+                               GLBufferRange& indexRange,
                                QVector<Vertex>& vertices,
                                QVector<GLuint>& indexes,
                                QOpenGLVertexArrayObject& vao,
                                QOpenGLShaderProgram* program);
-    static void updateGLFace(QOpenGLBuffer& vertexBuffer,
-                             QOpenGLBuffer& indexBuffer,
+    static void updateGLFace(GLBufferRange& vertexRange,
+                             GLBufferRange& indexRange,
                              QVector<VertexBillboard>& vertices,
                              QVector<GLuint>& indexes,
                              QOpenGLVertexArrayObject& vao,
@@ -109,37 +135,66 @@ public:
     void loadTextures();
     void deleteTextures();
     void loadCharactersTextures();
-    void loadPictures(PictureKind kind, QHash<int, QOpenGLTexture*>& textures);
+    void loadPictures(PictureKind kind, TextureAtlas& textures);
     void deleteCharactersTextures();
-    void loadSpecialPictures(PictureKind kind,
-                             QHash<int, QOpenGLTexture*>& textures);
-    void loadPicture(SystemPicture* picture, PictureKind kind, QImage &refImage);
+    void releaseAtlas(TextureAtlas& textures);
+    void loadSpecialPictures(PictureKind kind, TextureAtlas& textures);
+    void addPicture(TextureAtlas& textures, QHash<int, QString>& paths,
+                    int id, SystemPicture* picture, PictureKind kind);
+    void loadAtlas(PictureKind kind, TextureAtlas& textures,
+                   const QHash<int, QString>& paths);
     void loadAutotiles();
     TextureAutotile *loadPictureAutotile(
-            QPainter& painter, TextureAutotile* textureAutotile,
-            QImage& newImage, SystemPicture* picture, int& offset, int id);
+            TextureComposition& composition, TextureAutotile* textureAutotile,
+            SystemPicture* picture, int& offset, int id);
+    void addTextureAutotile(TextureAutotile* textureAutotile,
+                            const TextureComposition& composition);
     static void editPictureWall(QImage& image, QImage& refImage);
     TextureAutotile *editPictureAutotile(
-            QPainter& painter, TextureAutotile* textureAutotile,
-            QImage& newImage, QImage& image, int& offset, int id);
-    void paintPictureAutotile(QPainter& painter,
-                              QImage& image, int& offset, QPoint &point);
+            TextureComposition& composition, TextureAutotile* textureAutotile,
+            const QString& path, const QSize& size, int& offset, int id);
+    static void paintPictureAutotile(QPainter& painter, const QImage& image,
+                                     int offset, const QPoint& point,
+                                     int squareSize);
     static void editPictureAutotilePreview(QImage& image, QImage& refImage);
-    void addEmptyPicture(QHash<int, QOpenGLTexture*>& textures);
+    void addEmptyPicture(TextureAtlas& textures);
+    static int maxTextureSize();
     QOpenGLTexture* createTexture(QImage& image);
+    QOpenGLTexture* loadTexture(const TextureComposition& composition);
+    void updateTexturesLoaded();
+    bool isLoadingTextures() const;
     QString getPortionPath(int i, int j, int k);
-    QString getPortionPathTemp(int i, int j, int k);
+    bool isPortionInMap(int i, int j, int k) const;
+    void readPortionsOccupied();
+    bool isPortionOccupied(Portion& portion);
     MapPortion* loadPortionMap(int i, int j, int k, bool force = false);
-    void savePortionMap(MapPortion* mapPortion);
+    bool savePortionMap(MapPortion* mapPortion);
     void saveMapProperties();
     QString getMapInfosPath() const;
     QString getMapObjectsPath() const;
     void loadPortion(int realX, int realY, int realZ, int x, int y, int z,
                      bool visible);
     void loadPortionThread(MapPortion *portion);
+    void loadPortionGL(MapPortion *portion);
+    void startPortionsLoaders();
+    void stopPortionsLoaders();
+    void addPortionToLoad(MapPortion* mapPortion);
+    MapPortion* takePortionToLoad();
+    void setPortionThreadLoaded(MapPortion* mapPortion);
+    void waitPortionLoaded(MapPortion* mapPortion);
+    void waitPortionsLoading();
+    bool cancelPortionLoading(MapPortion* mapPortion);
+    void cachePortion(MapPortion* mapPortion);
+    void clearPortionsLoading();
+    void updatePortionsLoaded();
+    bool isLoadingPortions();
+    void setPortionOutdated(MapPortion* mapPortion);
+    void prefetchPortion(int i, int j, int k);
+    void clearPortionsCache();
     void replacePortion(Portion& previousPortion, Portion& newPortion,
                         bool visible);
     void updatePortion(MapPortion *mapPortion);
+    void updatePreview(QSet<MapPortion*>& portions);
     void updateSpriteWalls(MapEditorSubSelectionKind subSelection);
     void updateMapObjects();
     void loadPortions(Portion portion);
@@ -153,7 +208,9 @@ public:
     void getLocalPortion(Position3D &position, Portion& portion) const;
     Portion getGlobalFromLocalPortion(Portion& portion) const;
     Portion getLocalFromGlobalPortion(Portion& portion) const;
-    void save();
+    bool save();
+    void openPortionsFiles();
+    void closePortionsFiles();
     bool isObjectIdExisting(int id) const;
     int generateObjectId() const;
     static QString generateObjectName(int id);
@@ -171,6 +228,7 @@ public:
                                QJsonArray & tab);
 
     void initializeGL();
+    void updateRenderList();
     void paintFloors(QMatrix4x4 &modelviewProjection);
     void paintOthers(QMatrix4x4 &modelviewProjection,
                      QVector3D& cameraRightWorldSpace,
@@ -178,7 +236,24 @@ public:
                      QVector3D &cameraDeepWorldSpace);
 
 private:
-    QList<ThreadMapPortionLoader> m_threadMapPortionLoaders;
+    QList<ThreadMapPortionLoader*> m_threadMapPortionLoaders;
+    QMutex m_mutexPortionsLoading;
+    QWaitCondition m_conditionPortionsToLoad;
+    QWaitCondition m_conditionPortionsLoaded;
+    QList<MapPortion*> m_portionsToLoad;
+    QSet<MapPortion*> m_portionsLoading;
+    QList<MapPortion*> m_portionsLoaded;
+    bool m_stopPortionsLoaders;
+    QHash<Portion, MapPortion*> m_portionsPrefetching;
+    QSet<MapPortion*> m_portionsOutdated;
+    MapPortionsCache m_portionsCache;
+    MapPortionsContainer m_portionsContainer;
+    MapEditJournal m_journal;
+    QSet<Portion> m_portionsOccupied;
+    MapRenderList m_renderList;
+    MapOverlay m_overlay;
+    int m_drawCalls;
+    unsigned int m_generation;
     MapProperties* m_mapProperties;
     MapPortion** m_mapPortions;
     Cursor* m_cursor;
@@ -200,9 +275,10 @@ private:
     int u_modelViewProjection;
 
     // Textures
+    TexturesLoader m_texturesLoader;
     QOpenGLTexture* m_textureTileset;
-    QHash<int, QOpenGLTexture*> m_texturesCharacters;
-    QHash<int, QOpenGLTexture*> m_texturesSpriteWalls;
+    TextureAtlas m_texturesCharacters;
+    TextureAtlas m_texturesSpriteWalls;
     QList<TextureAutotile*> m_texturesAutotiles;
     QOpenGLTexture* m_textureObjectSquare;
 };
@@ -20,6 +20,11 @@
 #include "map.h"
 #include "wanok.h"
 
+// Buffers shared by all the map portions
+GLBufferArena Map::arenaStatic(QOpenGLBuffer::VertexBuffer);
+GLBufferArena Map::arenaFace(QOpenGLBuffer::VertexBuffer);
+GLBufferArena Map::arenaIndexes(QOpenGLBuffer::IndexBuffer);
+
 // -------------------------------------------------------
 
 void Map::initializeGL(){
@@ -57,8 +62,8 @@ void Map::initializeGL(){
 
 // -------------------------------------------------------
 
-void Map::updateGLStatic(QOpenGLBuffer &vertexBuffer,
-                         QOpenGLBuffer &indexBuffer,
+void Map::updateGLStatic(GLBufferRange &vertexRange,
+                         GLBufferRange &indexRange,
                          QVector<Vertex> &vertices,
                          QVector<GLuint> &indexes,
                          QOpenGLVertexArrayObject &vao,
@@ -66,52 +71,46 @@ void Map::updateGLStatic(QOpenGLBuffer &vertexBuffer,
 {
     program->bind();
 
-    // If existing VAO or VBO, destroy it
-    if (vao.isCreated())
-        vao.destroy();
-    if (vertexBuffer.isCreated())
-        vertexBuffer.destroy();
-    if (indexBuffer.isCreated())
-        indexBuffer.destroy();
-
-    // Create new VBO for vertex
-    vertexBuffer.create();
-    vertexBuffer.bind();
-    vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    vertexBuffer.allocate(vertices.constData(),
-                          vertices.size() * sizeof(Vertex));
-
-    // Create new VBO for indexes
-    indexBuffer.create();
-    indexBuffer.bind();
-    indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    indexBuffer.allocate(indexes.constData(),
-                         indexes.size() * sizeof(GLuint));
-
-    // Create new VAO
-    vao.create();
+    // Patch the datas in the arenas
+    bool moved = arenaStatic.write(vertexRange, vertices.constData(),
+                                   vertices.size() * sizeof(Vertex));
+    moved = arenaIndexes.write(indexRange, indexes.constData(),
+                               indexes.size() * sizeof(GLuint)) || moved;
+
+    // The VAO only needs to be set again if the ranges moved
+    if ((vao.isCreated() && !moved) || vertexRange.arena() == nullptr ||
+        indexRange.arena() == nullptr)
+    {
+        program->release();
+        return;
+    }
+    if (!vao.isCreated())
+        vao.create();
     vao.bind();
+    arenaStatic.buffer().bind();
     program->enableAttributeArray(0);
     program->enableAttributeArray(1);
-    program->setAttributeBuffer(0, GL_FLOAT, Vertex::positionOffset(),
+    program->setAttributeBuffer(0, GL_FLOAT,
+                                vertexRange.offset() + Vertex::positionOffset(),
                                 Vertex::positionTupleSize,
                                 Vertex::stride());
-    program->setAttributeBuffer(1, GL_FLOAT, Vertex::texOffset(),
+    program->setAttributeBuffer(1, GL_FLOAT,
+                                vertexRange.offset() + Vertex::texOffset(),
                                 Vertex::texCoupleSize,
                                 Vertex::stride());
-    indexBuffer.bind();
+    arenaIndexes.buffer().bind();
 
     // Releases
     vao.release();
-    indexBuffer.release();
-    vertexBuffer.release();
+    arenaIndexes.buffer().release();
+    arenaStatic.buffer().release();
     program->release();
 }
 
 // -------------------------------------------------------
 
-void Map::updateGLFace(QOpenGLBuffer &vertexBuffer,
-                       QOpenGLBuffer &indexBuffer,
+void Map::updateGLFace(GLBufferRange &vertexRange,
+                       GLBufferRange &indexRange,
                        QVector<VertexBillboard> &vertices,
                        QVector<GLuint> &indexes,
                        QOpenGLVertexArrayObject &vao,
@@ -119,53 +118,49 @@ void Map::updateGLFace(QOpenGLBuffer &vertexBuffer,
 {
     program->bind();
 
-    // If existing VAO or VBO, destroy it
-    if (vao.isCreated())
-        vao.destroy();
-    if (vertexBuffer.isCreated())
-        vertexBuffer.destroy();
-    if (indexBuffer.isCreated())
-        indexBuffer.destroy();
-
-    // Create new VBO for vertex
-    vertexBuffer.create();
-    vertexBuffer.bind();
-    vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    vertexBuffer.allocate(vertices.constData(),
-                          vertices.size() * sizeof(VertexBillboard));
-
-    // Create new VBO for indexes
-    indexBuffer.create();
-    indexBuffer.bind();
-    indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    indexBuffer.allocate(indexes.constData(),
-                         indexes.size() * sizeof(GLuint));
-
-    // Create new VAO
-    vao.create();
+    // Patch the datas in the arenas
+    bool moved = arenaFace.write(vertexRange, vertices.constData(),
+                                 vertices.size() * sizeof(VertexBillboard));
+    moved = arenaIndexes.write(indexRange, indexes.constData(),
+                               indexes.size() * sizeof(GLuint)) || moved;
+
+    // The VAO only needs to be set again if the ranges moved
+    if ((vao.isCreated() && !moved) || vertexRange.arena() == nullptr ||
+        indexRange.arena() == nullptr)
+    {
+        program->release();
+        return;
+    }
+    if (!vao.isCreated())
+        vao.create();
     vao.bind();
+    arenaFace.buffer().bind();
     program->enableAttributeArray(0);
     program->enableAttributeArray(1);
     program->enableAttributeArray(2);
     program->enableAttributeArray(3);
-    program->setAttributeBuffer(0, GL_FLOAT, VertexBillboard::positionOffset(),
+    program->setAttributeBuffer(0, GL_FLOAT, vertexRange.offset() +
+                                VertexBillboard::positionOffset(),
                                 VertexBillboard::positionTupleSize,
                                 VertexBillboard::stride());
-    program->setAttributeBuffer(1, GL_FLOAT, VertexBillboard::texOffset(),
+    program->setAttributeBuffer(1, GL_FLOAT, vertexRange.offset() +
+                                VertexBillboard::texOffset(),
                                 VertexBillboard::texCoupleSize,
                                 VertexBillboard::stride());
-    program->setAttributeBuffer(2, GL_FLOAT, VertexBillboard::sizeOffset(),
+    program->setAttributeBuffer(2, GL_FLOAT, vertexRange.offset() +
+                                VertexBillboard::sizeOffset(),
                                 VertexBillboard::sizeCoupleSize,
                                 VertexBillboard::stride());
-    program->setAttributeBuffer(3, GL_FLOAT, VertexBillboard::modelOffset(),
+    program->setAttributeBuffer(3, GL_FLOAT, vertexRange.offset() +
+                                VertexBillboard::modelOffset(),
                                 VertexBillboard::modelTupleSize,
                                 VertexBillboard::stride());
-    indexBuffer.bind();
+    arenaIndexes.buffer().bind();
 
     // Releases
     vao.release();
-    indexBuffer.release();
-    vertexBuffer.release();
+    arenaIndexes.buffer().release();
+    arenaFace.buffer().release();
     program->release();
 }
 
@@ -184,31 +179,64 @@ QOpenGLShaderProgram* Map::createProgram(QString shaderName) {
 
 // -------------------------------------------------------
 
-void Map::paintFloors(QMatrix4x4& modelviewProjection) {
-    MapPortion* mapPortion;
+void Map::updateRenderList() {
+    if (!m_renderList.isDirty())
+        return;
+
+    m_renderList.clear();
     int totalSize = getMapPortionTotalSize();
+    for (int i = 0; i < totalSize; i++) {
+        MapPortion* mapPortion = this->mapPortionBrut(i);
+        if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
+            mapPortion->addToRenderList(m_renderList);
+    }
+}
+
+// -------------------------------------------------------
+
+void Map::paintFloors(QMatrix4x4& modelviewProjection) {
+    QList<MapPortion*> portions;
+    QList<int> textures;
+
+    updateRenderList();
+    m_drawCalls = 0;
 
     // Floors
     m_programStatic->bind();
     m_programStatic->setUniformValue(u_modelviewProjectionStatic,
                                      modelviewProjection);
     m_textureTileset->bind();
-    for (int i = 0; i < totalSize; i++) {
-        mapPortion = this->mapPortionBrut(i);
-        if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-            mapPortion->paintFloors();
-    }
+    portions = m_renderList.portions(MapRenderKind::Floors);
+    for (int i = 0; i < portions.size(); i++)
+        portions.at(i)->paintFloors();
+    m_drawCalls += portions.size();
+    m_overlay.paintFloors();
     m_textureTileset->release();
 
     // Autotiles
-    for (int j = 0; j < m_texturesAutotiles.size(); j++) {
-        QOpenGLTexture* texture = m_texturesAutotiles[j]->texture();
+    textures = m_renderList.textures(MapRenderKind::Autotiles);
+    for (int j = 0; j < textures.size(); j++) {
+        int textureID = textures.at(j);
+        if (textureID >= m_texturesAutotiles.size())
+            continue;
+        QOpenGLTexture* texture = m_texturesAutotiles[textureID]->texture();
         texture->bind();
-        for (int i = 0; i < totalSize; i++) {
-            mapPortion = this->mapPortionBrut(i);
-            if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-                mapPortion->paintAutotiles(j);
-        }
+        portions = m_renderList.portions(MapRenderKind::Autotiles, textureID);
+        for (int i = 0; i < portions.size(); i++)
+            portions.at(i)->paintAutotiles(textureID);
+        m_drawCalls += portions.size();
+        texture->release();
+    }
+
+    // Autotiles previews
+    textures = m_overlay.autotilesTextures();
+    for (int j = 0; j < textures.size(); j++) {
+        int textureID = textures.at(j);
+        if (textureID >= m_texturesAutotiles.size())
+            continue;
+        QOpenGLTexture* texture = m_texturesAutotiles[textureID]->texture();
+        texture->bind();
+        m_overlay.paintAutotiles(textureID);
         texture->release();
     }
 
@@ -222,8 +250,8 @@ void Map::paintOthers(QMatrix4x4 &modelviewProjection,
                       QVector3D &cameraUpWorldSpace,
                       QVector3D &cameraDeepWorldSpace)
 {
-    int totalSize = getMapPortionTotalSize();
-    MapPortion* mapPortion;
+    QList<MapPortion*> portions;
+    QList<int> textures;
 
     m_programStatic->bind();
     m_programStatic->setUniformValue(u_modelviewProjectionStatic,
@@ -231,40 +259,41 @@ void Map::paintOthers(QMatrix4x4 &modelviewProjection,
 
     // Sprites
     m_textureTileset->bind();
-    for (int i = 0; i < totalSize; i++) {
-        mapPortion = this->mapPortionBrut(i);
-        if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-            mapPortion->paintSprites();
-    }
+    portions = m_renderList.portions(MapRenderKind::Sprites);
+    for (int i = 0; i < portions.size(); i++)
+        portions.at(i)->paintSprites();
+    m_drawCalls += portions.size();
+    m_overlay.paintSprites();
     m_textureTileset->release();
 
     // Objects
-    QHash<int, QOpenGLTexture*>::iterator it;
-    for (it = m_texturesCharacters.begin();
-         it != m_texturesCharacters.end(); it++)
-    {
-        int textureID = it.key();
-        QOpenGLTexture* texture = it.value();
-        for (int i = 0; i < totalSize; i++) {
-            mapPortion = this->mapPortionBrut(i);
-            if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-                mapPortion->paintObjectsStaticSprites(textureID, texture);
-        }
+    textures = m_renderList.textures(MapRenderKind::ObjectsStatic);
+    for (int j = 0; j < textures.size(); j++) {
+        int textureID = textures.at(j);
+        QOpenGLTexture* texture = m_texturesCharacters.texture(textureID);
+        if (texture == nullptr)
+            continue;
+        texture->bind();
+        portions = m_renderList.portions(MapRenderKind::ObjectsStatic,
+                                         textureID);
+        for (int i = 0; i < portions.size(); i++)
+            portions.at(i)->paintObjectsStaticSprites(textureID);
+        m_drawCalls += portions.size();
+        texture->release();
     }
 
     // Walls
-    QHash<int, QOpenGLTexture*>::iterator itWalls;
-    for (itWalls = m_texturesSpriteWalls.begin();
-         itWalls != m_texturesSpriteWalls.end(); itWalls++)
-    {
-        int textureID = itWalls.key();
-        QOpenGLTexture* texture = itWalls.value();
+    textures = m_renderList.textures(MapRenderKind::Walls);
+    for (int j = 0; j < textures.size(); j++) {
+        int textureID = textures.at(j);
+        QOpenGLTexture* texture = m_texturesSpriteWalls.texture(textureID);
+        if (texture == nullptr)
+            continue;
         texture->bind();
-        for (int i = 0; i < totalSize; i++) {
-            mapPortion = this->mapPortionBrut(i);
-            if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-                mapPortion->paintSpritesWalls(textureID);
-        }
+        portions = m_renderList.portions(MapRenderKind::Walls, textureID);
+        for (int i = 0; i < portions.size(); i++)
+            portions.at(i)->paintSpritesWalls(textureID);
+        m_drawCalls += portions.size();
         texture->release();
     }
 
@@ -280,35 +309,37 @@ void Map::paintOthers(QMatrix4x4 &modelviewProjection,
     m_programFaceSprite->setUniformValue(u_modelViewProjection,
                                          modelviewProjection);
     m_textureTileset->bind();
-    for (int i = 0; i < totalSize; i++) {
-        mapPortion = this->mapPortionBrut(i);
-        if (mapPortion != nullptr && mapPortion->isVisible())
-            mapPortion->paintFaceSprites();
-    }
+    portions = m_renderList.portions(MapRenderKind::FaceSprites);
+    for (int i = 0; i < portions.size(); i++)
+        portions.at(i)->paintFaceSprites();
+    m_drawCalls += portions.size();
+    m_overlay.paintFaceSprites();
     m_textureTileset->release();
 
     // Objects face sprites
-    for (it = m_texturesCharacters.begin();
-         it != m_texturesCharacters.end(); it++)
-    {
-        int textureID = it.key();
-        QOpenGLTexture* texture = it.value();
-        for (int i = 0; i < totalSize; i++) {
-            mapPortion = this->mapPortionBrut(i);
-            if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-                mapPortion->paintObjectsFaceSprites(textureID, texture);
-        }
+    textures = m_renderList.textures(MapRenderKind::ObjectsFace);
+    for (int j = 0; j < textures.size(); j++) {
+        int textureID = textures.at(j);
+        QOpenGLTexture* texture = m_texturesCharacters.texture(textureID);
+        if (texture == nullptr)
+            continue;
+        texture->bind();
+        portions = m_renderList.portions(MapRenderKind::ObjectsFace,
+                                         textureID);
+        for (int i = 0; i < portions.size(); i++)
+            portions.at(i)->paintObjectsFaceSprites(textureID);
+        m_drawCalls += portions.size();
+        texture->release();
     }
     m_programFaceSprite->release();
 
     // Objects squares
     m_programStatic->bind();
     m_textureObjectSquare->bind();
-    for (int i = 0; i < totalSize; i++) {
-        mapPortion = this->mapPortionBrut(i);
-        if (mapPortion != nullptr && mapPortion->isVisibleLoaded())
-            mapPortion->paintObjectsSquares();
-    }
+    portions = m_renderList.portions(MapRenderKind::ObjectsSquares);
+    for (int i = 0; i < portions.size(); i++)
+        portions.at(i)->paintObjectsSquares();
+    m_drawCalls += portions.size();
     m_textureObjectSquare->release();
     m_programStatic->release();
 }
@@ -21,23 +21,36 @@
 #include "systemautotile.h"
 #include "wanok.h"
 #include "autotiles.h"
+#include "texturesloader.h"
+#include "texturescache.h"
+#include <QOpenGLContext>
 
 // -------------------------------------------------------
 
 void Map::loadTextures(){
-    deleteTextures();
 
-    // Tileset
-    QImage imageTileset(m_mapProperties->tileset()->picture()
-                        ->getPath(PictureKind::Tilesets));
-    m_textureTileset = createTexture(imageTileset);
+    // Loaders are reading the textures sizes
+    clearPortionsCache();
+    waitPortionsLoading();
+    deleteTextures();
+    m_renderList.setDirty();
+    m_generation++;
+
+    // Tileset, the pictures are decoded by the textures loader
+    QString path = m_mapProperties->tileset()->picture()->getPath(
+                PictureKind::Tilesets);
+    TextureComposition composition(TextureComposition::pictureSize(
+                                       path, PictureKind::Tilesets,
+                                       m_squareSize));
+    composition.addPicture(path, PictureKind::Tilesets, QPoint());
+    m_textureTileset = loadTexture(composition);
 
     // Characters && walls
     loadCharactersTextures();
     loadSpecialPictures(PictureKind::Walls, m_texturesSpriteWalls);
     loadAutotiles();
 
-    // Object square
+    // Object square, small enough to be loaded right away
     QImage imageObjectSquare(":/textures/Ressources/object_square.png");
     m_textureObjectSquare = createTexture(imageObjectSquare);
 }
@@ -45,47 +58,93 @@ void Map::loadTextures(){
 // -------------------------------------------------------
 
 void Map::deleteTextures(){
-    if (m_textureTileset != nullptr)
-        delete m_textureTileset;
+    TexturesCache* cache = Wanok::get()->project()->texturesCache();
+
+    // The textures are kept by the project for the next maps
+    m_texturesLoader.clear();
+    cache->release(m_textureTileset);
+    m_textureTileset = nullptr;
     deleteCharactersTextures();
-    for (QHash<int, QOpenGLTexture*>::iterator i = m_texturesSpriteWalls.begin()
-         ; i != m_texturesSpriteWalls.end(); i++)
-    {
-        delete *i;
-    }
-    m_texturesSpriteWalls.clear();
-    for (int i = 0; i < m_texturesAutotiles.size(); i++)
+    releaseAtlas(m_texturesSpriteWalls);
+    for (int i = 0; i < m_texturesAutotiles.size(); i++) {
+        cache->release(m_texturesAutotiles[i]->texture());
         delete m_texturesAutotiles[i];
+    }
     m_texturesAutotiles.clear();
     if (m_textureObjectSquare != nullptr)
         delete m_textureObjectSquare;
+    m_textureObjectSquare = nullptr;
 }
 
 // -------------------------------------------------------
 
 void Map::deleteCharactersTextures() {
-    for (QHash<int, QOpenGLTexture*>::iterator i = m_texturesCharacters.begin();
-         i != m_texturesCharacters.end(); i++)
-    {
-        delete *i;
-    }
-    m_texturesCharacters.clear();
+    for (int i = 0; i < m_texturesCharacters.pagesCount(); i++)
+        m_texturesLoader.cancel(m_texturesCharacters.texture(i));
+    releaseAtlas(m_texturesCharacters);
 }
 
 // -------------------------------------------------------
 
-void Map::loadPictures(PictureKind kind,
-                                 QHash<int, QOpenGLTexture*>& textures)
-{
+void Map::releaseAtlas(TextureAtlas& textures) {
+    TexturesCache* cache = Wanok::get()->project()->texturesCache();
+    for (int i = 0; i < textures.pagesCount(); i++)
+        cache->release(textures.texture(i));
+    textures.clear();
+}
+
+// -------------------------------------------------------
+
+void Map::updateTexturesLoaded() {
+    QList<QOpenGLTexture*> textures = m_texturesLoader.update();
+    if (textures.isEmpty())
+        return;
+
+    TexturesCache* cache = Wanok::get()->project()->texturesCache();
+    for (int i = 0; i < textures.size(); i++)
+        cache->setLoaded(textures.at(i));
+    m_generation++;
+}
+
+// -------------------------------------------------------
+
+bool Map::isLoadingTextures() const {
+    return m_texturesLoader.isLoading();
+}
+
+// -------------------------------------------------------
+
+QOpenGLTexture* Map::loadTexture(const TextureComposition& composition) {
+    TexturesCache* cache = Wanok::get()->project()->texturesCache();
+    QString key = composition.key();
+
+    // Already loaded for another map
+    QOpenGLTexture* texture = cache->acquire(key);
+    if (texture != nullptr)
+        return texture;
+
+    texture = TexturesLoader::createTexture(composition.size());
+    cache->add(key, texture);
+    if (composition.isEmpty())
+        cache->setLoaded(texture);
+    else
+        m_texturesLoader.load(texture, composition, m_squareSize);
+
+    return texture;
+}
+
+// -------------------------------------------------------
+
+void Map::loadPictures(PictureKind kind, TextureAtlas& textures) {
     SystemPicture* picture;
+    QHash<int, QString> paths;
     QStandardItemModel* model = Wanok::get()->project()->picturesDatas()
             ->model(kind);
     for (int i = 0; i < model->invisibleRootItem()->rowCount(); i++){
         picture = (SystemPicture*) model->item(i)->data().value<qintptr>();
-        QImage image;
-        loadPicture(picture, kind, image);
-        textures[picture->id()] = createTexture(image);
+        addPicture(textures, paths, picture->id(), picture, kind);
     }
+    loadAtlas(kind, textures, paths);
 }
 
 // -------------------------------------------------------
@@ -97,49 +156,66 @@ void Map::loadCharactersTextures()
 
 // -------------------------------------------------------
 
-void Map::loadSpecialPictures(PictureKind kind,
-                              QHash<int, QOpenGLTexture*>& textures)
-{
+void Map::loadSpecialPictures(PictureKind kind, TextureAtlas& textures) {
     SystemSpecialElement* special;
     SystemTileset* tileset = m_mapProperties->tileset();
     QStandardItemModel* model = tileset->model(kind);
     QStandardItemModel* modelSpecials = Wanok::get()->project()
             ->specialElementsDatas()->model(kind);
+    QHash<int, QString> paths;
     int id;
     for (int i = 0; i < model->invisibleRootItem()->rowCount(); i++) {
         id = ((SuperListItem*) model->item(i)->data().value<qintptr>())->id();
         special = (SystemSpecialElement*) SuperListItem::getById(
                     modelSpecials->invisibleRootItem(), id);
-        QImage image;
-        loadPicture(special->picture(), kind, image);
-        textures[special->id()] = createTexture(image);
+        addPicture(textures, paths, special->id(), special->picture(), kind);
     }
     addEmptyPicture(textures);
+    loadAtlas(kind, textures, paths);
 }
 
 // -------------------------------------------------------
 
-void Map::loadPicture(SystemPicture* picture, PictureKind kind,
-                      QImage& refImage)
+void Map::addPicture(TextureAtlas& textures, QHash<int, QString>& paths,
+                     int id, SystemPicture* picture, PictureKind kind)
 {
-    QImage image(1, 1, QImage::Format_ARGB32);
-    refImage = image;
     QString path = picture->getPath(kind);
+    QSize size = TextureComposition::pictureSize(path, kind, m_squareSize);
 
-    if (path.isEmpty())
-        image.fill(QColor(0, 0, 0, 0));
-    else {
-        image.load(path);
-        if (!image.isNull()) {
-            switch (kind) {
-            case PictureKind::Walls:
-                editPictureWall(image, refImage); break;
-            default:
-                refImage = image;
-                break;
-            }
-        }
+    // A picture bigger than the biggest texture can't be drawn
+    int maxSize = maxTextureSize();
+    if (size.width() > maxSize || size.height() > maxSize) {
+        qWarning("%s is too big to be loaded in a texture", qPrintable(path));
+        size = QSize();
     }
+
+    // A missing picture takes one transparent pixel
+    if (size.isEmpty())
+        size = QSize(1, 1);
+    else
+        paths.insert(id, path);
+    textures.addPicture(id, size);
+}
+
+// -------------------------------------------------------
+
+void Map::loadAtlas(PictureKind kind, TextureAtlas& textures,
+                    const QHash<int, QString>& paths)
+{
+    QList<TextureComposition> compositions;
+
+    // The pages are placed before any picture is decoded
+    textures.build(Wanok::MAX_PIXEL_SIZE);
+    for (int i = 0; i < textures.pagesCount(); i++)
+        compositions.append(TextureComposition(textures.pageSize(i)));
+    QHash<int, QString>::const_iterator j;
+    for (j = paths.begin(); j != paths.end(); j++) {
+        int id = j.key();
+        compositions[textures.page(id)].addPicture(
+                    j.value(), kind, textures.rect(id).topLeft());
+    }
+    for (int i = 0; i < compositions.size(); i++)
+        textures.setTexture(i, loadTexture(compositions.at(i)));
 }
 
 // -------------------------------------------------------
@@ -151,10 +227,8 @@ void Map::loadAutotiles() {
     QStandardItemModel* modelSpecials = Wanok::get()->project()
             ->specialElementsDatas()->model(PictureKind::Autotiles);
     int id;
-    QImage newImage(64 * m_squareSize, Wanok::MAX_PIXEL_SIZE,
-                    QImage::Format_ARGB32);
-    QPainter painter;
-    painter.begin(&newImage);
+    TextureComposition composition(QSize(64 * m_squareSize,
+                                         Wanok::MAX_PIXEL_SIZE));
     int offset = 0;
     TextureAutotile* textureAutotile = nullptr;
     for (int i = 0; i < model->invisibleRootItem()->rowCount(); i++) {
@@ -162,33 +236,26 @@ void Map::loadAutotiles() {
         special = (SystemSpecialElement*) SuperListItem::getById(
                     modelSpecials->invisibleRootItem(), id);
         textureAutotile = loadPictureAutotile(
-            painter, textureAutotile, newImage, special->picture(), offset, id);
+            composition, textureAutotile, special->picture(), offset, id);
     }
 
-    painter.end();
-    if (offset > 0) {
-        textureAutotile->setTexture(createTexture(newImage));
-        m_texturesAutotiles.append(textureAutotile);
-    }
+    if (offset > 0)
+        addTextureAutotile(textureAutotile, composition);
 }
 
 // -------------------------------------------------------
 
 TextureAutotile* Map::loadPictureAutotile(
-        QPainter& painter, TextureAutotile *textureAutotile,
-        QImage& newImage, SystemPicture* picture, int& offset, int id)
+        TextureComposition& composition, TextureAutotile *textureAutotile,
+        SystemPicture* picture, int& offset, int id)
 {
-    QImage image(1, 1, QImage::Format_ARGB32);
     QString path = picture->getPath(PictureKind::Autotiles);
+    QSize size = TextureComposition::pictureSize(path, PictureKind::Autotiles,
+                                                 m_squareSize);
 
-    if (path.isEmpty())
-        image.fill(QColor(0, 0, 0, 0));
-    else {
-        image.load(path);
-        if (!image.isNull()) {
-            textureAutotile = editPictureAutotile(painter, textureAutotile,
-                                                  newImage, image, offset, id);
-        }
+    if (!size.isEmpty()) {
+        textureAutotile = editPictureAutotile(composition, textureAutotile,
+                                              path, size, offset, id);
     }
 
     return textureAutotile;
@@ -196,6 +263,15 @@ TextureAutotile* Map::loadPictureAutotile(
 
 // -------------------------------------------------------
 
+void Map::addTextureAutotile(TextureAutotile* textureAutotile,
+                             const TextureComposition& composition)
+{
+    textureAutotile->setTexture(loadTexture(composition));
+    m_texturesAutotiles.append(textureAutotile);
+}
+
+// -------------------------------------------------------
+
 void Map::editPictureWall(QImage& image, QImage& refImage) {
     QImage newImage(image.width() + Wanok::get()->getSquareSize(),
                     image.height(), QImage::Format_ARGB32);
@@ -217,31 +293,28 @@ void Map::editPictureWall(QImage& image, QImage& refImage) {
 // -------------------------------------------------------
 
 TextureAutotile* Map::editPictureAutotile(
-        QPainter &painter, TextureAutotile* textureAutotile, QImage& newImage,
-        QImage& image, int &offset, int id)
+        TextureComposition& composition, TextureAutotile* textureAutotile,
+        const QString& path, const QSize& size, int &offset, int id)
 {
-    int width = (image.width() / 2) / m_squareSize;
-    int height = (image.height() / 3) / m_squareSize;
-    int size = width * height;
+    int width = (size.width() / 2) / m_squareSize;
+    int height = (size.height() / 3) / m_squareSize;
+    int count = width * height;
 
-    for (int i = 0; i < size; i++) {
+    for (int i = 0; i < count; i++) {
         QPoint point(i % width, i / width);
         if (offset == 0 && textureAutotile == nullptr) {
             textureAutotile = new TextureAutotile;
             textureAutotile->setBegin(id, point);
         }
-        paintPictureAutotile(painter, image, offset, point);
+        composition.addPicture(path, PictureKind::Autotiles, point, offset);
         textureAutotile->setEnd(id, point);
         textureAutotile->addToList(id, point);
         offset++;
 
         if (offset == 6) {
-            painter.end();
-            textureAutotile->setTexture(createTexture(newImage));
-            m_texturesAutotiles.append(textureAutotile);
-            newImage = QImage(64 * m_squareSize, Wanok::MAX_PIXEL_SIZE,
-                              QImage::Format_ARGB32);
-            painter.begin(&newImage);
+            addTextureAutotile(textureAutotile, composition);
+            composition = TextureComposition(QSize(64 * m_squareSize,
+                                                   Wanok::MAX_PIXEL_SIZE));
             textureAutotile = nullptr;
             offset = 0;
         }
@@ -252,41 +325,42 @@ TextureAutotile* Map::editPictureAutotile(
 
 // -------------------------------------------------------
 
-void Map::paintPictureAutotile(QPainter& painter, QImage& image, int& offset,
-                               QPoint& point)
+void Map::paintPictureAutotile(QPainter& painter, const QImage& image,
+                               int offset, const QPoint& point,
+                               int squareSize)
 {
     int count, lA, lB, lC, lD, row = -1;
-    int offsetX = point.x() * 2 * m_squareSize;
-    int offsetY = point.y() * 3 * m_squareSize;
-    float sDiv = m_squareSize / 2.0f;
+    int offsetX = point.x() * 2 * squareSize;
+    int offsetY = point.y() * 3 * squareSize;
+    float sDiv = squareSize / 2.0f;
     int y = offset * Autotiles::COUNT_LIST * 2;
 
     for (int a = 0; a < Autotiles::COUNT_LIST; a++) {
-        lA = Autotiles::autotileBorder[Autotiles::listA[a]];
+        lA = Autotiles::BORDERS_A[a];
         count = 0;
         row++;
         for (int b = 0; b < Autotiles::COUNT_LIST; b++) {
-            lB = Autotiles::autotileBorder[Autotiles::listB[b]];
+            lB = Autotiles::BORDERS_B[b];
             for (int c = 0; c < Autotiles::COUNT_LIST; c++) {
-                lC = Autotiles::autotileBorder[Autotiles::listC[c]];
+                lC = Autotiles::BORDERS_C[c];
                 for (int d = 0; d < Autotiles::COUNT_LIST; d++) {
-                    lD = Autotiles::autotileBorder[Autotiles::listD[d]];
+                    lD = Autotiles::BORDERS_D[d];
 
                     // Draw
-                    painter.drawImage(count * m_squareSize,
-                                      (row + y) * m_squareSize, image,
+                    painter.drawImage(count * squareSize,
+                                      (row + y) * squareSize, image,
                                       (lA % 4 * sDiv) + offsetX,
                                       (lA / 4 * sDiv) + offsetY, sDiv, sDiv);
-                    painter.drawImage(count * m_squareSize + sDiv,
-                                      (row + y) * m_squareSize, image,
+                    painter.drawImage(count * squareSize + sDiv,
+                                      (row + y) * squareSize, image,
                                       (lB % 4 * sDiv) + offsetX,
                                       (lB / 4 * sDiv) + offsetY, sDiv, sDiv);
-                    painter.drawImage(count * m_squareSize,
-                                      (row + y) * m_squareSize + sDiv, image,
+                    painter.drawImage(count * squareSize,
+                                      (row + y) * squareSize + sDiv, image,
                                       (lC % 4 * sDiv) + offsetX,
                                       (lC / 4 * sDiv) + offsetY, sDiv, sDiv);
-                    painter.drawImage(count * m_squareSize + sDiv,
-                                      (row + y) * m_squareSize + sDiv, image,
+                    painter.drawImage(count * squareSize + sDiv,
+                                      (row + y) * squareSize + sDiv, image,
                                       (lD % 4 * sDiv) + offsetX,
                                       (lD / 4 * sDiv) + offsetY, sDiv, sDiv);
 
@@ -333,10 +407,19 @@ void Map::editPictureAutotilePreview(QImage& image, QImage& refImage) {
 
 // -------------------------------------------------------
 
-void Map::addEmptyPicture(QHash<int, QOpenGLTexture*>& textures) {
-    QImage image(1, 1, QImage::Format_ARGB32);
-    image.fill(QColor(0, 0, 0, 0));
-    textures[-1] = new QOpenGLTexture(image);
+void Map::addEmptyPicture(TextureAtlas& textures) {
+    textures.addPicture(-1, QSize(1, 1));
+}
+
+// -------------------------------------------------------
+
+int Map::maxTextureSize() {
+    GLint size = 0;
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (context != nullptr)
+        context->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+
+    return size > 0 ? size : Wanok::MAX_PIXEL_SIZE;
 }
 
 // -------------------------------------------------------
@@ -22,14 +22,75 @@
 #include "common.h"
 #include "systemmapobject.h"
 #include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
 
 // -------------------------------------------------------
 
-void Map::save(){
-    QString pathTemp = Common::pathCombine(m_pathMap,
-                                          Wanok::TEMP_MAP_FOLDER_NAME);
-    Common::copyAllFiles(pathTemp, m_pathMap);
+bool Map::save(){
+    closePortionsFiles();
+    bool saved = copyTempFiles(m_pathMap);
+    openPortionsFiles();
+
+    return saved;
+}
+
+// -------------------------------------------------------
+
+void Map::openPortionsFiles() {
+    m_portionsContainer.open(Common::pathCombine(
+                                 m_pathMap, MapPortionsContainer::FILE_NAME));
+    m_journal.open(Common::pathCombine(
+                       Common::pathCombine(m_pathMap,
+                                           Wanok::TEMP_MAP_FOLDER_NAME),
+                       MapEditJournal::FILE_NAME));
+}
+
+// -------------------------------------------------------
+
+void Map::closePortionsFiles() {
+    waitPortionsLoading();
+
+    // The container and the journal are rewritten when saving, they can't
+    // stay opened
+    m_portionsContainer.close();
+    m_journal.close();
+}
+
+// -------------------------------------------------------
+
+bool Map::copyTempFiles(QString path) {
+    QString pathTemp = Common::pathCombine(path, Wanok::TEMP_MAP_FOLDER_NAME);
+    bool binary = Wanok::get()->engineSettings()->binaryPortions();
+
+    // Only the edited portions are written, the journal is kept as long as
+    // they are not all safely replaced
+    MapEditJournal journal;
+    journal.open(Common::pathCombine(pathTemp, MapEditJournal::FILE_NAME));
+    if (binary) {
+        if (!packPortions(path, &journal))
+            return false;
+    }
+    else {
+        unpackPortions(path, false);
+        QList<Portion> portions = journal.portions();
+        for (int i = 0; i < portions.size(); i++) {
+            Portion portion = portions.at(i);
+            MapPortion mapPortion(portion);
+            if (!journal.readPortion(mapPortion) ||
+                !writePortion(path, mapPortion, false))
+            {
+                return false;
+            }
+        }
+    }
+    journal.remove();
+
+    if (!Common::copyAllFiles(pathTemp, path))
+        return false;
     Common::deleteAllFiles(pathTemp);
+
+    return true;
 }
 
 // -------------------------------------------------------
@@ -79,23 +140,6 @@ QString Map::writeMap(QString path, MapProperties& properties,
     Wanok::writeJSON(Common::pathCombine(dirMap, Wanok::fileMapInfos),
                      properties);
 
-    // Portions
-    int lx = (properties.length() - 1) / Wanok::portionSize;
-    int ly = (properties.depth() + properties.height() - 1) /
-            Wanok::portionSize;;
-    int lz = (properties.width() - 1) / Wanok::portionSize;
-    for (int i = 0; i <= lx; i++){
-        for (int j = 0; j <= ly; j++){
-            for (int k = 0; k <= lz; k++){
-                QJsonObject obj;
-                Common::writeOtherJSON(
-                            Common::pathCombine(dirMap,
-                                               getPortionPathMap(i, j, k)),
-                            obj);
-            }
-        }
-    }
-
     // Objects
     QJsonObject json;
     json["objs"] = jsonObject;
@@ -115,31 +159,16 @@ void Map::correctMap(QString path, MapProperties& previousProperties,
 {
     int portionMaxX, portionMaxY, portionMaxZ;
     int newPortionMaxX, newPortionMaxY, newPortionMaxZ;
+
+    // Portions are edited one by one in their own files
+    bool binary = Wanok::get()->engineSettings()->binaryPortions();
+    unpackPortions(path, binary);
+
     previousProperties.getPortionsNumber(portionMaxX, portionMaxY, portionMaxZ);
     properties.getPortionsNumber(newPortionMaxX,
                                  newPortionMaxY,
                                  newPortionMaxZ);
 
-    // Write empty portions
-    for (int i = portionMaxX + 1; i <= newPortionMaxX; i++) {
-        for (int j = 0; j <= newPortionMaxY; j++) {
-            for (int k = 0; k <= newPortionMaxZ; k++)
-                Map::writeEmptyMap(path, i, j, k);
-        }
-    }
-    for (int j = portionMaxY + 1; j <= newPortionMaxY;j++) {
-        for (int i = 0; i <= newPortionMaxX; i++) {
-            for (int k = 0; k <= newPortionMaxZ; k++)
-                Map::writeEmptyMap(path, i, j, k);
-        }
-    }
-    for (int k = portionMaxZ + 1; k <= newPortionMaxZ; k++) {
-        for (int i = 0; i <= newPortionMaxX; i++) {
-            for (int j = 0; j <= newPortionMaxY; j++)
-                Map::writeEmptyMap(path, i, j, k);
-        }
-    }
-
     int difLength = previousProperties.length() - properties.length();
     int difWidth = previousProperties.width() - properties.width();
     int difHeight = previousProperties.height() - properties.height();
@@ -187,6 +216,9 @@ void Map::correctMap(QString path, MapProperties& previousProperties,
 
         SuperListItem::deleteModel(model);
     }
+
+    if (binary)
+        packPortions(path);
 }
 
 // -------------------------------------------------------
@@ -195,14 +227,16 @@ void Map::writeEmptyMap(QString path, int i, int j, int k) {
     QString pathPortion = Common::pathCombine(path, getPortionPathMap(i, j, k));
     QJsonObject obj;
     Common::writeOtherJSON(pathPortion, obj);
+    QFile(Common::pathCombine(path, getPortionPathMapBinary(i, j, k)))
+            .remove();
 }
 
 // -------------------------------------------------------
 
 void Map::deleteCompleteMap(QString path, int i, int j, int k) {
-    QString pathPortion = Common::pathCombine(path, getPortionPathMap(i, j, k));
-    QFile file(pathPortion);
-    file.remove();
+    QFile(Common::pathCombine(path, getPortionPathMap(i, j, k))).remove();
+    QFile(Common::pathCombine(path, getPortionPathMapBinary(i, j, k)))
+            .remove();
 }
 
 // -------------------------------------------------------
@@ -249,16 +283,221 @@ void Map::deleteMapElements(QList<int>& listDeletedObjectsIDs, QString path,
                             int i, int j, int k, MapProperties &properties)
 {
     Portion portion(i, j, k);
-    QString pathPortion = Common::pathCombine(path, getPortionPathMap(i, j, k));
     MapPortion mapPortion(portion);
-    Wanok::readJSON(pathPortion, mapPortion);
+    if (!readPortion(getPortionFile(path, i, j, k), mapPortion))
+        return;
 
     // Removing cut content
     mapPortion.removeLandOut(properties);
     mapPortion.removeSpritesOut(properties);
     mapPortion.removeObjectsOut(listDeletedObjectsIDs, properties);
 
-    Wanok::writeJSON(pathPortion, mapPortion);
+    writePortion(path, mapPortion,
+                 Wanok::get()->engineSettings()->binaryPortions());
+}
+
+// -------------------------------------------------------
+
+bool Map::readPortion(QString path, MapPortion& mapPortion) {
+
+    // Missing and empty files are empty portions
+    if (path.isEmpty() || QFileInfo(path).size() == 0)
+        return true;
+
+    // A truncated file or a file from a newer version is not an empty portion
+    if (QFileInfo(path).suffix() == "bin") {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+        QDataStream stream(&file);
+        return mapPortion.readBinary(stream);
+    }
+    else
+        Wanok::readJSON(path, mapPortion);
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+bool Map::writePortion(QString path, MapPortion& mapPortion, bool binary) {
+    Portion portion;
+    mapPortion.getGlobalPortion(portion);
+    QString pathJSON = Common::pathCombine(
+                path, getPortionPathMap(portion.x(), portion.y(),
+                                        portion.z()));
+    QString pathBinary = Common::pathCombine(
+                path, getPortionPathMapBinary(portion.x(), portion.y(),
+                                              portion.z()));
+
+    // Only one format per folder, the binary one being read first. A portion
+    // file is replaced at once so that it is never half written
+    if (mapPortion.isEmpty()) {
+        QFile(pathJSON).remove();
+        QFile(pathBinary).remove();
+    }
+    else if (binary) {
+        QSaveFile file(pathBinary);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        QDataStream stream(&file);
+        mapPortion.writeBinary(stream);
+        if (stream.status() != QDataStream::Ok || !file.commit())
+            return false;
+        QFile(pathJSON).remove();
+    }
+    else {
+        QJsonObject json;
+        mapPortion.write(json);
+        QSaveFile file(pathJSON);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+        if (!file.commit())
+            return false;
+        QFile(pathBinary).remove();
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+bool Map::getPortionFromFileName(QString fileName, Portion& portion) {
+    QStringList coords = QFileInfo(fileName).completeBaseName().split("_");
+    if (coords.size() != 3)
+        return false;
+
+    portion.setX(coords.at(0).toInt());
+    portion.setY(coords.at(1).toInt());
+    portion.setZ(coords.at(2).toInt());
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+bool Map::packPortions(QString path, MapEditJournal* journal) {
+    QString pathContainer = Common::pathCombine(
+                path, MapPortionsContainer::FILE_NAME);
+    QHash<Portion, QByteArray> portions;
+    QStringList files, filters;
+
+    // Previously packed portions
+    MapPortionsContainer container;
+    if (container.open(pathContainer)) {
+        QList<Portion> list = container.portions();
+        for (int i = 0; i < list.size(); i++) {
+            Portion portion = list.at(i);
+            portions.insert(portion, container.portionDatas(portion));
+        }
+        container.close();
+    }
+
+    // Portions files are more recent, empty ones are just not stored
+    filters << "*.json" << "*.bin";
+    files = QDir(path).entryList(filters, QDir::Files);
+    for (int i = files.size() - 1; i >= 0; i--) {
+        Portion portion;
+        if (getPortionFromFileName(files.at(i), portion)) {
+            MapPortion mapPortion(portion);
+            if (!readPortion(Common::pathCombine(path, files.at(i)),
+                             mapPortion))
+            {
+                return false;
+            }
+            if (mapPortion.isEmpty())
+                portions.remove(portion);
+            else {
+                QByteArray datas;
+                QDataStream stream(&datas, QIODevice::WriteOnly);
+                mapPortion.writeBinary(stream);
+                portions.insert(portion, datas);
+            }
+        }
+        else
+            files.removeAt(i);
+    }
+
+    // The journal edits are the most recent ones, already in binary
+    if (journal != nullptr) {
+        QList<Portion> list = journal->portions();
+        for (int i = 0; i < list.size(); i++) {
+            Portion portion = list.at(i);
+            if (journal->isPortionEmpty(portion))
+                portions.remove(portion);
+            else
+                portions.insert(portion, journal->portionDatas(portion));
+        }
+    }
+
+    // The files are only removed once everything is safely packed
+    if (!MapPortionsContainer::write(pathContainer, portions))
+        return false;
+    for (int i = 0; i < files.size(); i++)
+        QFile(Common::pathCombine(path, files.at(i))).remove();
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+void Map::unpackPortions(QString path, bool binary) {
+    QString pathContainer = Common::pathCombine(
+                path, MapPortionsContainer::FILE_NAME);
+    MapPortionsContainer container;
+    if (container.open(pathContainer)) {
+
+        // Portions files are more recent than the packed ones. The container
+        // is kept if one of its portions couldn't be read
+        bool unpacked = true;
+        QList<Portion> list = container.portions();
+        for (int i = 0; i < list.size(); i++) {
+            Portion portion = list.at(i);
+            if (getPortionFile(path, portion.x(), portion.y(), portion.z())
+                    .isEmpty())
+            {
+                MapPortion mapPortion(portion);
+                if (container.readPortion(mapPortion))
+                    writePortion(path, mapPortion, binary);
+                else
+                    unpacked = false;
+            }
+        }
+        container.close();
+        if (unpacked)
+            QFile(pathContainer).remove();
+    }
+
+    // Empty files were only hiding packed portions
+    QStringList filters;
+    filters << "*.json" << "*.bin";
+    QFileInfoList files = QDir(path).entryInfoList(filters, QDir::Files);
+    for (int i = 0; i < files.size(); i++) {
+        Portion portion;
+        if (files.at(i).size() == 0 &&
+            getPortionFromFileName(files.at(i).fileName(), portion))
+        {
+            QFile(files.at(i).filePath()).remove();
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+void Map::writeEmptyPortions(QString path) {
+    MapProperties properties(path);
+    int lx, ly, lz;
+    properties.getPortionsNumber(lx, ly, lz);
+
+    for (int i = 0; i <= lx; i++) {
+        for (int j = 0; j <= ly; j++) {
+            for (int k = 0; k <= lz; k++) {
+                if (getPortionFile(path, i, j, k).isEmpty())
+                    writeEmptyMap(path, i, j, k);
+            }
+        }
+    }
 }
 
 // -------------------------------------------------------
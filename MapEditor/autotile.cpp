@@ -52,7 +52,7 @@ AutotileDatas::AutotileDatas(int autotileID, QRect *texture, bool up) :
 }
 
 AutotileDatas::AutotileDatas(const AutotileDatas &autotile)  :
-    AutotileDatas(autotile.m_autotileID, new QRect(*autotile.m_textureRect),
+    AutotileDatas(autotile.m_autotileID, new QRect(autotile.m_textureRect),
                   autotile.m_up)
 {
     m_tileID = autotile.m_tileID;
@@ -62,6 +62,14 @@ int AutotileDatas::autotileID() const {
     return m_autotileID;
 }
 
+int AutotileDatas::tileID() const {
+    return m_tileID;
+}
+
+void AutotileDatas::setTileID(int tileID) {
+    m_tileID = tileID;
+}
+
 bool AutotileDatas::operator==(const AutotileDatas& other) const {
     return LandDatas::operator==(other) && m_autotileID == other.m_autotileID;
 }
@@ -89,13 +97,30 @@ void AutotileDatas::initializeVertices(TextureAutotile* textureAutotile,
                                        QVector<Vertex>& vertices,
                                        QVector<GLuint>& indexes,
                                        Position& position, int& count)
+{
+    initializeVertices(textureAutotile, m_autotileID, m_textureRect, m_tileID,
+                       m_up, squareSize, width, height, vertices, indexes,
+                       position, count);
+}
+
+// -------------------------------------------------------
+
+// Without any AutotileDatas, for the autotiles stored in arrays
+
+void AutotileDatas::initializeVertices(TextureAutotile* textureAutotile,
+                                       int autotileID, QRect& texture,
+                                       int tileID, bool up, int squareSize,
+                                       int width, int height,
+                                       QVector<Vertex>& vertices,
+                                       QVector<GLuint>& indexes,
+                                       Position& position, int& count)
 {
     QVector3D pos, size;
-    getPosSize(pos, size, squareSize, position);
+    getPosSize(pos, size, squareSize, position, up);
 
-    int xTile = m_tileID % 64;
-    int yTile = (m_tileID / 64) +
-            (10 * textureAutotile->getOffset(m_autotileID, m_textureRect));
+    int xTile = tileID % 64;
+    int yTile = (tileID / 64) +
+            (10 * textureAutotile->getOffset(autotileID, &texture));
 
     float x = ((float) xTile * squareSize) / width;
     float y = ((float) yTile * squareSize) / height;
@@ -128,122 +153,24 @@ void AutotileDatas::initializeVertices(TextureAutotile* textureAutotile,
 
 // -------------------------------------------------------
 
-bool AutotileDatas::update(Position &position, Portion &portion,
-                           QHash<Position, AutotileDatas *> &preview)
-{
-    int a, b, c, d, previousTileID;
-
-    // Top left
-    if (!Autotiles::tileOnLeft(
-                position, portion, m_autotileID, *m_textureRect, preview) &&
-        !Autotiles::tileOnTop(
-                position, portion, m_autotileID, *m_textureRect, preview))
-        a = 1;
-    else if (!Autotiles::tileOnTop(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        a = 3;
-    else if (!Autotiles::tileOnLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnTop(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        a = 4;
-    else if (Autotiles::tileOnLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnTop(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnTopLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        a = 2;
-    else
-        a = 0;
-
-    // Top right
-    if (!Autotiles::tileOnRight(
-                position, portion, m_autotileID, *m_textureRect, preview) &&
-        !Autotiles::tileOnTop(
-                position, portion, m_autotileID, *m_textureRect, preview))
-        b = 1;
-    else if (!Autotiles::tileOnTop(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnRight(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        b = 3;
-    else if (!Autotiles::tileOnRight(
-                 position, portion, m_autotileID, *m_textureRect, preview)&&
-             Autotiles::tileOnTop(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        b = 4;
-    else if (Autotiles::tileOnRight(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-            Autotiles::tileOnTop(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-            Autotiles::tileOnTopRight(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        b = 2;
-    else
-        b = 0;
-
-    // Bottom left
-    if (!Autotiles::tileOnLeft(
-                position, portion, m_autotileID, *m_textureRect, preview) &&
-            !Autotiles::tileOnBottom(
-                position, portion, m_autotileID, *m_textureRect, preview))
-        c = 1;
-    else if (!Autotiles::tileOnBottom(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        c = 3;
-    else if (!Autotiles::tileOnLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnBottom(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        c = 4;
-    else if (Autotiles::tileOnLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-          Autotiles::tileOnBottom(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-          Autotiles::tileOnBottomLeft(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        c = 2;
-    else
-        c = 0;
-
-    // Bottom right
-    if (!Autotiles::tileOnRight(
-                position, portion, m_autotileID, *m_textureRect, preview) &&
-        !Autotiles::tileOnBottom(
-                position, portion, m_autotileID, *m_textureRect, preview))
-        d = 1;
-    else if (!Autotiles::tileOnBottom(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnRight(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        d = 3;
-    else if (!Autotiles::tileOnRight(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-             Autotiles::tileOnBottom(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        d = 4;
-    else if (Autotiles::tileOnRight(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-         Autotiles::tileOnBottom(
-                 position, portion, m_autotileID, *m_textureRect, preview) &&
-         Autotiles::tileOnBottomRight(
-                 position, portion, m_autotileID, *m_textureRect, preview))
-        d = 2;
-    else
-        d = 0;
-
-    // Update tileId
-    previousTileID = m_tileID;
-    m_tileID = (a * 64 * 2) + (b * 25) + (c * 5) + d;
+bool AutotileDatas::updateTileID(int neighboursMask) {
+    int previousTileID = m_tileID;
+    m_tileID = Autotiles::tileID(neighboursMask);
 
     return previousTileID != m_tileID;
 }
 
+// -------------------------------------------------------
+
+bool AutotileDatas::update(Position &position, Portion &portion,
+                           const Autotiles &autotiles,
+                           QHash<Position, MapElement*>* preview)
+{
+    // One gather of the neighbours, then the tile ID is read in the table
+    return updateTileID(autotiles.neighboursMask(
+        position, portion, m_autotileID, m_textureRect, preview));
+}
+
 // -------------------------------------------------------
 //
 //  READ / WRITE
@@ -266,6 +193,25 @@ void AutotileDatas::write(QJsonObject &json) const{
     json[JSON_TILE_ID] = m_tileID;
 }
 
+// -------------------------------------------------------
+
+void AutotileDatas::readBinary(QDataStream& stream){
+    qint32 autotileID, tileID;
+
+    LandDatas::readBinary(stream);
+    stream >> autotileID >> tileID;
+    m_autotileID = autotileID;
+    m_tileID = tileID;
+}
+
+// -------------------------------------------------------
+
+void AutotileDatas::writeBinary(QDataStream& stream) const{
+    LandDatas::writeBinary(stream);
+    stream << static_cast<qint32>(m_autotileID)
+           << static_cast<qint32>(m_tileID);
+}
+
 // -------------------------------------------------------
 //
 //
@@ -282,8 +228,6 @@ void AutotileDatas::write(QJsonObject &json) const{
 
 Autotile::Autotile() :
     m_count(0),
-    m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
-    m_indexBuffer(QOpenGLBuffer::IndexBuffer),
     m_program(nullptr)
 {
 
@@ -300,12 +244,44 @@ Autotile::~Autotile()
 //
 // -------------------------------------------------------
 
+bool Autotile::isEmpty() const {
+    return m_indexes.isEmpty();
+}
+
+// -------------------------------------------------------
+
+void Autotile::clearVertices() {
+    m_vertices.clear();
+    m_indexes.clear();
+    m_ranges.clear();
+    m_count = 0;
+}
+
+// -------------------------------------------------------
+
 void Autotile::initializeVertices(TextureAutotile* textureAutotile,
                                   Position &position, AutotileDatas* autotile,
                                   int squareSize, int width, int height)
 {
+    int begin = m_indexes.size();
     autotile->initializeVertices(textureAutotile, squareSize, width, height,
                                  m_vertices, m_indexes, position, m_count);
+    m_ranges.add(position, begin, m_indexes.size());
+}
+
+// -------------------------------------------------------
+
+void Autotile::initializeVertices(TextureAutotile* textureAutotile,
+                                  Position &position, int autotileID,
+                                  QRect& texture, int tileID, bool up,
+                                  int squareSize, int width, int height)
+{
+    int begin = m_indexes.size();
+    AutotileDatas::initializeVertices(textureAutotile, autotileID, texture,
+                                      tileID, up, squareSize, width, height,
+                                      m_vertices, m_indexes, position,
+                                      m_count);
+    m_ranges.add(position, begin, m_indexes.size());
 }
 
 // -------------------------------------------------------
@@ -322,14 +298,24 @@ void Autotile::initializeGL(QOpenGLShaderProgram* program) {
 // -------------------------------------------------------
 
 void Autotile::updateGL(){
-    Map::updateGLStatic(m_vertexBuffer, m_indexBuffer, m_vertices, m_indexes,
+    Map::updateGLStatic(m_vertexRange, m_indexRange, m_vertices, m_indexes,
                         m_vao, m_program);
 }
 
 // -------------------------------------------------------
 
-void Autotile::paintGL(){
+void Autotile::paintGL(const QSet<Position>& hidden){
     m_vao.bind();
-    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT, 0);
+    if (hidden.isEmpty()) {
+        glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT,
+                       m_indexRange.indexesOffset());
+    }
+    else {
+        QList<QPair<int, int>> hiddenRanges;
+        m_ranges.getRanges(hidden, hiddenRanges);
+        GLElementsRanges::paint(this, m_indexRange.indexesOffset(),
+                                m_indexes.size(), hiddenRanges);
+    }
     m_vao.release();
 }
+
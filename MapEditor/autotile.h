@@ -22,7 +22,8 @@
 
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
-#include <QOpenGLBuffer>
+#include "glbufferarena.h"
+#include "glelementsranges.h"
 #include <QOpenGLVertexArrayObject>
 #include "land.h"
 #include "textureautotile.h"
@@ -44,6 +45,8 @@ public:
     AutotileDatas(int autotileID, QRect *texture, bool up = true);
     AutotileDatas(const AutotileDatas &autotile);
     int autotileID() const;
+    int tileID() const;
+    void setTileID(int tileID);
     static const QString JSON_ID;
     static const QString JSON_TILE_ID;
 
@@ -58,11 +61,21 @@ public:
                                     QVector<Vertex>& vertices,
                                     QVector<GLuint>& indexes,
                                     Position& position, int& count);
+    static void initializeVertices(TextureAutotile* textureAutotile,
+                                   int autotileID, QRect& texture, int tileID,
+                                   bool up, int squareSize, int width,
+                                   int height, QVector<Vertex>& vertices,
+                                   QVector<GLuint>& indexes,
+                                   Position& position, int& count);
+    bool updateTileID(int neighboursMask);
     bool update(Position &position, Portion& portion,
-                QHash<Position, AutotileDatas*> &preview);
+                const Autotiles& autotiles,
+                QHash<Position, MapElement*>* preview = nullptr);
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject & json) const;
+    virtual void readBinary(QDataStream& stream);
+    virtual void writeBinary(QDataStream& stream) const;
 
 protected:
     int m_autotileID;
@@ -82,19 +95,26 @@ class Autotile : protected QOpenGLFunctions
 public:
     Autotile();
     virtual ~Autotile();
+    bool isEmpty() const;
+    void clearVertices();
     void initializeVertices(TextureAutotile* textureAutotile,
                             Position& position, AutotileDatas* autotile,
                             int squareSize, int width, int height);
+    void initializeVertices(TextureAutotile* textureAutotile,
+                            Position& position, int autotileID,
+                            QRect& texture, int tileID, bool up,
+                            int squareSize, int width, int height);
     void initializeGL(QOpenGLShaderProgram* program);
     void updateGL();
-    void paintGL();
+    void paintGL(const QSet<Position>& hidden);
 
 protected:
     int m_count;
+    GLElementsRanges m_ranges;
 
     // OpenGL
-    QOpenGLBuffer m_vertexBuffer;
-    QOpenGLBuffer m_indexBuffer;
+    GLBufferRange m_vertexRange;
+    GLBufferRange m_indexRange;
     QVector<Vertex> m_vertices;
     QVector<GLuint> m_indexes;
     QOpenGLVertexArrayObject m_vao;
@@ -20,39 +20,66 @@
 #include "autotiles.h"
 #include "wanok.h"
 
-QHash<QString, int> Autotiles::initializeAutotileBorder() {
-    QHash<QString, int> hash;
-
-    hash.insert("A1", 2);
-    hash.insert("B1", 3);
-    hash.insert("C1", 6);
-    hash.insert("D1", 7);
-    hash.insert("A2", 8);
-    hash.insert("B4", 9);
-    hash.insert("A4", 10);
-    hash.insert("B2", 11);
-    hash.insert("C5", 12);
-    hash.insert("D3", 13);
-    hash.insert("C3", 14);
-    hash.insert("D5", 15);
-    hash.insert("A5", 16);
-    hash.insert("B3", 17);
-    hash.insert("A3", 18);
-    hash.insert("B5", 19);
-    hash.insert("C2", 20);
-    hash.insert("D4", 21);
-    hash.insert("C4", 22);
-    hash.insert("D2", 23);
-
-    return hash;
-}
-
-QHash<QString, int> Autotiles::autotileBorder = initializeAutotileBorder();
+// Borders of the autotiles pictures drawn in each corner (A1 to D5)
 const int Autotiles::COUNT_LIST = 5;
-QString Autotiles::listA[COUNT_LIST] {"A1", "A2", "A3", "A4", "A5"};
-QString Autotiles::listB[COUNT_LIST] {"B1", "B2", "B3", "B4", "B5"};
-QString Autotiles::listC[COUNT_LIST] {"C1", "C2", "C3", "C4", "C5"};
-QString Autotiles::listD[COUNT_LIST] {"D1", "D2", "D3", "D4", "D5"};
+const int Autotiles::BORDERS_A[COUNT_LIST] {2, 8, 18, 10, 16};
+const int Autotiles::BORDERS_B[COUNT_LIST] {3, 11, 17, 9, 19};
+const int Autotiles::BORDERS_C[COUNT_LIST] {6, 20, 14, 22, 12};
+const int Autotiles::BORDERS_D[COUNT_LIST] {7, 23, 13, 21, 15};
+
+// Offsets of the neighbours, the bit i of a mask being the neighbour i
+const int Autotiles::COUNT_NEIGHBOURS = 8;
+const int Autotiles::NEIGHBOURS_X[COUNT_NEIGHBOURS] {-1, 1, 0, 0, -1, 1, -1, 1};
+const int Autotiles::NEIGHBOURS_Z[COUNT_NEIGHBOURS] {0, 0, -1, 1, -1, -1, 1, 1};
+
+// Bits of the neighbours in a mask
+static constexpr int MASK_LEFT = 1 << 0;
+static constexpr int MASK_RIGHT = 1 << 1;
+static constexpr int MASK_TOP = 1 << 2;
+static constexpr int MASK_BOTTOM = 1 << 3;
+static constexpr int MASK_TOP_LEFT = 1 << 4;
+static constexpr int MASK_TOP_RIGHT = 1 << 5;
+static constexpr int MASK_BOTTOM_LEFT = 1 << 6;
+static constexpr int MASK_BOTTOM_RIGHT = 1 << 7;
+
+// Corner index (0 to 4) according to its side, vertical and diagonal tiles
+static constexpr int cornerIndex(bool side, bool vertical, bool diagonal) {
+    return (!side && !vertical) ? 1 : (!vertical ? 3 : (!side ? 4 :
+           (diagonal ? 2 : 0)));
+}
+
+static constexpr int tileIDOfMask(int mask) {
+    return (cornerIndex(mask & MASK_LEFT, mask & MASK_TOP,
+                        mask & MASK_TOP_LEFT) * 64 * 2) +
+           (cornerIndex(mask & MASK_RIGHT, mask & MASK_TOP,
+                        mask & MASK_TOP_RIGHT) * 25) +
+           (cornerIndex(mask & MASK_LEFT, mask & MASK_BOTTOM,
+                        mask & MASK_BOTTOM_LEFT) * 5) +
+           cornerIndex(mask & MASK_RIGHT, mask & MASK_BOTTOM,
+                       mask & MASK_BOTTOM_RIGHT);
+}
+
+#define TILE_IDS_4(m) tileIDOfMask(m), tileIDOfMask(m + 1), \
+    tileIDOfMask(m + 2), tileIDOfMask(m + 3)
+#define TILE_IDS_16(m) TILE_IDS_4(m), TILE_IDS_4(m + 4), TILE_IDS_4(m + 8), \
+    TILE_IDS_4(m + 12)
+#define TILE_IDS_64(m) TILE_IDS_16(m), TILE_IDS_16(m + 16), \
+    TILE_IDS_16(m + 32), TILE_IDS_16(m + 48)
+
+// Tile ID for each mask of the neighbours, computed at compile time
+static constexpr int TILE_IDS[256] {
+    TILE_IDS_64(0), TILE_IDS_64(64), TILE_IDS_64(128), TILE_IDS_64(192)
+};
+
+#undef TILE_IDS_64
+#undef TILE_IDS_16
+#undef TILE_IDS_4
+
+// Alone, surrounded, and with only the left and top neighbours
+static_assert(TILE_IDS[0] == 159, "Wrong tile ID without neighbours");
+static_assert(TILE_IDS[255] == 318, "Wrong tile ID with all the neighbours");
+static_assert(TILE_IDS[MASK_LEFT | MASK_TOP] == 116,
+              "Wrong tile ID with the left and top neighbours");
 
 // -------------------------------------------------------
 //
@@ -67,10 +94,6 @@ Autotiles::Autotiles()
 
 Autotiles::~Autotiles()
 {
-    QHash<Position, AutotileDatas*>::iterator i;
-    for (i = m_all.begin(); i != m_all.end(); i++)
-        delete i.value();
-
     clearAutotilesGL();
 }
 
@@ -81,7 +104,13 @@ Autotiles::~Autotiles()
 // -------------------------------------------------------
 
 bool Autotiles::isEmpty() const {
-    return true;
+    return m_grid.isEmpty();
+}
+
+// -------------------------------------------------------
+
+int Autotiles::count() const {
+    return m_grid.count();
 }
 
 // -------------------------------------------------------
@@ -94,45 +123,83 @@ void Autotiles::clearAutotilesGL() {
 
 // -------------------------------------------------------
 
+bool Autotiles::contains(Position& p) const {
+    return m_grid.indexOf(p) != -1;
+}
+
+// -------------------------------------------------------
+
+bool Autotiles::getTexture(Position& p, int& autotileID,
+                           QRect& texture) const
+{
+    int index = m_grid.indexOf(p);
+    if (index == -1)
+        return false;
+
+    autotileID = m_autotilesIDs.at(index);
+    texture = m_textures.at(m_texturesIndexes.at(index));
+
+    return true;
+}
+
+// -------------------------------------------------------
+
 AutotileDatas* Autotiles::getAutotile(Position& p) const {
-    return m_all.value(p);
+    int index = m_grid.indexOf(p);
+
+    return (index == -1) ? nullptr : createView(index);
 }
 
 // -------------------------------------------------------
 
-void Autotiles::setAutotile(Position& p, AutotileDatas* autotile) {
-    m_all.insert(p, autotile);
+void Autotiles::setAutotile(Position& p, AutotileDatas& autotile) {
+    setAutotileAt(p, autotile.autotileID(), *autotile.textureRect(),
+                  autotile.tileID(), autotile.up(), autotile.xOffset(),
+                  autotile.yOffset(), autotile.zOffset());
 }
 
 // -------------------------------------------------------
 
 AutotileDatas* Autotiles::removeAutotile(Position& p) {
-    AutotileDatas* autotile = m_all.value(p);
+    int index = m_grid.indexOf(p);
+    if (index == -1)
+        return nullptr;
 
-    if (autotile != nullptr)
-        m_all.remove(p);
+    AutotileDatas* autotile = createView(index);
+    removeAt(index);
 
     return autotile;
 }
 
 // -------------------------------------------------------
 
+bool Autotiles::updateTileID(Position& p, int neighboursMask) {
+    int index = m_grid.indexOf(p);
+    if (index == -1)
+        return false;
+
+    int tileID = Autotiles::tileID(neighboursMask);
+    if (m_tilesIDs.at(index) == tileID)
+        return false;
+    m_tilesIDs[index] = tileID;
+
+    return true;
+}
+
+// -------------------------------------------------------
+
 void Autotiles::removeAutotileOut(MapProperties& properties) {
-    QList<Position> list;
-    QHash<Position, AutotileDatas*>::iterator i;
-    for (i = m_all.begin(); i != m_all.end(); i++) {
-        Position position = i.key();
+
+    // Backward because the last autotile is moved in the removed one
+    for (int i = m_grid.count() - 1; i >= 0; i--) {
+        Position position = m_grid.positionAt(i);
 
         if (position.x() >= properties.length() ||
             position.z() >= properties.width())
         {
-            delete *i;
-            list.push_back(position);
+            removeAt(i);
         }
     }
-
-    for (int j = 0; j < list.size(); j++)
-        m_all.remove(list.at(j));
 }
 
 // -------------------------------------------------------
@@ -140,21 +207,26 @@ void Autotiles::removeAutotileOut(MapProperties& properties) {
 MapElement *Autotiles::updateRaycasting(int squareSize, float& finalDistance,
                                         Position &finalPosition, QRay3D &ray)
 {
-    MapElement* element = nullptr;
-
-    for (QHash<Position, AutotileDatas*>::iterator i = m_all.begin();
-         i != m_all.end(); i++)
-    {
-        Position position = i.key();
-        AutotileDatas* autotile = i.value();
-        if (updateRaycastingAt(position, autotile, squareSize, finalDistance,
-                               finalPosition, ray))
-        {
-            element = autotile;
+    int index = -1;
+
+    // Only the squares under the ray on each level
+    QList<Position> positions;
+    m_grid.getPositions(ray, squareSize, positions);
+    for (int i = 0; i < positions.size(); i++) {
+        Position position = positions.at(i);
+        int j = m_grid.indexOf(position);
+        if (j == -1)
+            continue;
+
+        float newDistance = LandDatas::intersection(squareSize, ray, position,
+                                                    m_ups.at(j));
+        if (Wanok::getMinDistance(finalDistance, newDistance)) {
+            finalPosition = position;
+            index = j;
         }
     }
 
-    return element;
+    return (index == -1) ? nullptr : createView(index);
 }
 
 // -------------------------------------------------------
@@ -174,34 +246,29 @@ bool Autotiles::updateRaycastingAt(Position &position, AutotileDatas *autotile,
 
 // -------------------------------------------------------
 
-void Autotiles::getAutotilesWithPreview(
-        QHash<Position, AutotileDatas*> &autotilesWithPreview,
-        QHash<Position, MapElement*> &preview)
-{
-    autotilesWithPreview = m_all;
-    QHash<Position, MapElement*>::iterator itw;
-    for (itw = preview.begin(); itw != preview.end(); itw++) {
-        MapElement* element = itw.value();
-        if (element->getSubKind() == MapEditorSubSelectionKind::Floors)
-            autotilesWithPreview.remove(itw.key());
-        else if (element->getSubKind() == MapEditorSubSelectionKind::Autotiles)
-            autotilesWithPreview[itw.key()] = (AutotileDatas*) element;
-    }
-}
-
-// -------------------------------------------------------
+// A copy of the autotile at this position (owned by the caller), the
+// preview of the portion hiding what is under it
 
-AutotileDatas* Autotiles::tileExisting(Position& position, Portion& portion,
-                                       QHash<Position, AutotileDatas*> &preview)
+AutotileDatas* Autotiles::tileExisting(
+        Map* map, Position& position, Portion& portion,
+        QHash<Position, MapElement*>* preview) const
 {
     Portion newPortion;
-    Wanok::get()->project()->currentMap()->getLocalPortion(position,
-                                                           newPortion);
-    if (portion == newPortion)
-        return (AutotileDatas*) preview.value(position);
+    map->getLocalPortion(position, newPortion);
+    if (portion == newPortion) {
+        MapElement* element = (preview == nullptr) ? nullptr
+                                                   : preview->value(position);
+        if (element != nullptr) {
+            if (element->getSubKind() == MapEditorSubSelectionKind::Floors)
+                return nullptr;
+            if (element->getSubKind() == MapEditorSubSelectionKind::Autotiles)
+                return new AutotileDatas(*((AutotileDatas*) element));
+        }
+
+        return getAutotile(position);
+    }
     else { // If out of current portion
-        MapPortion* mapPortion = Wanok::get()->project()->currentMap()
-                ->mapPortion(newPortion);
+        MapPortion* mapPortion = map->mapPortion(newPortion);
 
         return (mapPortion == nullptr) ? nullptr : (AutotileDatas*) mapPortion
             ->getMapElementAt(position, MapEditorSelectionKind::Land,
@@ -211,175 +278,232 @@ AutotileDatas* Autotiles::tileExisting(Position& position, Portion& portion,
 
 // -------------------------------------------------------
 
-AutotileDatas* Autotiles::tileOnWhatever(
-        Position& position, Portion &portion, int id, QRect& rect,
-        QHash<Position, AutotileDatas*> &preview)
+bool Autotiles::tileOnWhatever(Map* map, Position& position, Portion &portion,
+                               int id, const QRect& rect,
+                               const Autotiles& autotiles,
+                               QHash<Position, MapElement*>* preview)
 {
-    AutotileDatas* autotile = tileExisting(position, portion, preview);
+    Portion newPortion;
+    int autotileID;
+    QRect texture;
+
+    map->getLocalPortion(position, newPortion);
+    if (portion == newPortion) {
+
+        // The preview hides what is under it: a floor removes the autotile
+        MapElement* element = (preview == nullptr) ? nullptr
+                                                   : preview->value(position);
+        if (element != nullptr) {
+            if (element->getSubKind() == MapEditorSubSelectionKind::Floors)
+                return false;
+            if (element->getSubKind() == MapEditorSubSelectionKind::Autotiles)
+            {
+                AutotileDatas* autotile = (AutotileDatas*) element;
+                return autotile->autotileID() == id &&
+                       (*autotile->textureRect()) == rect;
+            }
+        }
+
+        if (!autotiles.getTexture(position, autotileID, texture))
+            return false;
+    }
+    else { // If out of current portion
+        MapPortion* mapPortion = map->mapPortion(newPortion);
+        if (mapPortion == nullptr ||
+            !mapPortion->getAutotileTexture(position, autotileID, texture))
+        {
+            return false;
+        }
+    }
 
-    return (autotile != nullptr && autotile->autotileID() == id &&
-            (*autotile->textureRect()) == rect) ? autotile : nullptr;
+    return autotileID == id && texture == rect;
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnLeft(Position& position, Portion& portion, int id,
-                           QRect& rect,
-                           QHash<Position, AutotileDatas*> &preview)
+int Autotiles::neighboursMask(Position& position, Portion& portion, int id,
+                              const QRect& rect,
+                              QHash<Position, MapElement*>* preview) const
 {
-    Position newPosition(position.x() - 1, position.y(), position.yPlus(),
-                         position.z(), position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+    Map* map = Wanok::get()->project()->currentMap();
+    int mask = 0;
+
+    for (int i = 0; i < COUNT_NEIGHBOURS; i++) {
+        Position newPosition(position.x() + NEIGHBOURS_X[i], position.y(),
+                             position.yPlus(), position.z() + NEIGHBOURS_Z[i],
+                             position.layer());
+        if (tileOnWhatever(map, newPosition, portion, id, rect, *this,
+                           preview))
+        {
+            mask |= 1 << i;
+        }
+    }
+
+    return mask;
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnRight(Position& position, Portion& portion, int id,
-                            QRect& rect,
-                            QHash<Position, AutotileDatas*> &preview)
-{
-    Position newPosition(position.x() + 1, position.y(), position.yPlus(),
-                         position.z(), position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+int Autotiles::tileID(int mask) {
+    return TILE_IDS[mask];
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnTop(Position& position, Portion& portion, int id,
-                          QRect& rect,
-                          QHash<Position, AutotileDatas*> &preview)
+void Autotiles::updateAround(Position& position,
+                             QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                             QHash<Position, MapElement*>* preview,
+                             QSet<MapPortion *> *previousPreview)
 {
-    Position newPosition(position.x(), position.y(), position.yPlus(),
-                         position.z() - 1, position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
-}
+    Map* map = Wanok::get()->project()->currentMap();
+    Portion portion;
+    map->getLocalPortion(position, portion);
+    for (int i = -1; i <= 1; i++) {
+        for (int j = -1; j <= 1; j++) {
+            Position newPosition(position.x() + i, position.y(),
+                                 position.yPlus(), position.z() + j,
+                                 position.layer());
+            Portion newPortion;
+            map->getLocalPortion(newPosition, newPortion);
 
-// -------------------------------------------------------
+            // Without preview, the autotile is updated in its portion
+            if (previousPreview == nullptr) {
+                if (portion == newPortion)
+                    updateAutotile(newPosition, portion);
+                else {
+                    MapPortion* mapPortion = map->mapPortion(newPortion);
+                    if (mapPortion != nullptr &&
+                        mapPortion->updateAutotile(newPosition, newPortion))
+                    {
+                        update += mapPortion;
+                        save += mapPortion;
+                    }
+                }
+                continue;
+            }
 
-bool Autotiles::tileOnBottom(Position& position, Portion& portion, int id,
-                             QRect& rect,
-                             QHash<Position, AutotileDatas*> &preview)
-{
-    Position newPosition(position.x(), position.y(), position.yPlus(),
-                         position.z() + 1, position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+            // Else, a changed copy of the autotile goes in the preview
+            AutotileDatas* previewAutotile = tileExisting(map, newPosition,
+                                                          portion, preview);
+            if (previewAutotile == nullptr)
+                continue;
+            if (!previewAutotile->update(newPosition, portion, *this,
+                                         preview))
+            {
+                delete previewAutotile;
+                continue;
+            }
+
+            // Update view in different portion, a preview only changes the
+            // overlay
+            MapPortion* mapPortion = map->mapPortion(newPortion);
+            if (portion != newPortion)
+                *previousPreview += mapPortion;
+            mapPortion->addPreview(newPosition, previewAutotile);
+        }
+    }
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnTopLeft(Position& position, Portion& portion, int id,
-                              QRect& rect,
-                              QHash<Position, AutotileDatas*> &preview)
+void Autotiles::updateWithoutPreview(Position& position,
+                                     QSet<MapPortion *> &update,
+                                     QSet<MapPortion *> &save)
 {
-    Position newPosition(position.x() - 1, position.y(), position.yPlus(),
-                         position.z() - 1, position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+    updateAround(position, update, save, nullptr, nullptr);
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnTopRight(Position& position, Portion& portion, int id,
-                               QRect& rect,
-                               QHash<Position, AutotileDatas*> &preview)
-{
-    Position newPosition(position.x() + 1, position.y(), position.yPlus(),
-                         position.z() - 1, position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+bool Autotiles::updateAutotile(Position& position, Portion& portion) {
+    int index = m_grid.indexOf(position);
+    if (index == -1)
+        return false;
+
+    return updateTileID(position, neighboursMask(
+        position, portion, m_autotilesIDs.at(index),
+        m_textures.at(m_texturesIndexes.at(index)), nullptr));
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnBottomLeft(Position& position, Portion& portion, int id,
-                                 QRect& rect,
-                                 QHash<Position, AutotileDatas*> &preview)
-{
-    Position newPosition(position.x() - 1, position.y(), position.yPlus(),
-                         position.z() + 1, position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+int Autotiles::textureIndex(const QRect& texture) {
+    int index = m_textures.indexOf(texture);
+    if (index == -1) {
+        index = m_textures.size();
+        m_textures.append(texture);
+    }
+
+    return index;
 }
 
 // -------------------------------------------------------
 
-bool Autotiles::tileOnBottomRight(Position& position, Portion& portion, int id,
-                                  QRect& rect,
-                                  QHash<Position, AutotileDatas*> &preview)
+void Autotiles::setAutotileAt(const Position& p, int autotileID,
+                              const QRect& texture, int tileID, bool up,
+                              int xOffset, int yOffset, int zOffset)
 {
-    Position newPosition(position.x() + 1, position.y(), position.yPlus(),
-                         position.z() + 1, position.layer());
-    return tileOnWhatever(newPosition, portion, id, rect, preview) != nullptr;
+    int index = m_grid.indexOf(p);
+    if (index == -1) {
+        m_grid.add(p);
+        m_autotilesIDs.append(autotileID);
+        m_texturesIndexes.append(textureIndex(texture));
+        m_tilesIDs.append(tileID);
+        m_ups.append(up);
+        m_xOffsets.append(xOffset);
+        m_yOffsets.append(yOffset);
+        m_zOffsets.append(zOffset);
+    }
+    else {
+        m_autotilesIDs[index] = autotileID;
+        m_texturesIndexes[index] = textureIndex(texture);
+        m_tilesIDs[index] = tileID;
+        m_ups[index] = up;
+        m_xOffsets[index] = xOffset;
+        m_yOffsets[index] = yOffset;
+        m_zOffsets[index] = zOffset;
+    }
 }
 
 // -------------------------------------------------------
 
-void Autotiles::updateAround(Position& position,
-                             QHash<Position, AutotileDatas *> &autotiles,
-                             QSet<MapPortion*>& update, QSet<MapPortion*>& save,
-                             QSet<MapPortion *> *previousPreview)
-{
-    Portion portion;
-    Wanok::get()->project()->currentMap()->getLocalPortion(position, portion);
-    for (int i = -1; i <= 1; i++) {
-        for (int j = -1; j <= 1; j++) {
-            Position newPosition(position.x() + i, position.y(),
-                                 position.yPlus(), position.z() + j,
-                                 position.layer());
-            AutotileDatas* newAutotile = tileExisting(newPosition, portion,
-                                                      autotiles);
-            if (newAutotile != nullptr) {
-
-                // Update the current autotile
-                AutotileDatas* previewAutotile = nullptr;
-                bool changed;
-                if (previousPreview == nullptr)
-                    changed = newAutotile->update(newPosition, portion,
-                                                  autotiles);
-                else {
-                    bool center = (i == 0 && j == 0);
-                    if (center)
-                        previewAutotile = newAutotile;
-                    else
-                        previewAutotile = new AutotileDatas(*newAutotile);
-                    changed = previewAutotile->update(newPosition, portion,
-                                                      autotiles);
-                    if (!changed && !center)
-                        delete previewAutotile;
-                }
-
-                if (changed) {
-                    Portion newPortion;
-                    Wanok::get()->project()->currentMap()->getLocalPortion(
-                                newPosition, newPortion);
-
-                    // Update view in different portion
-                    if (portion != newPortion) {
-                        MapPortion* mapPortion = Wanok::get()->project()
-                                ->currentMap()->mapPortion(newPortion);
-                        update += mapPortion;
-                        if (previousPreview == nullptr)
-                            save += mapPortion;
-                        else
-                            *previousPreview += mapPortion;
-                    }
+void Autotiles::removeAt(int index) {
+    int last = m_grid.count() - 1;
+    m_grid.removeAt(index);
 
-                    // If preview, add the autotile to it
-                    if (previousPreview != nullptr) {
-                        Wanok::get()->project()->currentMap()
-                                ->mapPortion(newPortion)
-                                ->addPreview(newPosition, previewAutotile);
-                    }
-                }
-            }
-        }
+    // Move the last autotile in the removed one, as the grid did
+    if (index != last) {
+        m_autotilesIDs[index] = m_autotilesIDs.at(last);
+        m_texturesIndexes[index] = m_texturesIndexes.at(last);
+        m_tilesIDs[index] = m_tilesIDs.at(last);
+        m_ups[index] = m_ups.at(last);
+        m_xOffsets[index] = m_xOffsets.at(last);
+        m_yOffsets[index] = m_yOffsets.at(last);
+        m_zOffsets[index] = m_zOffsets.at(last);
     }
+
+    m_autotilesIDs.removeLast();
+    m_texturesIndexes.removeLast();
+    m_tilesIDs.removeLast();
+    m_ups.removeLast();
+    m_xOffsets.removeLast();
+    m_yOffsets.removeLast();
+    m_zOffsets.removeLast();
 }
 
 // -------------------------------------------------------
 
-void Autotiles::updateWithoutPreview(Position& position,
-                                     QSet<MapPortion *> &update,
-                                     QSet<MapPortion *> &save)
-{
-    updateAround(position, m_all, update, save, nullptr);
+AutotileDatas* Autotiles::createView(int index) const {
+    AutotileDatas* autotile = new AutotileDatas(
+                m_autotilesIDs.at(index),
+                new QRect(m_textures.at(m_texturesIndexes.at(index))),
+                m_ups.at(index));
+    autotile->setTileID(m_tilesIDs.at(index));
+    autotile->setXOffset(m_xOffsets.at(index));
+    autotile->setYOffset(m_yOffsets.at(index));
+    autotile->setZOffset(m_zOffsets.at(index));
+
+    return autotile;
 }
 
 // -------------------------------------------------------
@@ -389,38 +513,38 @@ void Autotiles::updateWithoutPreview(Position& position,
 // -------------------------------------------------------
 
 void Autotiles::initializeVertices(QList<TextureAutotile*> &texturesAutotiles,
-                                   QHash<Position, MapElement*>& previewSquares,
                                    int squareSize)
 {
-    clearAutotilesGL();
-    for (int j = 0; j < texturesAutotiles.size(); j++)
-        m_autotilesGL.append(new Autotile);
-
-    // Create temp hash for preview
-    QHash<Position, AutotileDatas*> autotilesWithPreview;
-    getAutotilesWithPreview(autotilesWithPreview, previewSquares);
-
-    // Initialize vertices for walls
-    QHash<Position, AutotileDatas*>::iterator i;
-    for (i = autotilesWithPreview.begin(); i != autotilesWithPreview.end(); i++)
-    {
-        Position position = i.key();
-        AutotileDatas* autotile = i.value();
+    // Keep the GL buffers of the previous vertices if possible
+    if (m_autotilesGL.size() == texturesAutotiles.size()) {
+        for (int j = 0; j < m_autotilesGL.size(); j++)
+            m_autotilesGL.at(j)->clearVertices();
+    }
+    else {
+        clearAutotilesGL();
+        for (int j = 0; j < texturesAutotiles.size(); j++)
+            m_autotilesGL.append(new Autotile);
+    }
+
+    // Initialize vertices for autotiles (the previews are in the overlay)
+    for (int i = 0; i < m_grid.count(); i++) {
+        Position position = m_grid.positionAt(i);
+        int autotileID = m_autotilesIDs.at(i);
+        QRect textureRect = m_textures.at(m_texturesIndexes.at(i));
         TextureAutotile* texture = nullptr;
         int index = 0;
         for (; index < texturesAutotiles.size(); index++) {
             TextureAutotile* textureAutotile = texturesAutotiles[index];
-            if (textureAutotile->isInTexture(autotile->autotileID(),
-                                             autotile->textureRect()))
-            {
+            if (textureAutotile->isInTexture(autotileID, &textureRect)) {
                 texture = textureAutotile;
                 break;
             }
         }
         if (texture != nullptr && texture->texture() != nullptr) {
             Autotile* autotileGL = m_autotilesGL.at(index);
-            autotileGL->initializeVertices(texture, position, autotile,
-                                           squareSize,
+            autotileGL->initializeVertices(texture, position, autotileID,
+                                           textureRect, m_tilesIDs.at(i),
+                                           m_ups.at(i), squareSize,
                                            texture->texture()->width(),
                                            texture->texture()->height());
         }
@@ -443,8 +567,19 @@ void Autotiles::updateGL(){
 
 // -------------------------------------------------------
 
-void Autotiles::paintGL(int textureID){
-    m_autotilesGL.at(textureID)->paintGL();
+void Autotiles::addToRenderList(MapRenderList& renderList,
+                                MapPortion* mapPortion)
+{
+    for (int i = 0; i < m_autotilesGL.size(); i++) {
+        if (!m_autotilesGL.at(i)->isEmpty())
+            renderList.add(MapRenderKind::Autotiles, mapPortion, i);
+    }
+}
+
+// -------------------------------------------------------
+
+void Autotiles::paintGL(int textureID, const QSet<Position>& hidden){
+    m_autotilesGL.at(textureID)->paintGL(hidden);
 }
 
 // -------------------------------------------------------
@@ -461,9 +596,9 @@ void Autotiles::read(const QJsonObject & json){
         Position p;
         p.read(obj["k"].toArray());
         QJsonObject objLand = obj["v"].toObject();
-        AutotileDatas* autotile = new AutotileDatas;
-        autotile->read(objLand);
-        m_all[p] = autotile;
+        AutotileDatas autotile;
+        autotile.read(objLand);
+        setAutotile(p, autotile);
     }
 }
 
@@ -472,18 +607,59 @@ void Autotiles::read(const QJsonObject & json){
 void Autotiles::write(QJsonObject & json) const{
     QJsonArray tab;
 
-    QHash<Position, AutotileDatas*>::const_iterator i;
-    for (i = m_all.begin(); i != m_all.end(); i++){
+    for (int i = 0; i < m_grid.count(); i++){
         QJsonObject objHash;
         QJsonArray tabKey;
-        Position position = i.key();
+        Position position = m_grid.positionAt(i);
         position.write(tabKey);
-        AutotileDatas* autotile = i.value();
+        AutotileDatas* autotile = createView(i);
         QJsonObject obj;
         autotile->write(obj);
+        delete autotile;
         objHash["k"] = tabKey;
         objHash["v"] = obj;
         tab.append(objHash);
     }
     json["autotiles"] = tab;
 }
+
+// -------------------------------------------------------
+
+void Autotiles::readBinary(QDataStream& stream){
+    qint32 count, xOffset, yOffset, zOffset, autotileID, tileID;
+    qint16 x, y, width, height;
+    bool up;
+
+    // Same layout as AutotileDatas::readBinary, without creating the
+    // autotiles
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++){
+        Position p;
+        p.readBinary(stream);
+        stream >> xOffset >> yOffset >> zOffset >> up >> x >> y >> width
+               >> height >> autotileID >> tileID;
+        setAutotileAt(p, autotileID, QRect(x, y, width, height), tileID, up,
+                      xOffset, yOffset, zOffset);
+    }
+}
+
+// -------------------------------------------------------
+
+void Autotiles::writeBinary(QDataStream& stream) const{
+    stream << static_cast<qint32>(m_grid.count());
+
+    // Same layout as AutotileDatas::writeBinary
+    for (int i = 0; i < m_grid.count(); i++){
+        const QRect& texture = m_textures.at(m_texturesIndexes.at(i));
+        m_grid.positionAt(i).writeBinary(stream);
+        stream << static_cast<qint32>(m_xOffsets.at(i))
+               << static_cast<qint32>(m_yOffsets.at(i))
+               << static_cast<qint32>(m_zOffsets.at(i)) << m_ups.at(i)
+               << static_cast<qint16>(texture.left())
+               << static_cast<qint16>(texture.top())
+               << static_cast<qint16>(texture.width())
+               << static_cast<qint16>(texture.height())
+               << static_cast<qint32>(m_autotilesIDs.at(i))
+               << static_cast<qint32>(m_tilesIDs.at(i));
+    }
+}
@@ -24,14 +24,19 @@
 #include "autotile.h"
 #include "mapproperties.h"
 #include "textureautotile.h"
+#include "maprenderlist.h"
+#include "landsgrid.h"
 
 class MapPortion;
+class Map;
 
 // -------------------------------------------------------
 //
 //  CLASS Autotiles
 //
-//  Autotiles grouped that are having the same texture.
+//  The autotiles in a portion of the map, stored as a structure of arrays
+//  indexed by the same dense grid as the floors. An AutotileDatas is only
+//  created as a copy of an autotile, owned by the caller.
 //
 // -------------------------------------------------------
 
@@ -40,18 +45,22 @@ class Autotiles : public Serializable, protected QOpenGLFunctions
 public:
     Autotiles();
     virtual ~Autotiles();
-    static QHash<QString, int> initializeAutotileBorder();
-    static QHash<QString, int> autotileBorder;
     static const int COUNT_LIST;
-    static QString listA[];
-    static QString listB[];
-    static QString listC[];
-    static QString listD[];
+    static const int BORDERS_A[];
+    static const int BORDERS_B[];
+    static const int BORDERS_C[];
+    static const int BORDERS_D[];
+    static const int COUNT_NEIGHBOURS;
+    static const int NEIGHBOURS_X[];
+    static const int NEIGHBOURS_Z[];
 
     bool isEmpty() const;
+    int count() const;
     void clearAutotilesGL();
+    bool contains(Position& p) const;
+    bool getTexture(Position& p, int& autotileID, QRect& texture) const;
     AutotileDatas* getAutotile(Position& p) const;
-    void setAutotile(Position& p, AutotileDatas* autotile);
+    void setAutotile(Position& p, AutotileDatas& autotile);
     AutotileDatas* removeAutotile(Position& p);
     bool addAutotile(Position& p, AutotileDatas* autotile,
                      QJsonObject &previousObj,
@@ -60,6 +69,7 @@ public:
     bool deleteAutotile(Position& p, QJsonObject &previous,
                         MapEditorSubSelectionKind &previousType,
                         QSet<MapPortion*>& update, QSet<MapPortion*>& save);
+    bool updateTileID(Position& p, int neighboursMask);
 
     void removeAutotileOut(MapProperties& properties);
     MapElement *updateRaycasting(int squareSize, float& finalDistance,
@@ -67,60 +77,59 @@ public:
     bool updateRaycastingAt(Position &position, AutotileDatas *autotile,
                             int squareSize, float &finalDistance,
                             Position &finalPosition, QRay3D& ray);
-    void getAutotilesWithPreview(
-            QHash<Position, AutotileDatas*> &autotilesWithPreview,
-            QHash<Position, MapElement *> &preview);
-    static AutotileDatas* tileExisting(Position& position, Portion& portion,
-                                      QHash<Position, AutotileDatas*> &preview);
-    static AutotileDatas* tileOnWhatever(
-            Position& position, Portion& portion, int id, QRect &rect,
-            QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnLeft(Position& position, Portion& portion, int id,
-                           QRect& rect,
-                           QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnRight(Position& position, Portion& portion, int id,
-                            QRect& rect,
-                            QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnTop(Position& position, Portion& portion, int id,
-                          QRect& rect,
-                          QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnBottom(Position& position, Portion& portion, int id,
-                             QRect& rect,
-                             QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnTopLeft(Position& position, Portion& portion, int id,
-                              QRect& rect,
-                              QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnTopRight(Position& position, Portion& portion, int id,
-                               QRect& rect,
-                               QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnBottomLeft(Position& position, Portion& portion, int id,
-                                 QRect& rect,
-                                 QHash<Position, AutotileDatas*> &preview);
-    static bool tileOnBottomRight(Position& position, Portion& portion, int id,
-                                  QRect& rect,
-                                  QHash<Position, AutotileDatas*> &preview);
+    AutotileDatas* tileExisting(Map* map, Position& position,
+                                Portion& portion,
+                                QHash<Position, MapElement*>* preview) const;
+    static bool tileOnWhatever(Map* map, Position& position, Portion& portion,
+                               int id, const QRect& rect,
+                               const Autotiles& autotiles,
+                               QHash<Position, MapElement*>* preview);
+    int neighboursMask(Position& position, Portion& portion, int id,
+                       const QRect& rect,
+                       QHash<Position, MapElement*>* preview) const;
+    static int tileID(int mask);
     void updateAround(Position& position,
-                      QHash<Position, AutotileDatas *> &autotiles,
                       QSet<MapPortion *> &update, QSet<MapPortion *> &save,
+                      QHash<Position, MapElement*>* preview,
                       QSet<MapPortion*>* previousPreview);
     void updateWithoutPreview(Position& position, QSet<MapPortion *> &update,
                               QSet<MapPortion *> &save);
+    bool updateAutotile(Position& position, Portion& portion);
     void initializeVertices(QList<TextureAutotile*> &texturesAutotiles,
-                            QHash<Position, MapElement*>& previewSquares,
                             int squareSize);
     void initializeGL(QOpenGLShaderProgram* program);
     void updateGL();
-    void paintGL(int textureID);
+    void addToRenderList(MapRenderList& renderList, MapPortion* mapPortion);
+    void paintGL(int textureID, const QSet<Position>& hidden);
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 protected:
-    QHash<Position, AutotileDatas*> m_all;
+    // One entry per autotile in each array, at its index in the grid
+    LandsGrid m_grid;
+    QVector<int> m_autotilesIDs;
+    QVector<int> m_texturesIndexes;
+    QVector<int> m_tilesIDs;
+    QVector<bool> m_ups;
+    QVector<int> m_xOffsets;
+    QVector<int> m_yOffsets;
+    QVector<int> m_zOffsets;
+    QVector<QRect> m_textures;
+
     QList<Autotile*> m_autotilesGL;
 
     // OpenGL
     QOpenGLShaderProgram* m_program;
+
+    int textureIndex(const QRect& texture);
+    void setAutotileAt(const Position& p, int autotileID, const QRect& texture,
+                       int tileID, bool up, int xOffset, int yOffset,
+                       int zOffset);
+    void removeAt(int index);
+    AutotileDatas* createView(int index) const;
 };
 
 #endif // AUTOTILES_H
@@ -0,0 +1,180 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "autotilesregion.h"
+#include "autotiles.h"
+#include "map.h"
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+AutotilesRegion::AutotilesRegion(Map* map) :
+    m_map(map),
+    m_minX(0),
+    m_minZ(0),
+    m_width(0),
+    m_height(0)
+{
+
+}
+
+AutotilesRegion::~AutotilesRegion()
+{
+
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void AutotilesRegion::update(const QSet<Position>& changed,
+                             QHash<Portion, MapPortion*>& portionsChanged)
+{
+    QHash<Position, QList<Position>> positionsByPlane;
+    QSet<Position> positions;
+
+    // Squares changed and their neighbours, each one only once
+    QSet<Position>::const_iterator i;
+    for (i = changed.begin(); i != changed.end(); i++) {
+        const Position& position = *i;
+        for (int x = -1; x <= 1; x++) {
+            for (int z = -1; z <= 1; z++) {
+                positions += Position(position.x() + x, position.y(),
+                                      position.yPlus(), position.z() + z,
+                                      position.layer());
+            }
+        }
+    }
+    for (i = positions.begin(); i != positions.end(); i++) {
+        const Position& position = *i;
+        positionsByPlane[Position(0, position.y(), position.yPlus(), 0,
+                                  position.layer())].append(position);
+    }
+
+    // The portions already edited may not be in the map grid (undo / redo)
+    m_portions = portionsChanged;
+
+    QHash<Position, QList<Position>>::iterator j;
+    for (j = positionsByPlane.begin(); j != positionsByPlane.end(); j++) {
+        fillGrid(j.key(), j.value());
+        updatePlane(j.value(), portionsChanged);
+    }
+}
+
+// -------------------------------------------------------
+
+MapPortion* AutotilesRegion::getMapPortion(Portion& portion) {
+    QHash<Portion, MapPortion*>::iterator i = m_portions.find(portion);
+    if (i != m_portions.end())
+        return i.value();
+
+    MapPortion* mapPortion = m_map->isInPortion(portion, 0)
+            ? m_map->mapPortion(portion) : nullptr;
+    m_portions.insert(portion, mapPortion);
+
+    return mapPortion;
+}
+
+// -------------------------------------------------------
+
+int AutotilesRegion::cellIndex(int x, int z) const {
+    return ((z - m_minZ) * m_width) + (x - m_minX);
+}
+
+// -------------------------------------------------------
+
+void AutotilesRegion::fillGrid(const Position& plane,
+                               const QList<Position>& positions)
+{
+    int maxX, maxZ;
+    Portion portion;
+
+    // Bounds of the positions, plus the halo of their neighbours
+    m_minX = maxX = positions.first().x();
+    m_minZ = maxZ = positions.first().z();
+    for (int i = 1; i < positions.size(); i++) {
+        const Position& position = positions.at(i);
+        m_minX = qMin(m_minX, position.x());
+        maxX = qMax(maxX, position.x());
+        m_minZ = qMin(m_minZ, position.z());
+        maxZ = qMax(maxZ, position.z());
+    }
+    m_minX--;
+    m_minZ--;
+    m_width = maxX - m_minX + 2;
+    m_height = maxZ - m_minZ + 2;
+
+    // Gather the autotiles of every square once, -1 without any autotile
+    m_cellsIDs.fill(-1, m_width * m_height);
+    m_cellsTextures.fill(QRect(), m_width * m_height);
+    for (int z = 0; z < m_height; z++) {
+        for (int x = 0; x < m_width; x++) {
+            Position position(m_minX + x, plane.y(), plane.yPlus(), m_minZ + z,
+                              plane.layer());
+            m_map->getLocalPortion(position, portion);
+            MapPortion* mapPortion = getMapPortion(portion);
+            int index = (z * m_width) + x;
+            if (mapPortion != nullptr &&
+                !mapPortion->getAutotileTexture(position, m_cellsIDs[index],
+                                                m_cellsTextures[index]))
+            {
+                m_cellsIDs[index] = -1;
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+void AutotilesRegion::updatePlane(const QList<Position>& positions,
+                                  QHash<Portion, MapPortion*>& portionsChanged)
+{
+    Portion portion;
+
+    for (int i = 0; i < positions.size(); i++) {
+        Position position = positions.at(i);
+        int index = cellIndex(position.x(), position.z());
+        int autotileID = m_cellsIDs.at(index);
+        if (autotileID == -1)
+            continue;
+
+        // Neighbours mask read in the grid
+        int mask = 0;
+        for (int j = 0; j < Autotiles::COUNT_NEIGHBOURS; j++) {
+            int neighbour = cellIndex(
+                        position.x() + Autotiles::NEIGHBOURS_X[j],
+                        position.z() + Autotiles::NEIGHBOURS_Z[j]);
+            if (m_cellsIDs.at(neighbour) == autotileID &&
+                m_cellsTextures.at(neighbour) == m_cellsTextures.at(index))
+            {
+                mask |= 1 << j;
+            }
+        }
+
+        m_map->getLocalPortion(position, portion);
+        MapPortion* mapPortion = getMapPortion(portion);
+        if (mapPortion->updateAutotileTileID(position, mask))
+            portionsChanged.insert(portion, mapPortion);
+    }
+}
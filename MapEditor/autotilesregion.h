@@ -0,0 +1,74 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUTOTILESREGION_H
+#define AUTOTILESREGION_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QRect>
+#include "position.h"
+#include "portion.h"
+
+class Map;
+class MapPortion;
+
+// -------------------------------------------------------
+//
+//  CLASS AutotilesRegion
+//
+//  Recompute the autotiles around a set of changed squares in one pass. The
+//  autotiles of each plane (y, y plus and layer) are gathered once in a
+//  dense grid covering the changed squares, their neighbours and a one
+//  square halo, whatever the portions they belong to. Only their IDs and
+//  textures are gathered, each autotile is then updated exactly once from
+//  the grid.
+//
+// -------------------------------------------------------
+
+class AutotilesRegion
+{
+public:
+    AutotilesRegion(Map* map);
+    virtual ~AutotilesRegion();
+
+    void update(const QSet<Position>& changed,
+                QHash<Portion, MapPortion*>& portionsChanged);
+
+protected:
+    Map* m_map;
+    QHash<Portion, MapPortion*> m_portions;
+
+    // Grid of the current plane
+    int m_minX;
+    int m_minZ;
+    int m_width;
+    int m_height;
+    QVector<int> m_cellsIDs;
+    QVector<QRect> m_cellsTextures;
+
+    MapPortion* getMapPortion(Portion& portion);
+    int cellIndex(int x, int z) const;
+    void fillGrid(const Position& plane, const QList<Position>& positions);
+    void updatePlane(const QList<Position>& positions,
+                     QHash<Portion, MapPortion*>& portionsChanged);
+};
+
+#endif // AUTOTILESREGION_H
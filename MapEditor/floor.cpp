@@ -77,14 +77,26 @@ void FloorDatas::initializeVertices(int squareSize, int width, int height,
                                    QVector<Vertex>& vertices,
                                    QVector<GLuint>& indexes, Position& position,
                                    int& count)
+{
+    initializeVertices(m_textureRect, m_up, squareSize, width, height,
+                       vertices, indexes, position, count);
+}
+
+// -------------------------------------------------------
+
+void FloorDatas::initializeVertices(const QRect& texture, bool up,
+                                    int squareSize, int width, int height,
+                                    QVector<Vertex>& vertices,
+                                    QVector<GLuint>& indexes,
+                                    Position& position, int& count)
 {
     QVector3D pos, size;
-    getPosSize(pos, size, squareSize, position);
+    getPosSize(pos, size, squareSize, position, up);
 
-    float x = (float)(textureRect()->x() * squareSize) / width;
-    float y = (float)(textureRect()->y() * squareSize) / height;
-    float w = (float)(textureRect()->width() * squareSize) / width;
-    float h = (float)(textureRect()->height() * squareSize) / height;
+    float x = (float)(texture.x() * squareSize) / width;
+    float y = (float)(texture.y() * squareSize) / height;
+    float w = (float)(texture.width() * squareSize) / width;
+    float h = (float)(texture.height() * squareSize) / height;
     float coefX = 0.1 / width;
     float coefY = 0.1 / height;
     x += coefX;
@@ -55,6 +55,11 @@ public:
                                     QVector<Vertex>& vertices,
                                     QVector<GLuint>& indexes,
                                     Position& position, int& count);
+    static void initializeVertices(const QRect& texture, bool up,
+                                   int squareSize, int width, int height,
+                                   QVector<Vertex>& vertices,
+                                   QVector<GLuint>& indexes,
+                                   Position& position, int& count);
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject & json) const;
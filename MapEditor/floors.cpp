@@ -18,6 +18,7 @@
 */
 
 #include "floors.h"
+#include "lands.h"
 #include "wanok.h"
 
 // -------------------------------------------------------
@@ -27,8 +28,6 @@
 // -------------------------------------------------------
 
 Floors::Floors() :
-    m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
-    m_indexBuffer(QOpenGLBuffer::IndexBuffer),
     m_programStatic(nullptr)
 {
 
@@ -36,9 +35,7 @@ Floors::Floors() :
 
 Floors::~Floors()
 {
-    QHash<Position, FloorDatas*>::iterator i;
-    for (i = m_all.begin(); i != m_all.end(); i++)
-        delete i.value();
+
 }
 
 // -------------------------------------------------------
@@ -48,28 +45,57 @@ Floors::~Floors()
 // -------------------------------------------------------
 
 bool Floors::isEmpty() const{
-    return m_all.size() == 0;
+    return m_grid.isEmpty();
+}
+
+// -------------------------------------------------------
+
+int Floors::count() const {
+    return m_grid.count();
+}
+
+// -------------------------------------------------------
+
+bool Floors::contains(Position& p) const {
+    return m_grid.indexOf(p) != -1;
+}
+
+// -------------------------------------------------------
+
+bool Floors::getTexture(Position& p, QRect& texture) const {
+    int index = m_grid.indexOf(p);
+    if (index == -1)
+        return false;
+
+    texture = m_textures.at(m_texturesIndexes.at(index));
+
+    return true;
 }
 
 // -------------------------------------------------------
 
 FloorDatas *Floors::getFloor(Position& p) const{
-    return m_all.value(p);
+    int index = m_grid.indexOf(p);
+
+    return (index == -1) ? nullptr : createView(index);
 }
 
 // -------------------------------------------------------
 
-void Floors::setFloor(Position& p, FloorDatas *floor){
-    m_all.insert(p, floor);
+void Floors::setFloor(Position& p, FloorDatas& floor){
+    setFloorAt(p, *floor.textureRect(), floor.up(), floor.xOffset(),
+               floor.yOffset(), floor.zOffset());
 }
 
 // -------------------------------------------------------
 
 FloorDatas *Floors::removeFloor(Position& p){
-    FloorDatas* floor = m_all.value(p);
+    int index = m_grid.indexOf(p);
+    if (index == -1)
+        return nullptr;
 
-    if (floor != nullptr)
-        m_all.remove(p);
+    FloorDatas* floor = createView(index);
+    removeAt(index);
 
     return floor;
 }
@@ -77,21 +103,17 @@ FloorDatas *Floors::removeFloor(Position& p){
 // -------------------------------------------------------
 
 void Floors::removeFloorOut(MapProperties& properties) {
-    QList<Position> list;
-    QHash<Position, FloorDatas*>::iterator i;
-    for (i = m_all.begin(); i != m_all.end(); i++) {
-        Position position = i.key();
+
+    // Backward because the last floor is moved in the removed one
+    for (int i = m_grid.count() - 1; i >= 0; i--) {
+        Position position = m_grid.positionAt(i);
 
         if (position.x() >= properties.length() ||
             position.z() >= properties.width())
         {
-            delete *i;
-            list.push_back(position);
+            removeAt(i);
         }
     }
-
-    for (int j = 0; j < list.size(); j++)
-        m_all.remove(list.at(j));
 }
 
 // -------------------------------------------------------
@@ -99,21 +121,26 @@ void Floors::removeFloorOut(MapProperties& properties) {
 MapElement* Floors::updateRaycasting(int squareSize, float& finalDistance,
                                      Position &finalPosition, QRay3D &ray)
 {
-    MapElement* element = nullptr;
-
-    for (QHash<Position, FloorDatas*>::iterator i = m_all.begin();
-         i != m_all.end(); i++)
-    {
-        Position position = i.key();
-        FloorDatas* floor = i.value();
-        if (updateRaycastingAt(position, floor, squareSize, finalDistance,
-                               finalPosition, ray))
-        {
-            element = floor;
+    int index = -1;
+
+    // Only the squares under the ray on each level
+    QList<Position> positions;
+    m_grid.getPositions(ray, squareSize, positions);
+    for (int i = 0; i < positions.size(); i++) {
+        Position position = positions.at(i);
+        int j = m_grid.indexOf(position);
+        if (j == -1)
+            continue;
+
+        float newDistance = LandDatas::intersection(squareSize, ray, position,
+                                                    m_ups.at(j));
+        if (Wanok::getMinDistance(finalDistance, newDistance)) {
+            finalPosition = position;
+            index = j;
         }
     }
 
-    return element;
+    return (index == -1) ? nullptr : createView(index);
 }
 
 // -------------------------------------------------------
@@ -131,37 +158,93 @@ bool Floors::updateRaycastingAt(Position &position, FloorDatas* floor,
     return false;
 }
 
+// -------------------------------------------------------
+
+int Floors::textureIndex(const QRect& texture) {
+    int index = m_textures.indexOf(texture);
+    if (index == -1) {
+        index = m_textures.size();
+        m_textures.append(texture);
+    }
+
+    return index;
+}
+
+// -------------------------------------------------------
+
+void Floors::setFloorAt(const Position& p, const QRect& texture, bool up,
+                        int xOffset, int yOffset, int zOffset)
+{
+    int index = m_grid.indexOf(p);
+    if (index == -1) {
+        m_grid.add(p);
+        m_texturesIndexes.append(textureIndex(texture));
+        m_ups.append(up);
+        m_xOffsets.append(xOffset);
+        m_yOffsets.append(yOffset);
+        m_zOffsets.append(zOffset);
+    }
+    else {
+        m_texturesIndexes[index] = textureIndex(texture);
+        m_ups[index] = up;
+        m_xOffsets[index] = xOffset;
+        m_yOffsets[index] = yOffset;
+        m_zOffsets[index] = zOffset;
+    }
+}
+
+// -------------------------------------------------------
+
+void Floors::removeAt(int index) {
+    int last = m_grid.count() - 1;
+    m_grid.removeAt(index);
+
+    // Move the last floor in the removed one, as the grid did
+    if (index != last) {
+        m_texturesIndexes[index] = m_texturesIndexes.at(last);
+        m_ups[index] = m_ups.at(last);
+        m_xOffsets[index] = m_xOffsets.at(last);
+        m_yOffsets[index] = m_yOffsets.at(last);
+        m_zOffsets[index] = m_zOffsets.at(last);
+    }
+
+    m_texturesIndexes.removeLast();
+    m_ups.removeLast();
+    m_xOffsets.removeLast();
+    m_yOffsets.removeLast();
+    m_zOffsets.removeLast();
+}
+
+// -------------------------------------------------------
+
+FloorDatas* Floors::createView(int index) const {
+    FloorDatas* floor = new FloorDatas(
+                new QRect(m_textures.at(m_texturesIndexes.at(index))),
+                m_ups.at(index));
+    floor->setXOffset(m_xOffsets.at(index));
+    floor->setYOffset(m_yOffsets.at(index));
+    floor->setZOffset(m_zOffsets.at(index));
+
+    return floor;
+}
+
 // -------------------------------------------------------
 //
 //  GL
 //
 // -------------------------------------------------------
 
-void Floors::initializeVertices(QHash<Position, MapElement *> &previewSquares,
-                                int squareSize, int width, int height)
-{
+void Floors::initializeVertices(int squareSize, int width, int height) {
     m_vertices.clear();
     m_indexes.clear();
     int count = 0;
 
-    // Create temp hash for preview
-    QHash<Position, FloorDatas*> floorsWithPreview(m_all);
-    QHash<Position, MapElement*>::iterator it;
-    for (it = previewSquares.begin(); it != previewSquares.end(); it++) {
-        MapElement* element = it.value();
-        if (element->getSubKind() == MapEditorSubSelectionKind::Floors)
-            floorsWithPreview[it.key()] = (FloorDatas*) element;
-        else if (element->getSubKind() == MapEditorSubSelectionKind::Autotiles)
-            floorsWithPreview.remove(it.key());
-    }
-
-    // Initialize vertices
-    QHash<Position, FloorDatas*>::iterator i;
-    for (i = floorsWithPreview.begin(); i != floorsWithPreview.end(); i++) {
-        FloorDatas* floor = i.value();
-        Position p = i.key();
-        floor->initializeVertices(squareSize, width, height, m_vertices,
-                                  m_indexes, p, count);
+    // One quad per floor, in the order of the arrays
+    for (int i = 0; i < m_grid.count(); i++) {
+        Position position = m_grid.positionAt(i);
+        FloorDatas::initializeVertices(m_textures.at(m_texturesIndexes.at(i)),
+                                       m_ups.at(i), squareSize, width, height,
+                                       m_vertices, m_indexes, position, count);
     }
 }
 
@@ -178,15 +261,43 @@ void Floors::initializeGL(QOpenGLShaderProgram *programStatic){
 // -------------------------------------------------------
 
 void Floors::updateGL(){
-    Map::updateGLStatic(m_vertexBuffer, m_indexBuffer, m_vertices, m_indexes,
+    Map::updateGLStatic(m_vertexRange, m_indexRange, m_vertices, m_indexes,
                         m_vao, m_programStatic);
 }
 
 // -------------------------------------------------------
 
-void Floors::paintGL(){
+void Floors::addToRenderList(MapRenderList& renderList,
+                             MapPortion* mapPortion)
+{
+    if (!m_indexes.isEmpty())
+        renderList.add(MapRenderKind::Floors, mapPortion);
+}
+
+// -------------------------------------------------------
+
+void Floors::paintGL(const QSet<Position>& hidden){
     m_vao.bind();
-    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT, 0);
+    if (hidden.isEmpty()) {
+        glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT,
+                       m_indexRange.indexesOffset());
+    }
+    else {
+
+        // The quad of a floor is given by its index in the arrays
+        QList<QPair<int, int>> hiddenRanges;
+        QSet<Position>::const_iterator i;
+        for (i = hidden.begin(); i != hidden.end(); i++) {
+            int index = m_grid.indexOf(*i);
+            if (index != -1) {
+                hiddenRanges.append(QPair<int, int>(
+                    index * Lands::nbIndexesQuad,
+                    (index + 1) * Lands::nbIndexesQuad));
+            }
+        }
+        GLElementsRanges::paint(this, m_indexRange.indexesOffset(),
+                                m_indexes.size(), hiddenRanges);
+    }
     m_vao.release();
 }
 
@@ -204,9 +315,10 @@ void Floors::read(const QJsonObject & json){
         Position p;
         p.read(obj["k"].toArray());
         QJsonObject objLand = obj["v"].toObject();
-        FloorDatas* floor = new FloorDatas;
-        floor->read(objLand);
-        m_all[p] = floor;
+        FloorDatas floor;
+        floor.read(objLand);
+        setFloorAt(p, *floor.textureRect(), floor.up(), floor.xOffset(),
+                   floor.yOffset(), floor.zOffset());
     }
 }
 
@@ -215,18 +327,56 @@ void Floors::read(const QJsonObject & json){
 void Floors::write(QJsonObject & json) const{
     QJsonArray tabFloors;
 
-    QHash<Position, FloorDatas*>::const_iterator i;
-    for (i = m_all.begin(); i != m_all.end(); i++){
+    for (int i = 0; i < m_grid.count(); i++){
         QJsonObject objHash;
         QJsonArray tabKey;
-        Position position = i.key();
+        Position position = m_grid.positionAt(i);
         position.write(tabKey);
-        FloorDatas* floor = i.value();
+        FloorDatas* floor = createView(i);
         QJsonObject objFloor;
         floor->write(objFloor);
+        delete floor;
         objHash["k"] = tabKey;
         objHash["v"] = objFloor;
         tabFloors.append(objHash);
     }
     json["floors"] = tabFloors;
 }
+
+// -------------------------------------------------------
+
+void Floors::readBinary(QDataStream& stream){
+    qint32 count, xOffset, yOffset, zOffset;
+    qint16 x, y, width, height;
+    bool up;
+
+    // Same layout as FloorDatas::readBinary, without creating the floors
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++){
+        Position p;
+        p.readBinary(stream);
+        stream >> xOffset >> yOffset >> zOffset >> up >> x >> y >> width
+               >> height;
+        setFloorAt(p, QRect(x, y, width, height), up, xOffset, yOffset,
+                   zOffset);
+    }
+}
+
+// -------------------------------------------------------
+
+void Floors::writeBinary(QDataStream& stream) const{
+    stream << static_cast<qint32>(m_grid.count());
+
+    // Same layout as FloorDatas::writeBinary
+    for (int i = 0; i < m_grid.count(); i++){
+        const QRect& texture = m_textures.at(m_texturesIndexes.at(i));
+        m_grid.positionAt(i).writeBinary(stream);
+        stream << static_cast<qint32>(m_xOffsets.at(i))
+               << static_cast<qint32>(m_yOffsets.at(i))
+               << static_cast<qint32>(m_zOffsets.at(i)) << m_ups.at(i)
+               << static_cast<qint16>(texture.left())
+               << static_cast<qint16>(texture.top())
+               << static_cast<qint16>(texture.width())
+               << static_cast<qint16>(texture.height());
+    }
+}
@@ -23,12 +23,19 @@
 #include <QHash>
 #include "mapproperties.h"
 #include "floor.h"
+#include "glbufferarena.h"
+#include "glelementsranges.h"
+#include "maprenderlist.h"
+#include "landsgrid.h"
 
 // -------------------------------------------------------
 //
 //  CLASS Floors
 //
-//  A set of static floors in a portion of the map.
+//  A set of static floors in a portion of the map. The floors are stored
+//  as a structure of arrays indexed by a dense grid of the portion. The
+//  editor probes them with contains / getTexture, a FloorDatas is only
+//  created as a copy of a floor, owned by the caller.
 //
 // -------------------------------------------------------
 
@@ -38,8 +45,11 @@ public:
     Floors();
     virtual ~Floors();
     bool isEmpty() const;
+    int count() const;
+    bool contains(Position& p) const;
+    bool getTexture(Position& p, QRect& texture) const;
     FloorDatas* getFloor(Position& p) const;
-    void setFloor(Position& p, FloorDatas* floor);
+    void setFloor(Position& p, FloorDatas& floor);
     FloorDatas* removeFloor(Position& p);
     bool addFloor(Position& p, FloorDatas* floor, QJsonObject &previousObj,
                   MapEditorSubSelectionKind& previousType);
@@ -53,25 +63,40 @@ public:
                             int squareSize, float &finalDistance,
                             Position &finalPosition, QRay3D& ray);
 
-    void initializeVertices(QHash<Position, MapElement*>& previewSquares,
-                            int squareSize, int width, int height);
+    void initializeVertices(int squareSize, int width, int height);
     void initializeGL(QOpenGLShaderProgram* programStatic);
     void updateGL();
-    void paintGL();
+    void addToRenderList(MapRenderList& renderList, MapPortion* mapPortion);
+    void paintGL(const QSet<Position>& hidden);
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 protected:
-    QHash<Position, FloorDatas*> m_all;
+    // One entry per floor in each array, at its index in the grid
+    LandsGrid m_grid;
+    QVector<int> m_texturesIndexes;
+    QVector<bool> m_ups;
+    QVector<int> m_xOffsets;
+    QVector<int> m_yOffsets;
+    QVector<int> m_zOffsets;
+    QVector<QRect> m_textures;
 
     // OpenGL informations
-    QOpenGLBuffer m_vertexBuffer;
-    QOpenGLBuffer m_indexBuffer;
+    GLBufferRange m_vertexRange;
+    GLBufferRange m_indexRange;
     QVector<Vertex> m_vertices;
     QVector<GLuint> m_indexes;
     QOpenGLVertexArrayObject m_vao;
     QOpenGLShaderProgram* m_programStatic;
+
+    int textureIndex(const QRect& texture);
+    void setFloorAt(const Position& p, const QRect& texture, bool up,
+                    int xOffset, int yOffset, int zOffset);
+    void removeAt(int index);
+    FloorDatas* createView(int index) const;
 };
 
 #endif // FLOORS_H
@@ -0,0 +1,216 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glbufferarena.h"
+#include <cstring>
+
+const int GLBufferArena::MINIMUM_CAPACITY = 256 * 1024;
+const int GLBufferArena::ALIGNMENT = 64;
+
+// -------------------------------------------------------
+//
+//
+//  ---------- GLBUFFERRANGE
+//
+//
+// -------------------------------------------------------
+
+GLBufferRange::GLBufferRange() :
+    m_arena(nullptr),
+    m_offset(0),
+    m_size(0),
+    m_capacity(0)
+{
+
+}
+
+GLBufferRange::~GLBufferRange()
+{
+    if (m_arena != nullptr)
+        m_arena->free(*this);
+}
+
+GLBufferArena* GLBufferRange::arena() const { return m_arena; }
+
+int GLBufferRange::offset() const { return m_offset; }
+
+int GLBufferRange::size() const { return m_size; }
+
+int GLBufferRange::capacity() const { return m_capacity; }
+
+const GLvoid* GLBufferRange::indexesOffset() const {
+    return (const GLvoid*) (qintptr) m_offset;
+}
+
+// -------------------------------------------------------
+//
+//
+//  ---------- GLBUFFERARENA
+//
+//
+// -------------------------------------------------------
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+GLBufferArena::GLBufferArena(QOpenGLBuffer::Type type) :
+    m_buffer(type),
+    m_used(0)
+{
+
+}
+
+GLBufferArena::~GLBufferArena()
+{
+
+}
+
+QOpenGLBuffer& GLBufferArena::buffer() { return m_buffer; }
+
+int GLBufferArena::capacity() const { return m_datas.size(); }
+
+int GLBufferArena::used() const { return m_used; }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+bool GLBufferArena::write(GLBufferRange& range, const void* datas, int size) {
+    bool moved = false;
+
+    // Move the range if the datas does not fit in it anymore
+    if (range.m_arena != this || size > range.m_capacity) {
+        int capacity = qMax(size, range.m_capacity * 2);
+        if (range.m_arena != nullptr)
+            range.m_arena->free(range);
+        if (size == 0)
+            return false;
+        allocate(range, capacity);
+        moved = true;
+    }
+
+    range.m_size = size;
+    if (size > 0) {
+        std::memcpy(m_datas.data() + range.m_offset, datas, size);
+        m_buffer.bind();
+        m_buffer.write(range.m_offset, datas, size);
+        m_buffer.release();
+    }
+
+    return moved;
+}
+
+// -------------------------------------------------------
+
+void GLBufferArena::free(GLBufferRange& range) {
+    if (range.m_arena != this)
+        return;
+
+    addFreeRange(range.m_offset, range.m_capacity);
+    m_used -= range.m_capacity;
+    range.m_arena = nullptr;
+    range.m_offset = 0;
+    range.m_size = 0;
+    range.m_capacity = 0;
+
+    // Give the storage back when nothing uses it anymore (e.g. closed map)
+    if (m_used == 0) {
+        m_freeRanges.clear();
+        m_datas.clear();
+        if (m_buffer.isCreated())
+            m_buffer.destroy();
+    }
+}
+
+// -------------------------------------------------------
+
+void GLBufferArena::allocate(GLBufferRange& range, int capacity) {
+    capacity = (capacity + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    // First free range big enough
+    QMap<int, int>::iterator i;
+    for (i = m_freeRanges.begin(); i != m_freeRanges.end(); i++) {
+        if (i.value() >= capacity)
+            break;
+    }
+    if (i == m_freeRanges.end()) {
+        grow(capacity);
+        i = m_freeRanges.end() - 1;
+    }
+
+    int offset = i.key();
+    int rest = i.value() - capacity;
+    m_freeRanges.erase(i);
+    if (rest > 0)
+        m_freeRanges.insert(offset + capacity, rest);
+
+    range.m_arena = this;
+    range.m_offset = offset;
+    range.m_size = 0;
+    range.m_capacity = capacity;
+    m_used += capacity;
+}
+
+// -------------------------------------------------------
+
+void GLBufferArena::grow(int capacity) {
+    int previousCapacity = m_datas.size();
+    int newCapacity = qMax(previousCapacity, MINIMUM_CAPACITY);
+    while (newCapacity < previousCapacity + capacity)
+        newCapacity *= 2;
+
+    m_datas.resize(newCapacity);
+    addFreeRange(previousCapacity, newCapacity - previousCapacity);
+
+    // Reallocating the storage keeps the buffer name used by the VAOs
+    if (!m_buffer.isCreated())
+        m_buffer.create();
+    m_buffer.bind();
+    m_buffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_buffer.allocate(m_datas.constData(), newCapacity);
+    m_buffer.release();
+}
+
+// -------------------------------------------------------
+
+void GLBufferArena::addFreeRange(int offset, int size) {
+    QMap<int, int>::iterator next = m_freeRanges.lowerBound(offset);
+
+    // Merge with the next free range
+    if (next != m_freeRanges.end() && next.key() == offset + size) {
+        size += next.value();
+        next = m_freeRanges.erase(next);
+    }
+
+    // Merge with the previous free range
+    if (next != m_freeRanges.begin()) {
+        QMap<int, int>::iterator previous = next - 1;
+        if (previous.key() + previous.value() == offset) {
+            previous.value() += size;
+            return;
+        }
+    }
+
+    m_freeRanges.insert(offset, size);
+}
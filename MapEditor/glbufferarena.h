@@ -0,0 +1,99 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GLBUFFERARENA_H
+#define GLBUFFERARENA_H
+
+#include <QOpenGLBuffer>
+#include <QByteArray>
+#include <QMap>
+
+class GLBufferArena;
+
+// -------------------------------------------------------
+//
+//  CLASS GLBufferRange
+//
+//  A range of bytes sub-allocated in a GLBufferArena. The range is given back
+//  to its arena when destroyed.
+//
+// -------------------------------------------------------
+
+class GLBufferRange
+{
+public:
+    GLBufferRange();
+    ~GLBufferRange();
+    GLBufferArena* arena() const;
+    int offset() const;
+    int size() const;
+    int capacity() const;
+    const GLvoid* indexesOffset() const;
+
+protected:
+    GLBufferArena* m_arena;
+    int m_offset;
+    int m_size;
+    int m_capacity;
+
+    friend class GLBufferArena;
+
+private:
+    Q_DISABLE_COPY(GLBufferRange)
+};
+
+// -------------------------------------------------------
+//
+//  CLASS GLBufferArena
+//
+//  One large GL buffer shared by all the map portions, in which each portion
+//  has its own range. A range is patched in place with glBufferSubData, and
+//  only moves when its datas does not fit anymore (its capacity is doubled).
+//  The arena itself doubles when it is full: the buffer keeps the same name,
+//  so that the VAOs using it stay valid. A copy of the datas is kept in order
+//  to fill the bigger storage (glCopyBufferSubData is not available in
+//  OpenGL 2).
+//
+// -------------------------------------------------------
+
+class GLBufferArena
+{
+public:
+    GLBufferArena(QOpenGLBuffer::Type type);
+    virtual ~GLBufferArena();
+    static const int MINIMUM_CAPACITY;
+    static const int ALIGNMENT;
+    QOpenGLBuffer& buffer();
+    int capacity() const;
+    int used() const;
+    bool write(GLBufferRange& range, const void* datas, int size);
+    void free(GLBufferRange& range);
+
+protected:
+    QOpenGLBuffer m_buffer;
+    QByteArray m_datas;
+    QMap<int, int> m_freeRanges;
+    int m_used;
+
+    void allocate(GLBufferRange& range, int capacity);
+    void grow(int capacity);
+    void addFreeRange(int offset, int size);
+};
+
+#endif // GLBUFFERARENA_H
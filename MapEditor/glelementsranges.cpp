@@ -0,0 +1,90 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glelementsranges.h"
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+GLElementsRanges::GLElementsRanges()
+{
+
+}
+
+GLElementsRanges::~GLElementsRanges()
+{
+
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void GLElementsRanges::clear() {
+    m_ranges.clear();
+}
+
+// -------------------------------------------------------
+
+void GLElementsRanges::add(const Position& position, int begin, int end) {
+    if (begin < end)
+        m_ranges.insert(position, QPair<int, int>(begin, end));
+}
+
+// -------------------------------------------------------
+
+void GLElementsRanges::getRanges(const QSet<Position>& positions,
+                                 QList<QPair<int, int>>& ranges) const
+{
+    QSet<Position>::const_iterator i;
+    for (i = positions.begin(); i != positions.end(); i++) {
+        QHash<Position, QPair<int, int>>::const_iterator j =
+                m_ranges.find(*i);
+        if (j != m_ranges.end())
+            ranges.append(j.value());
+    }
+}
+
+// -------------------------------------------------------
+
+void GLElementsRanges::paint(QOpenGLFunctions* functions,
+                             const GLvoid* offset, int count,
+                             QList<QPair<int, int>>& hiddenRanges)
+{
+    const char* indexes = static_cast<const char*>(offset);
+
+    // One draw call for each gap between the hidden ranges
+    qSort(hiddenRanges);
+    int begin = 0;
+    for (int i = 0; i <= hiddenRanges.size(); i++) {
+        int end = i < hiddenRanges.size() ? hiddenRanges.at(i).first : count;
+        if (end > begin) {
+            functions->glDrawElements(GL_TRIANGLES, end - begin,
+                                      GL_UNSIGNED_INT,
+                                      indexes + begin * sizeof(GLuint));
+        }
+        if (i < hiddenRanges.size())
+            begin = qMax(begin, hiddenRanges.at(i).second);
+    }
+}
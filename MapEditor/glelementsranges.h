@@ -0,0 +1,54 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GLELEMENTSRANGES_H
+#define GLELEMENTSRANGES_H
+
+#include <QOpenGLFunctions>
+#include <QHash>
+#include <QSet>
+#include "position.h"
+
+// -------------------------------------------------------
+//
+//  CLASS GLElementsRanges
+//
+//  The range of indexes of each element in the buffers of a layer. It
+//  allows drawing the layer without some elements (the ones hidden by a
+//  preview) while keeping the same buffers.
+//
+// -------------------------------------------------------
+
+class GLElementsRanges
+{
+public:
+    GLElementsRanges();
+    virtual ~GLElementsRanges();
+    void clear();
+    void add(const Position& position, int begin, int end);
+    void getRanges(const QSet<Position>& positions,
+                   QList<QPair<int, int>>& ranges) const;
+    static void paint(QOpenGLFunctions* functions, const GLvoid* offset,
+                      int count, QList<QPair<int, int>>& hiddenRanges);
+
+protected:
+    QHash<Position, QPair<int, int>> m_ranges;
+};
+
+#endif // GLELEMENTSRANGES_H
@@ -33,30 +33,35 @@ const QString LandDatas::JSON_TEXTURE = "t";
 
 LandDatas::LandDatas(QRect* texture, bool up) :
     MapElement(),
-    m_textureRect(texture),
+    m_textureRect(*texture),
     m_up(up)
 {
-
+    // The rectangle is stored inline, no need to keep one more allocation
+    delete texture;
 }
 
 LandDatas::~LandDatas()
 {
-    delete m_textureRect;
+
 }
 
 bool LandDatas::operator==(const LandDatas& other) const {
     return MapElement::operator==(other) && m_up == other.m_up &&
-           m_textureRect->x() == other.m_textureRect->x() &&
-           m_textureRect->y() == other.m_textureRect->y() &&
-           m_textureRect->width() == other.m_textureRect->width() &&
-           m_textureRect->height() == other.m_textureRect->height();
+           m_textureRect.x() == other.m_textureRect.x() &&
+           m_textureRect.y() == other.m_textureRect.y() &&
+           m_textureRect.width() == other.m_textureRect.width() &&
+           m_textureRect.height() == other.m_textureRect.height();
 }
 
 bool LandDatas::operator!=(const LandDatas& other) const {
     return !operator==(other);
 }
 
-QRect *LandDatas::textureRect() const { return m_textureRect; }
+QRect *LandDatas::textureRect() { return &m_textureRect; }
+
+bool LandDatas::up() const { return m_up; }
+
+void LandDatas::setUp(bool up) { m_up = up; }
 
 MapEditorSubSelectionKind LandDatas::getSubKind() const{
     return MapEditorSubSelectionKind::None;
@@ -77,8 +82,16 @@ void LandDatas::initializeVertices(int, int, int, QVector<Vertex>&,
 // -------------------------------------------------------
 
 float LandDatas::intersection(int squareSize, QRay3D& ray, Position& position) {
+    return intersection(squareSize, ray, position, m_up);
+}
+
+// -------------------------------------------------------
+
+float LandDatas::intersection(int squareSize, QRay3D& ray, Position& position,
+                              bool up)
+{
     QVector3D pos, size;
-    getPosSize(pos, size, squareSize, position);
+    getPosSize(pos, size, squareSize, position, up);
 
     QVector3D vecA = Lands::verticesQuad[0] * size + pos,
               vecC = Lands::verticesQuad[2] * size + pos;
@@ -91,10 +104,18 @@ float LandDatas::intersection(int squareSize, QRay3D& ray, Position& position) {
 
 void LandDatas::getPosSize(QVector3D& pos, QVector3D& size, int squareSize,
                            Position &position)
+{
+    getPosSize(pos, size, squareSize, position, m_up);
+}
+
+// -------------------------------------------------------
+
+void LandDatas::getPosSize(QVector3D& pos, QVector3D& size, int squareSize,
+                           Position &position, bool up)
 {
     // Position
     float yLayerOffset = position.layer() * 0.05f;
-    if (!m_up)
+    if (!up)
         yLayerOffset *= -1;
     float yPosition = position.getY(squareSize) + yLayerOffset;
     pos.setX(position.x() * squareSize);
@@ -120,16 +141,16 @@ void LandDatas::read(const QJsonObject &json){
         m_up = json[JSON_UP].toBool();
 
     QJsonArray tab = json[JSON_TEXTURE].toArray();
-    m_textureRect->setLeft(tab[0].toInt());
-    m_textureRect->setTop(tab[1].toInt());
+    m_textureRect.setLeft(tab[0].toInt());
+    m_textureRect.setTop(tab[1].toInt());
 
     if (tab.size() > 2) {
-        m_textureRect->setWidth(tab[2].toInt());
-        m_textureRect->setHeight(tab[3].toInt());
+        m_textureRect.setWidth(tab[2].toInt());
+        m_textureRect.setHeight(tab[3].toInt());
     }
     else {
-        m_textureRect->setWidth(1);
-        m_textureRect->setHeight(1);
+        m_textureRect.setWidth(1);
+        m_textureRect.setHeight(1);
     }
 }
 
@@ -142,11 +163,34 @@ void LandDatas::write(QJsonObject &json) const{
         json[JSON_UP] = m_up;
 
     QJsonArray tab;
-    tab.append(m_textureRect->left());
-    tab.append(m_textureRect->top());
-    if (m_textureRect->width() != 1 || m_textureRect->height() != 1) {
-        tab.append(m_textureRect->width());
-        tab.append(m_textureRect->height());
+    tab.append(m_textureRect.left());
+    tab.append(m_textureRect.top());
+    if (m_textureRect.width() != 1 || m_textureRect.height() != 1) {
+        tab.append(m_textureRect.width());
+        tab.append(m_textureRect.height());
     }
     json[JSON_TEXTURE] = tab;
 }
+
+// -------------------------------------------------------
+
+void LandDatas::readBinary(QDataStream& stream){
+    qint16 x, y, width, height;
+
+    MapElement::readBinary(stream);
+    stream >> m_up >> x >> y >> width >> height;
+    m_textureRect.setLeft(x);
+    m_textureRect.setTop(y);
+    m_textureRect.setWidth(width);
+    m_textureRect.setHeight(height);
+}
+
+// -------------------------------------------------------
+
+void LandDatas::writeBinary(QDataStream& stream) const{
+    MapElement::writeBinary(stream);
+    stream << m_up << static_cast<qint16>(m_textureRect.left())
+           << static_cast<qint16>(m_textureRect.top())
+           << static_cast<qint16>(m_textureRect.width())
+           << static_cast<qint16>(m_textureRect.height());
+}
@@ -33,23 +33,31 @@ public:
     virtual ~LandDatas();
     bool operator==(const LandDatas& other) const;
     bool operator!=(const LandDatas& other) const;
-    QRect* textureRect() const;
+    QRect* textureRect();
+    bool up() const;
+    void setUp(bool up);
     virtual MapEditorSubSelectionKind getSubKind() const;
 
     virtual void initializeVertices(int, int, int, QVector<Vertex>&,
                                     QVector<GLuint>&, Position&, int&);
     void getPosSize(QVector3D& pos, QVector3D& size, int squareSize,
                     Position &position);
+    static void getPosSize(QVector3D& pos, QVector3D& size, int squareSize,
+                           Position &position, bool up);
     float intersection(int squareSize, QRay3D& ray, Position& position);
+    static float intersection(int squareSize, QRay3D& ray, Position& position,
+                              bool up);
 
     static const QString JSON_UP;
     static const QString JSON_TEXTURE;
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    virtual void readBinary(QDataStream& stream);
+    virtual void writeBinary(QDataStream& stream) const;
 
 protected:
-    QRect* m_textureRect;
+    QRect m_textureRect;
     bool m_up;
 };
 
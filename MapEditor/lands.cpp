@@ -64,6 +64,43 @@ bool Lands::isEmpty() const {
 
 // -------------------------------------------------------
 
+int Lands::count() const {
+    return m_floors->count() + m_autotiles->count();
+}
+
+// -------------------------------------------------------
+
+bool Lands::contains(Position& p) const {
+    return m_floors->contains(p) || m_autotiles->contains(p);
+}
+
+// -------------------------------------------------------
+
+MapEditorSubSelectionKind Lands::getLandKind(Position& p,
+                                             QRect& texture) const
+{
+    int autotileID;
+
+    if (m_floors->getTexture(p, texture))
+        return MapEditorSubSelectionKind::Floors;
+    if (m_autotiles->getTexture(p, autotileID, texture))
+        return MapEditorSubSelectionKind::Autotiles;
+
+    return MapEditorSubSelectionKind::None;
+}
+
+// -------------------------------------------------------
+
+bool Lands::getAutotileTexture(Position& p, int& autotileID,
+                               QRect& texture) const
+{
+    return m_autotiles->getTexture(p, autotileID, texture);
+}
+
+// -------------------------------------------------------
+
+// A copy of the land, owned by the caller
+
 LandDatas* Lands::getLand(Position& p) const {
     LandDatas* land = m_floors->getFloor(p);
 
@@ -80,10 +117,10 @@ LandDatas* Lands::getLand(Position& p) const {
 void Lands::setLand(Position& p, LandDatas* land) {
     switch (land->getSubKind()) {
     case MapEditorSubSelectionKind::Floors:
-        m_floors->setFloor(p, (FloorDatas*) land);
+        m_floors->setFloor(p, *((FloorDatas*) land));
         break;
     case MapEditorSubSelectionKind::Autotiles:
-        m_autotiles->setAutotile(p, (AutotileDatas*) land);
+        m_autotiles->setAutotile(p, *((AutotileDatas*) land));
         break;
     default:
         break;
@@ -105,9 +142,11 @@ LandDatas* Lands::removeLand(Position& p) {
 
 // -------------------------------------------------------
 
+// The land is copied in the arrays, the caller still owns it
 bool Lands::addLand(Position& p, LandDatas* land, QJsonObject &previous,
                     MapEditorSubSelectionKind &previousType,
-                    QSet<MapPortion*>& update, QSet<MapPortion*>& save)
+                    QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                    bool updateAutotiles)
 {
     LandDatas* previousLand = removeLand(p);
     bool changed = true;
@@ -121,7 +160,8 @@ bool Lands::addLand(Position& p, LandDatas* land, QJsonObject &previous,
     }
 
     setLand(p, land);
-    m_autotiles->updateWithoutPreview(p, update, save);
+    if (updateAutotiles)
+        m_autotiles->updateWithoutPreview(p, update, save);
 
     return changed;
 }
@@ -131,8 +171,9 @@ bool Lands::addLand(Position& p, LandDatas* land, QJsonObject &previous,
 bool Lands::deleteLand(Position& p, QList<QJsonObject> &previous,
                        QList<MapEditorSubSelectionKind> &previousType,
                        QList<Position>& positions, QSet<MapPortion *> &update,
-                       QSet<MapPortion *> &save, bool removeLayers)
-{ 
+                       QSet<MapPortion *> &save, bool removeLayers,
+                       bool updateAutotiles)
+{
     QJsonObject prev;
     MapEditorSubSelectionKind kind = MapEditorSubSelectionKind::None;
     LandDatas* previousLand = removeLand(p);
@@ -146,7 +187,8 @@ bool Lands::deleteLand(Position& p, QList<QJsonObject> &previous,
         delete previousLand;
     }
 
-    m_autotiles->updateWithoutPreview(p, update, save);
+    if (updateAutotiles)
+        m_autotiles->updateWithoutPreview(p, update, save);
 
     if (changed) {
         previous.append(prev);
@@ -154,7 +196,7 @@ bool Lands::deleteLand(Position& p, QList<QJsonObject> &previous,
         positions.append(p);
         if (removeLayers)
             updateRemoveLayer(p, previous, previousType, positions, update,
-                              save);
+                              save, updateAutotiles);
     }
 
     return changed;
@@ -162,6 +204,18 @@ bool Lands::deleteLand(Position& p, QList<QJsonObject> &previous,
 
 // -------------------------------------------------------
 
+bool Lands::updateAutotile(Position& position, Portion& portion) {
+    return m_autotiles->updateAutotile(position, portion);
+}
+
+// -------------------------------------------------------
+
+bool Lands::updateAutotileTileID(Position& position, int neighboursMask) {
+    return m_autotiles->updateTileID(position, neighboursMask);
+}
+
+// -------------------------------------------------------
+
 void Lands::removeLandOut(MapProperties& properties) {
     m_floors->removeFloorOut(properties);
     m_autotiles->removeAutotileOut(properties);
@@ -177,12 +231,19 @@ MapElement* Lands::updateRaycasting(int squareSize, float& finalDistance,
                                               finalPosition, ray);
     elementAutotile = m_autotiles->updateRaycasting(squareSize, finalDistance,
                                                     finalPosition, ray);
+    if (elementAutotile == nullptr)
+        return elementFloor;
+
+    // The floor copy is hidden by the autotile
+    delete elementFloor;
 
-    return elementAutotile == nullptr ? elementFloor : elementAutotile;
+    return elementAutotile;
 }
 
 // -------------------------------------------------------
 
+// A copy of the element, owned by the caller
+
 MapElement* Lands::getMapElementAt(Position& position,
                                    MapEditorSubSelectionKind subKind)
 {
@@ -203,12 +264,10 @@ int Lands::getLastLayerAt(Position& position) const
     int count = position.layer() + 1;
     Position p(position.x(), position.y(), position.yPlus(), position.z(),
                count);
-    LandDatas* land = getLand(p);
 
-    while (land != nullptr) {
+    while (contains(p)) {
         count++;
         p.setLayer(count);
-        land = getLand(p);
     }
 
     return count - 1;
@@ -219,17 +278,17 @@ int Lands::getLastLayerAt(Position& position) const
 void Lands::updateRemoveLayer(Position& position, QList<QJsonObject> &previous,
                              QList<MapEditorSubSelectionKind> &previousType,
                              QList<Position> &positions,
-                             QSet<MapPortion*>& update, QSet<MapPortion*>& save)
+                             QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                             bool updateAutotiles)
 {
     int i = position.layer() + 1;
     Position p(position.x(), position.y(), position.yPlus(),
                position.z(), i);
-    LandDatas* land = getLand(p);
 
-    while (land != nullptr) {
-        deleteLand(p, previous, previousType, positions, update, save, false);
+    while (contains(p)) {
+        deleteLand(p, previous, previousType, positions, update, save, false,
+                   updateAutotiles);
         p.setLayer(++i);
-        land = getLand(p);
     }
 }
 
@@ -240,9 +299,7 @@ void Lands::updateAutotiles(Position& position,
                             QSet<MapPortion*> &update, QSet<MapPortion*> &save,
                             QSet<MapPortion *> &previousPreview)
 {
-    QHash<Position, AutotileDatas*> autotilesWithPreview;
-    m_autotiles->getAutotilesWithPreview(autotilesWithPreview, preview);
-    m_autotiles->updateAround(position, autotilesWithPreview, update, save,
+    m_autotiles->updateAround(position, update, save, &preview,
                               &previousPreview);
 }
 
@@ -253,12 +310,24 @@ void Lands::updateAutotiles(Position& position,
 // -------------------------------------------------------
 
 void Lands::initializeVertices(QList<TextureAutotile*> &texturesAutotiles,
-                               QHash<Position, MapElement *> &previewSquares,
                                int squareSize, int width, int height)
 {
-    m_floors->initializeVertices(previewSquares, squareSize, width, height);
-    m_autotiles->initializeVertices(texturesAutotiles, previewSquares,
-                                    squareSize);
+    initializeVerticesFloors(squareSize, width, height);
+    initializeVerticesAutotiles(texturesAutotiles, squareSize);
+}
+
+// -------------------------------------------------------
+
+void Lands::initializeVerticesFloors(int squareSize, int width, int height) {
+    m_floors->initializeVertices(squareSize, width, height);
+}
+
+// -------------------------------------------------------
+
+void Lands::initializeVerticesAutotiles(
+        QList<TextureAutotile*> &texturesAutotiles, int squareSize)
+{
+    m_autotiles->initializeVertices(texturesAutotiles, squareSize);
 }
 
 // -------------------------------------------------------
@@ -271,20 +340,41 @@ void Lands::initializeGL(QOpenGLShaderProgram *programStatic){
 // -------------------------------------------------------
 
 void Lands::updateGL(){
+    updateGLFloors();
+    updateGLAutotiles();
+}
+
+// -------------------------------------------------------
+
+void Lands::updateGLFloors(){
     m_floors->updateGL();
+}
+
+// -------------------------------------------------------
+
+void Lands::updateGLAutotiles(){
     m_autotiles->updateGL();
 }
 
 // -------------------------------------------------------
 
-void Lands::paintGL(){
-    m_floors->paintGL();
+void Lands::addToRenderList(MapRenderList& renderList,
+                            MapPortion* mapPortion)
+{
+    m_floors->addToRenderList(renderList, mapPortion);
+    m_autotiles->addToRenderList(renderList, mapPortion);
+}
+
+// -------------------------------------------------------
+
+void Lands::paintGL(const QSet<Position>& hidden){
+    m_floors->paintGL(hidden);
 }
 
 // -------------------------------------------------------
 
-void Lands::paintAutotilesGL(int textureID) {
-    m_autotiles->paintGL(textureID);
+void Lands::paintAutotilesGL(int textureID, const QSet<Position>& hidden) {
+    m_autotiles->paintGL(textureID, hidden);
 }
 
 // -------------------------------------------------------
@@ -304,3 +394,17 @@ void Lands::write(QJsonObject & json) const{
     m_floors->write(json);
     m_autotiles->write(json);
 }
+
+// -------------------------------------------------------
+
+void Lands::readBinary(QDataStream& stream){
+    m_floors->readBinary(stream);
+    m_autotiles->readBinary(stream);
+}
+
+// -------------------------------------------------------
+
+void Lands::writeBinary(QDataStream& stream) const{
+    m_floors->writeBinary(stream);
+    m_autotiles->writeBinary(stream);
+}
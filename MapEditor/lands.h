@@ -37,16 +37,25 @@ public:
     static int nbIndexesQuad;
 
     bool isEmpty() const;
+    int count() const;
+    bool contains(Position& p) const;
+    MapEditorSubSelectionKind getLandKind(Position& p, QRect& texture) const;
+    bool getAutotileTexture(Position& p, int& autotileID,
+                            QRect& texture) const;
     LandDatas* getLand(Position& p) const;
     void setLand(Position& p, LandDatas* land);
     LandDatas* removeLand(Position& p);
     bool addLand(Position& p, LandDatas* land, QJsonObject& previous,
                  MapEditorSubSelectionKind& previousType,
-                 QSet<MapPortion *> &update, QSet<MapPortion *> &save);
+                 QSet<MapPortion *> &update, QSet<MapPortion *> &save,
+                 bool updateAutotiles = true);
     bool deleteLand(Position& p, QList<QJsonObject> &previous,
                     QList<MapEditorSubSelectionKind> &previousType,
                     QList<Position> &positions, QSet<MapPortion *> &update,
-                    QSet<MapPortion *> &save, bool removeLayers = true);
+                    QSet<MapPortion *> &save, bool removeLayers = true,
+                    bool updateAutotiles = true);
+    bool updateAutotile(Position& position, Portion& portion);
+    bool updateAutotileTileID(Position& position, int neighboursMask);
     void removeLandOut(MapProperties& properties);
     MapElement *updateRaycasting(int squareSize, float& finalDistance,
                                  Position &finalPosition, QRay3D &ray);
@@ -56,22 +65,30 @@ public:
     void updateRemoveLayer(Position& position, QList<QJsonObject> &previous,
                            QList<MapEditorSubSelectionKind> &previousType,
                            QList<Position> &positions,
-                           QSet<MapPortion*>& update, QSet<MapPortion*>& save);
+                           QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                           bool updateAutotiles);
     void updateAutotiles(Position& position,
                          QHash<Position, MapElement *> &preview,
                          QSet<MapPortion*> &update, QSet<MapPortion*> &save,
                          QSet<MapPortion*> &previousPreview);
 
     void initializeVertices(QList<TextureAutotile *> &texturesAutotiles,
-                            QHash<Position, MapElement*>& previewSquares,
                             int squareSize, int width, int height);
+    void initializeVerticesFloors(int squareSize, int width, int height);
+    void initializeVerticesAutotiles(
+            QList<TextureAutotile *> &texturesAutotiles, int squareSize);
     void initializeGL(QOpenGLShaderProgram* programStatic);
     void updateGL();
-    void paintGL();
-    void paintAutotilesGL(int textureID);
+    void updateGLFloors();
+    void updateGLAutotiles();
+    void addToRenderList(MapRenderList& renderList, MapPortion* mapPortion);
+    void paintGL(const QSet<Position>& hidden);
+    void paintAutotilesGL(int textureID, const QSet<Position>& hidden);
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 protected:
     Floors* m_floors;
@@ -0,0 +1,143 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "landsgrid.h"
+#include "wanok.h"
+
+// Layers of lands indexed in the dense grid, the upper ones use the hash
+const int LandsGrid::DENSE_LAYERS = 8;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+LandsGrid::LandsGrid()
+{
+
+}
+
+LandsGrid::~LandsGrid()
+{
+
+}
+
+bool LandsGrid::isEmpty() const { return m_positions.isEmpty(); }
+
+int LandsGrid::count() const { return m_positions.size(); }
+
+const Position& LandsGrid::positionAt(int index) const {
+    return m_positions.at(index);
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+int LandsGrid::indexOf(const Position& p) const {
+    int cell = cellIndex(p);
+    if (cell != -1 && cell < m_grid.size()) {
+        int index = m_grid.at(cell);
+        if (index != -1 && m_positions.at(index) == p)
+            return index;
+    }
+
+    return m_others.value(p, -1);
+}
+
+// -------------------------------------------------------
+
+int LandsGrid::add(const Position& p) {
+    int index = m_positions.size();
+    m_positions.append(p);
+    setIndex(p, index);
+    m_levels.add(p);
+
+    return index;
+}
+
+// -------------------------------------------------------
+
+void LandsGrid::removeAt(int index) {
+    int last = m_positions.size() - 1;
+    setIndex(m_positions.at(index), -1);
+    m_levels.remove(m_positions.at(index));
+
+    // Move the last land in the removed one
+    if (index != last) {
+        m_positions[index] = m_positions.at(last);
+        setIndex(m_positions.at(index), index);
+    }
+    m_positions.removeLast();
+}
+
+// -------------------------------------------------------
+
+void LandsGrid::getPositions(QRay3D& ray, int squareSize,
+                             QList<Position>& positions) const
+{
+    m_levels.getPositions(ray, squareSize, positions);
+}
+
+// -------------------------------------------------------
+
+int LandsGrid::cellIndex(const Position& p) const {
+    int size = Wanok::portionSize;
+
+    if (p.y() != 0 || p.yPlus() != 0 || p.layer() < 0 ||
+        p.layer() >= DENSE_LAYERS || p.x() < 0 || p.z() < 0 ||
+        p.centerX() != 50 || p.centerZ() != 50 || p.angle() != 0)
+    {
+        return -1;
+    }
+
+    return ((p.layer() * size) + (p.z() % size)) * size + (p.x() % size);
+}
+
+// -------------------------------------------------------
+
+void LandsGrid::setIndex(const Position& p, int index) {
+    int cell = cellIndex(p);
+
+    // Grow the grid by layers
+    if (cell >= m_grid.size() && index != -1) {
+        int size = Wanok::portionSize;
+        int previousSize = m_grid.size();
+        m_grid.resize(((cell / (size * size)) + 1) * size * size);
+        for (int i = previousSize; i < m_grid.size(); i++)
+            m_grid[i] = -1;
+    }
+
+    // The cell can be used by a land with the same local coordinates
+    if (cell != -1 && cell < m_grid.size()) {
+        int current = m_grid.at(cell);
+        if (current == -1 || m_positions.at(current) == p) {
+            m_grid[cell] = index;
+            return;
+        }
+    }
+
+    if (index == -1)
+        m_others.remove(p);
+    else
+        m_others.insert(p, index);
+}
@@ -0,0 +1,64 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LANDSGRID_H
+#define LANDSGRID_H
+
+#include <QHash>
+#include <QVector>
+#include "raycastinglevels.h"
+
+// -------------------------------------------------------
+//
+//  CLASS LandsGrid
+//
+//  The positions of the lands of one kind in a portion, giving each one an
+//  index in the arrays of its datas. The squares on the ground are indexed
+//  by a dense (x, z, layer) grid of the portion, the others by a hash.
+//  Removing a land moves the last one in its index: the arrays of the datas
+//  have to do the same.
+//
+// -------------------------------------------------------
+
+class LandsGrid
+{
+public:
+    LandsGrid();
+    virtual ~LandsGrid();
+    static const int DENSE_LAYERS;
+    bool isEmpty() const;
+    int count() const;
+    const Position& positionAt(int index) const;
+    int indexOf(const Position& p) const;
+    int add(const Position& p);
+    void removeAt(int index);
+    void getPositions(QRay3D& ray, int squareSize,
+                      QList<Position>& positions) const;
+
+protected:
+    QVector<Position> m_positions;
+    QVector<int> m_grid;
+    QHash<Position, int> m_others;
+    RaycastingLevels m_levels;
+
+    int cellIndex(const Position& p) const;
+    void setIndex(const Position& p, int index);
+};
+
+#endif // LANDSGRID_H
@@ -0,0 +1,347 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mapeditjournal.h"
+#include <QSaveFile>
+#ifdef Q_OS_WIN
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+const QString MapEditJournal::FILE_NAME = "portions.journal";
+
+// Header of the journal file ("RPMJ" + format version)
+const quint32 MapEditJournal::MAGIC = 0x52504D4A;
+const quint16 MapEditJournal::VERSION = 1;
+
+// Sizes in the file of the header and of a record header
+static const int HEADER_SIZE = 4 + 2;
+static const int RECORD_HEADER_SIZE = 3 * 4 + 4 + 2;
+
+// The journal is compacted when the outdated records are this much bigger
+// than the live ones (and at least COMPACT_MIN_SIZE bytes)
+static const int COMPACT_RATIO = 4;
+static const qint64 COMPACT_MIN_SIZE = 4 * 1024 * 1024;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapEditJournal::MapEditJournal() :
+    m_sizeLive(0)
+{
+
+}
+
+MapEditJournal::~MapEditJournal()
+{
+    close();
+}
+
+bool MapEditJournal::isOpen() const { return m_file.isOpen(); }
+
+int MapEditJournal::count() const {
+    QMutexLocker locker(&m_mutex);
+
+    return m_index.size();
+}
+
+QList<Portion> MapEditJournal::portions() const {
+    QMutexLocker locker(&m_mutex);
+
+    return m_index.keys();
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+bool MapEditJournal::open(QString path) {
+    QMutexLocker locker(&m_mutex);
+
+    return openLocked(path);
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::openLocked(QString path) {
+    m_file.close();
+    m_index.clear();
+    m_sizeLive = 0;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite))
+        return false;
+
+    // Header (a new or unknown file is started again)
+    QDataStream stream(&m_file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    if (m_file.size() >= HEADER_SIZE)
+        stream >> magic >> version;
+    if (magic != MAGIC || version > VERSION)
+        return writeHeader();
+
+    // Replay: only the last record of each portion is kept
+    qint64 size = m_file.size();
+    qint64 position = HEADER_SIZE;
+    while (position + RECORD_HEADER_SIZE <= size) {
+        qint32 x, y, z;
+        quint32 sizeDatas;
+        quint16 checksum;
+        stream >> x >> y >> z >> sizeDatas >> checksum;
+        qint64 offset = position + RECORD_HEADER_SIZE;
+        if (offset + sizeDatas > size)
+            break;
+        QByteArray datas = m_file.read(sizeDatas);
+        if (qChecksum(datas.constData(), datas.size()) != checksum)
+            break;
+
+        Portion portion(x, y, z);
+        QHash<Portion, QPair<qint64, quint32>>::iterator i =
+                m_index.find(portion);
+        if (i != m_index.end())
+            m_sizeLive -= i->second;
+        m_index.insert(portion, QPair<qint64, quint32>(offset, sizeDatas));
+        m_sizeLive += sizeDatas;
+        position = offset + sizeDatas;
+    }
+
+    // A record torn by a crash is dropped
+    if (position < size)
+        m_file.resize(position);
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+void MapEditJournal::close() {
+    QMutexLocker locker(&m_mutex);
+    m_file.close();
+    m_index.clear();
+    m_sizeLive = 0;
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::remove() {
+    close();
+
+    return !m_file.exists() || m_file.remove();
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::contains(Portion& portion) const {
+    QMutexLocker locker(&m_mutex);
+
+    return m_index.contains(portion);
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::isPortionEmpty(Portion& portion) const {
+    QMutexLocker locker(&m_mutex);
+
+    return m_index.value(portion).second == 0;
+}
+
+// -------------------------------------------------------
+
+QByteArray MapEditJournal::portionDatas(Portion& portion) {
+    QMutexLocker locker(&m_mutex);
+    QHash<Portion, QPair<qint64, quint32>>::const_iterator i =
+            m_index.find(portion);
+    if (i == m_index.end())
+        return QByteArray();
+
+    return readDatas(i->first, i->second);
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::readPortion(MapPortion& mapPortion) {
+    Portion portion;
+    mapPortion.getGlobalPortion(portion);
+
+    m_mutex.lock();
+    QHash<Portion, QPair<qint64, quint32>>::const_iterator i =
+            m_index.find(portion);
+    bool found = i != m_index.end();
+    quint32 size = found ? i->second : 0;
+    QByteArray datas = found ? readDatas(i->first, size) : QByteArray();
+    m_mutex.unlock();
+
+    // A missing or partially read record is not an empty portion
+    if (!found || static_cast<quint32>(datas.size()) != size)
+        return false;
+
+    // An empty record is an empty portion
+    if (datas.isEmpty())
+        return true;
+    QDataStream stream(datas);
+
+    return mapPortion.readBinary(stream);
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::append(MapPortion& mapPortion) {
+    Portion portion;
+    mapPortion.getGlobalPortion(portion);
+    QByteArray datas;
+    if (!mapPortion.isEmpty()) {
+        QDataStream stream(&datas, QIODevice::WriteOnly);
+        mapPortion.writeBinary(stream);
+    }
+    QByteArray record = createRecord(portion, datas);
+
+    m_mutex.lock();
+    if (!m_file.isOpen()) {
+        m_mutex.unlock();
+        return false;
+    }
+
+    // A partially written record is removed so that the next ones can still
+    // be replayed
+    qint64 position = m_file.size();
+    if (!m_file.seek(position) ||
+        m_file.write(record) != record.size() || !sync())
+    {
+        m_file.resize(position);
+        m_mutex.unlock();
+        return false;
+    }
+    QHash<Portion, QPair<qint64, quint32>>::iterator i = m_index.find(portion);
+    if (i != m_index.end())
+        m_sizeLive -= i->second;
+    m_index.insert(portion, QPair<qint64, quint32>(
+                       position + RECORD_HEADER_SIZE, datas.size()));
+    m_sizeLive += datas.size();
+    qint64 sizeLive = m_sizeLive;
+    qint64 sizeOutdated = m_file.size() - sizeLive - HEADER_SIZE -
+            m_index.size() * RECORD_HEADER_SIZE;
+    m_mutex.unlock();
+
+    if (sizeOutdated > COMPACT_MIN_SIZE &&
+        sizeOutdated > COMPACT_RATIO * sizeLive)
+    {
+        compact();
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::compact() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_file.isOpen())
+        return false;
+
+    // Only the last records are kept
+    QHash<Portion, QByteArray> records;
+    QHash<Portion, QPair<qint64, quint32>>::const_iterator i;
+    for (i = m_index.begin(); i != m_index.end(); i++)
+        records.insert(i.key(), readDatas(i->first, i->second));
+
+    // The journal is replaced at once, it can't stay opened meanwhile
+    QString path = m_file.fileName();
+    m_file.close();
+    QSaveFile file(path);
+    bool compacted = file.open(QIODevice::WriteOnly);
+    if (compacted) {
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << MAGIC << VERSION;
+        QHash<Portion, QByteArray>::const_iterator j;
+        for (j = records.begin(); j != records.end(); j++) {
+            QByteArray record = createRecord(j.key(), j.value());
+            stream.writeRawData(record.constData(), record.size());
+        }
+        compacted = stream.status() == QDataStream::Ok && file.commit();
+    }
+
+    // The offsets are the ones of the file that is now on disk. The lock is
+    // kept so that no reader sees the journal closed or not indexed yet
+    bool opened = openLocked(path);
+
+    return compacted && opened;
+}
+
+// -------------------------------------------------------
+
+bool MapEditJournal::writeHeader() {
+    QDataStream stream(&m_file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    m_file.resize(0);
+    m_file.seek(0);
+    stream << MAGIC << VERSION;
+
+    return stream.status() == QDataStream::Ok && sync();
+}
+
+// -------------------------------------------------------
+
+// Flush the journal and wait for it to be on the disk, so that an edit is
+// still there after a power loss
+
+bool MapEditJournal::sync() {
+    if (!m_file.flush())
+        return false;
+
+    #ifdef Q_OS_WIN
+        return _commit(m_file.handle()) == 0;
+    #else
+        return fsync(m_file.handle()) == 0;
+    #endif
+}
+
+// -------------------------------------------------------
+
+QByteArray MapEditJournal::readDatas(qint64 offset, quint32 size) {
+    if (size == 0 || !m_file.seek(offset))
+        return QByteArray();
+
+    return m_file.read(size);
+}
+
+// -------------------------------------------------------
+
+QByteArray MapEditJournal::createRecord(const Portion& portion,
+                                        const QByteArray& datas)
+{
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << static_cast<qint32>(portion.x())
+           << static_cast<qint32>(portion.y())
+           << static_cast<qint32>(portion.z())
+           << static_cast<quint32>(datas.size())
+           << qChecksum(datas.constData(), datas.size());
+    stream.writeRawData(datas.constData(), datas.size());
+
+    return record;
+}
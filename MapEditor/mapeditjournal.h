@@ -0,0 +1,75 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPEDITJOURNAL_H
+#define MAPEDITJOURNAL_H
+
+#include <QFile>
+#include <QMutex>
+#include "mapportion.h"
+
+// -------------------------------------------------------
+//
+//  CLASS MapEditJournal
+//
+//  The unsaved edits of a map, appended to a single file of the temp folder.
+//  Each record is the binary datas of an edited portion (nothing for an empty
+//  one) with a checksum. The last record of a portion hides the older ones
+//  and the saved files. Each record is synced to the disk before the edit
+//  is taken as saved. Opening the journal replays it and drops a record torn
+//  by a crash. Reading and appending can be done from several threads.
+//
+// -------------------------------------------------------
+
+class MapEditJournal
+{
+public:
+    MapEditJournal();
+    virtual ~MapEditJournal();
+    static const QString FILE_NAME;
+    static const quint32 MAGIC;
+    static const quint16 VERSION;
+    bool isOpen() const;
+    int count() const;
+    QList<Portion> portions() const;
+    bool open(QString path);
+    void close();
+    bool remove();
+    bool contains(Portion& portion) const;
+    bool isPortionEmpty(Portion& portion) const;
+    QByteArray portionDatas(Portion& portion);
+    bool readPortion(MapPortion& mapPortion);
+    bool append(MapPortion& mapPortion);
+    bool compact();
+
+protected:
+    QFile m_file;
+    mutable QMutex m_mutex;
+    QHash<Portion, QPair<qint64, quint32>> m_index;
+    qint64 m_sizeLive;
+
+    bool openLocked(QString path);
+    bool writeHeader();
+    bool sync();
+    QByteArray readDatas(qint64 offset, quint32 size);
+    static QByteArray createRecord(const Portion& portion,
+                                   const QByteArray& datas);
+};
+
+#endif // MAPEDITJOURNAL_H
@@ -52,6 +52,12 @@ bool MapElement::operator!=(const MapElement& other) const{
     return !operator==(other);
 }
 
+int MapElement::xOffset() const { return m_xOffset; }
+
+int MapElement::yOffset() const { return m_yOffset; }
+
+int MapElement::zOffset() const { return m_zOffset; }
+
 void MapElement::setXOffset(int x) {
     m_xOffset = x;
 }
@@ -134,3 +140,21 @@ void MapElement::write(QJsonObject &json) const{
     if (m_zOffset != 0)
         json[MapElement::jsonZ] = m_zOffset;
 }
+
+// -------------------------------------------------------
+
+void MapElement::readBinary(QDataStream& stream){
+    qint32 xOffset, yOffset, zOffset;
+
+    stream >> xOffset >> yOffset >> zOffset;
+    m_xOffset = xOffset;
+    m_yOffset = yOffset;
+    m_zOffset = zOffset;
+}
+
+// -------------------------------------------------------
+
+void MapElement::writeBinary(QDataStream& stream) const{
+    stream << static_cast<qint32>(m_xOffset) << static_cast<qint32>(m_yOffset)
+           << static_cast<qint32>(m_zOffset);
+}
@@ -43,6 +43,9 @@ public:
     virtual ~MapElement();
     bool operator==(const MapElement& other) const;
     bool operator!=(const MapElement& other) const;
+    int xOffset() const;
+    int yOffset() const;
+    int zOffset() const;
     void setXOffset(int x);
     void setYOffset(int y);
     void setZOffset(int z);
@@ -61,6 +64,8 @@ public:
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    virtual void readBinary(QDataStream& stream);
+    virtual void writeBinary(QDataStream& stream) const;
 
 protected:
     int m_xOffset;
@@ -20,6 +20,7 @@
 #include "mapobjects.h"
 #include "wanok.h"
 #include "systemstate.h"
+#include <QJsonDocument>
 
 // -------------------------------------------------------
 //
@@ -28,8 +29,6 @@
 // -------------------------------------------------------
 
 MapObjects::MapObjects() :
-    m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
-    m_indexBuffer(QOpenGLBuffer::IndexBuffer),
     m_programStatic(nullptr)
 {
 
@@ -48,6 +47,10 @@ bool MapObjects::isEmpty() const{
     return m_all.empty();
 }
 
+int MapObjects::count() const {
+    return m_all.size();
+}
+
 // -------------------------------------------------------
 //
 //  INTERMEDIARY FUNCTIONS
@@ -140,20 +143,11 @@ void MapObjects::removeObjectsOut(QList<int> &listDeletedObjectsIDs,
 // -------------------------------------------------------
 
 void MapObjects::clearSprites(){
-    QHash<int, QList<SpriteObject*>*>::const_iterator i;
-    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++){
-        QList<SpriteObject*>* list = i.value();
-        for (int j = 0; j < list->size(); j++)
-            delete list->at(j);
-        delete list;
-    }
-    QHash<int, QList<SpriteObject*>*>::const_iterator j;
-    for (j = m_spritesFaceGL.begin(); j != m_spritesFaceGL.end(); j++){
-        QList<SpriteObject*>* list = j.value();
-        for (int i = 0; i < list->size(); i++)
-            delete list->at(i);
-        delete list;
-    }
+    QHash<int, SpriteObject*>::const_iterator i;
+    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++)
+        delete i.value();
+    for (i = m_spritesFaceGL.begin(); i != m_spritesFaceGL.end(); i++)
+        delete i.value();
 
     m_spritesStaticGL.clear();
     m_spritesFaceGL.clear();
@@ -162,7 +156,7 @@ void MapObjects::clearSprites(){
 // -------------------------------------------------------
 
 void MapObjects::initializeVertices(int squareSize,
-                                    QHash<int, QOpenGLTexture *> &characters)
+                                    const TextureAtlas& characters)
 {
     clearSprites();
     m_vertices.clear();
@@ -176,38 +170,38 @@ void MapObjects::initializeVertices(int squareSize,
         SystemCommonObject* o = i.value();
         SystemState* state = o->getFirstState();
 
-        // Draw the first state graphics of the object
-        if (state != nullptr) {
-            int graphicsId = state->graphicsId();
-            QOpenGLTexture* texture = characters[graphicsId];
-
-            // If texture ID doesn't exist, load empty texture
-            if (texture == nullptr){
-                graphicsId = -1;
-                texture = characters[graphicsId];
-            }
+        // If texture ID doesn't exist, load empty texture
+        int graphicsId = (state == nullptr) ? -1 : state->graphicsId();
+        if (!characters.contains(graphicsId))
+            graphicsId = -1;
 
+        // Draw the first state graphics of the object
+        if (state != nullptr && characters.contains(graphicsId)) {
             // Create the sprite geometry
             int frames = Wanok::get()->project()->gameDatas()->systemDatas()
                     ->framesAnimation();
-            int width = texture->width() / frames / squareSize;
-            int height = texture->height() / frames / squareSize;
+            QRect rect = characters.rect(graphicsId);
+            int width = rect.width() / frames / squareSize;
+            int height = rect.height() / frames / squareSize;
             SpriteDatas sprite(
                         state->graphicsKind(),
                         new QRect(state->indexX() * width,
                                   state->indexY() * height,
                                   width, height));
-            SpriteObject* spriteObject = new SpriteObject(sprite, texture);
-            spriteObject->initializeVertices(squareSize, position);
 
-            // Adding the sprite to the GL list
-            QHash<int, QList<SpriteObject*>*>& hash =
+            // Adding the sprite to the GL sprites of the same atlas page
+            QHash<int, SpriteObject*>& hash =
                     (state->graphicsKind() ==
                     MapEditorSubSelectionKind::SpritesFace) ? m_spritesFaceGL
                                                             : m_spritesStaticGL;
-            if (hash.value(graphicsId) == nullptr)
-               hash[graphicsId] = new QList<SpriteObject*>;
-            hash[graphicsId]->append(spriteObject);
+            int page = characters.page(graphicsId);
+            SpriteObject* spriteObject = hash.value(page);
+            if (spriteObject == nullptr) {
+                spriteObject = new SpriteObject;
+                hash[page] = spriteObject;
+            }
+            spriteObject->initializeVertices(sprite, squareSize, position,
+                                             characters, graphicsId);
         }
 
         // Draw the square of the object
@@ -236,18 +230,11 @@ void MapObjects::initializeVertices(int squareSize,
 void MapObjects::initializeGL(QOpenGLShaderProgram *programStatic,
                               QOpenGLShaderProgram *programFace)
 {
-    QHash<int, QList<SpriteObject*>*>::const_iterator i;
-    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++){
-        QList<SpriteObject*>* list = i.value();
-        for (int j = 0; j < list->size(); j++)
-            list->at(j)->initializeStaticGL(programStatic);
-    }
-    QHash<int, QList<SpriteObject*>*>::const_iterator j;
-    for (j = m_spritesFaceGL.begin(); j != m_spritesFaceGL.end(); j++){
-        QList<SpriteObject*>* list = j.value();
-        for (int i = 0; i < list->size(); i++)
-            list->at(i)->initializeFaceGL(programFace);
-    }
+    QHash<int, SpriteObject*>::const_iterator i;
+    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++)
+        i.value()->initializeStaticGL(programStatic);
+    for (i = m_spritesFaceGL.begin(); i != m_spritesFaceGL.end(); i++)
+        i.value()->initializeFaceGL(programFace);
 
     if (m_programStatic == nullptr){
         initializeOpenGLFunctions();
@@ -262,55 +249,53 @@ void MapObjects::initializeGL(QOpenGLShaderProgram *programStatic,
 void MapObjects::updateGL(){
 
     // Objects
-    QHash<int, QList<SpriteObject*>*>::const_iterator i;
-    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++){
-        QList<SpriteObject*>* list = i.value();
-        for (int j = 0; j < list->size(); j++)
-            list->at(j)->updateStaticGL();
-    }
-    QHash<int, QList<SpriteObject*>*>::const_iterator j;
-    for (j = m_spritesFaceGL.begin(); j != m_spritesFaceGL.end(); j++){
-        QList<SpriteObject*>* list = j.value();
-        for (int i = 0; i < list->size(); i++)
-            list->at(i)->updateFaceGL();
-    }
+    QHash<int, SpriteObject*>::const_iterator i;
+    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++)
+        i.value()->updateStaticGL();
+    for (i = m_spritesFaceGL.begin(); i != m_spritesFaceGL.end(); i++)
+        i.value()->updateFaceGL();
 
     // Squares of objects
-    Map::updateGLStatic(m_vertexBuffer, m_indexBuffer, m_vertices, m_indexes,
+    Map::updateGLStatic(m_vertexRange, m_indexRange, m_vertices, m_indexes,
                         m_vao, m_programStatic);
 }
 
 // -------------------------------------------------------
 
-void MapObjects::paintStaticSprites(int textureID, QOpenGLTexture *texture){
-    QList<SpriteObject*>* list = m_spritesStaticGL.value(textureID);
-
-    if (list != nullptr){
-        texture->bind();
-        for (int i = 0; i < list->size(); i++)
-            list->at(i)->paintGL();
-        texture->release();
-    }
+void MapObjects::addToRenderList(MapRenderList& renderList,
+                                 MapPortion* mapPortion)
+{
+    QHash<int, SpriteObject*>::const_iterator i;
+    for (i = m_spritesStaticGL.begin(); i != m_spritesStaticGL.end(); i++)
+        renderList.add(MapRenderKind::ObjectsStatic, mapPortion, i.key());
+    for (i = m_spritesFaceGL.begin(); i != m_spritesFaceGL.end(); i++)
+        renderList.add(MapRenderKind::ObjectsFace, mapPortion, i.key());
+    if (!m_indexes.isEmpty())
+        renderList.add(MapRenderKind::ObjectsSquares, mapPortion);
 }
 
 // -------------------------------------------------------
 
-void MapObjects::paintFaceSprites(int textureID, QOpenGLTexture* texture){
-    QList<SpriteObject*>* list = m_spritesFaceGL.value(textureID);
+void MapObjects::paintStaticSprites(int textureID){
+    SpriteObject* sprites = m_spritesStaticGL.value(textureID);
+    if (sprites != nullptr)
+        sprites->paintGL();
+}
 
-    if (list != nullptr){
-        texture->bind();
-        for (int i = 0; i < list->size(); i++)
-            list->at(i)->paintGL();
-        texture->release();
-    }
+// -------------------------------------------------------
+
+void MapObjects::paintFaceSprites(int textureID){
+    SpriteObject* sprites = m_spritesFaceGL.value(textureID);
+    if (sprites != nullptr)
+        sprites->paintGL();
 }
 
 // -------------------------------------------------------
 
 void MapObjects::paintSquares(){
     m_vao.bind();
-    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT,
+                   m_indexRange.indexesOffset());
     m_vao.release();
 }
 
@@ -351,3 +336,36 @@ void MapObjects::write(QJsonObject & json) const{
     }
     json["list"] = tab;
 }
+
+// -------------------------------------------------------
+
+void MapObjects::readBinary(QDataStream& stream){
+    qint32 count;
+
+    // The objects content (names, events, ...) is rare and variable, it is
+    // kept as compact JSON after its position
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++){
+        Position p;
+        QByteArray content;
+        p.readBinary(stream);
+        stream >> content;
+        SystemCommonObject* o = new SystemCommonObject;
+        o->read(QJsonDocument::fromJson(content).object());
+        m_all.insert(p, o);
+    }
+}
+
+// -------------------------------------------------------
+
+void MapObjects::writeBinary(QDataStream& stream) const{
+    stream << static_cast<qint32>(m_all.size());
+
+    QHash<Position, SystemCommonObject*>::const_iterator i;
+    for (i = m_all.begin(); i != m_all.end(); i++){
+        QJsonObject objValueObject;
+        i.key().writeBinary(stream);
+        i.value()->write(objValueObject);
+        stream << QJsonDocument(objValueObject).toJson(QJsonDocument::Compact);
+    }
+}
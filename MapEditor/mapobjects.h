@@ -24,7 +24,7 @@
 #include <QPair>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
-#include <QOpenGLBuffer>
+#include "glbufferarena.h"
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLTexture>
 #include "serializable.h"
@@ -32,6 +32,7 @@
 #include "systemcommonobject.h"
 #include "vertex.h"
 #include "sprites.h"
+#include "maprenderlist.h"
 
 // -------------------------------------------------------
 //
@@ -47,6 +48,7 @@ public:
     MapObjects();
     virtual ~MapObjects();
     bool isEmpty() const;
+    int count() const;
     SystemCommonObject* getObjectAt(Position& p) const;
     void setObject(Position& p, SystemCommonObject* object);
     SystemCommonObject* removeObject(Position& p);
@@ -61,25 +63,28 @@ public:
 
     void clearSprites();
     void initializeVertices(int squareSize,
-                            QHash<int, QOpenGLTexture *> &characters);
+                            const TextureAtlas& characters);
     void initializeGL(QOpenGLShaderProgram* programStatic,
                       QOpenGLShaderProgram *programFace);
     void updateGL();
-    void paintStaticSprites(int textureID, QOpenGLTexture* texture);
-    void paintFaceSprites(int textureID, QOpenGLTexture* texture);
+    void addToRenderList(MapRenderList& renderList, MapPortion* mapPortion);
+    void paintStaticSprites(int textureID);
+    void paintFaceSprites(int textureID);
     void paintSquares();
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 private:
     QHash<Position, SystemCommonObject*> m_all;
-    QHash<int, QList<SpriteObject*>*> m_spritesStaticGL;
-    QHash<int, QList<SpriteObject*>*> m_spritesFaceGL;
+    QHash<int, SpriteObject*> m_spritesStaticGL;
+    QHash<int, SpriteObject*> m_spritesFaceGL;
 
     // OpenGL informations
-    QOpenGLBuffer m_vertexBuffer;
-    QOpenGLBuffer m_indexBuffer;
+    GLBufferRange m_vertexRange;
+    GLBufferRange m_indexRange;
     QVector<Vertex> m_vertices;
     QVector<GLuint> m_indexes;
     QOpenGLVertexArrayObject m_vao;
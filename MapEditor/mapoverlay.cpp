@@ -0,0 +1,290 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mapoverlay.h"
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapOverlay::MapOverlay() :
+    m_countStatic(0),
+    m_countFace(0),
+    m_vertexBufferStatic(QOpenGLBuffer::VertexBuffer),
+    m_vertexBufferFace(QOpenGLBuffer::VertexBuffer),
+    m_indexBuffer(QOpenGLBuffer::IndexBuffer),
+    m_programStatic(nullptr),
+    m_programFace(nullptr)
+{
+
+}
+
+MapOverlay::~MapOverlay()
+{
+    if (m_vaoStatic.isCreated())
+        m_vaoStatic.destroy();
+    if (m_vaoFace.isCreated())
+        m_vaoFace.destroy();
+    if (m_vertexBufferStatic.isCreated())
+        m_vertexBufferStatic.destroy();
+    if (m_vertexBufferFace.isCreated())
+        m_vertexBufferFace.destroy();
+    if (m_indexBuffer.isCreated())
+        m_indexBuffer.destroy();
+}
+
+QList<int> MapOverlay::autotilesTextures() const {
+    return m_rangesAutotiles.keys();
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void MapOverlay::clearVertices() {
+    m_verticesStatic.clear();
+    m_indexesFloors.clear();
+    m_indexesAutotiles.clear();
+    m_indexesSprites.clear();
+    m_countStatic = 0;
+    m_verticesFace.clear();
+    m_indexesFace.clear();
+    m_countFace = 0;
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::addElements(QHash<Position, MapElement*>& preview,
+                             int squareSize, QOpenGLTexture* tileset,
+                             QList<TextureAutotile*>& texturesAutotiles)
+{
+    QHash<Position, MapElement*>::iterator i;
+    for (i = preview.begin(); i != preview.end(); i++) {
+        Position position = i.key();
+        MapElement* element = i.value();
+
+        switch (element->getSubKind()) {
+        case MapEditorSubSelectionKind::Floors:
+            ((FloorDatas*) element)->initializeVertices(
+                        squareSize, tileset->width(), tileset->height(),
+                        m_verticesStatic, m_indexesFloors, position,
+                        m_countStatic);
+            break;
+        case MapEditorSubSelectionKind::Autotiles:
+        {
+            AutotileDatas* autotile = (AutotileDatas*) element;
+            for (int j = 0; j < texturesAutotiles.size(); j++) {
+                TextureAutotile* texture = texturesAutotiles[j];
+                if (texture->isInTexture(autotile->autotileID(),
+                                         autotile->textureRect()))
+                {
+                    if (texture->texture() != nullptr) {
+                        autotile->initializeVertices(
+                                    texture, squareSize,
+                                    texture->texture()->width(),
+                                    texture->texture()->height(),
+                                    m_verticesStatic, m_indexesAutotiles[j],
+                                    position, m_countStatic);
+                    }
+                    break;
+                }
+            }
+            break;
+        }
+        case MapEditorSubSelectionKind::SpritesWall:
+
+            // Walls depend on their neighbours, they stay in the portions
+            break;
+        default:
+            if (element->getKind() == MapEditorSelectionKind::Sprites) {
+                ((SpriteDatas*) element)->initializeVertices(
+                            squareSize, tileset->width(), tileset->height(),
+                            m_verticesStatic, m_indexesSprites,
+                            m_verticesFace, m_indexesFace, position,
+                            m_countStatic, m_countFace);
+            }
+            break;
+        }
+    }
+}
+
+// -------------------------------------------------------
+//
+//  GL
+//
+// -------------------------------------------------------
+
+void MapOverlay::initializeGL(QOpenGLShaderProgram* programStatic,
+                              QOpenGLShaderProgram* programFace)
+{
+    if (m_programStatic != nullptr)
+        return;
+
+    initializeOpenGLFunctions();
+    m_programStatic = programStatic;
+    m_programFace = programFace;
+
+    // The buffers are allocated again at each update, the VAOs stay valid
+    m_vertexBufferStatic.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_vertexBufferStatic.create();
+    m_vertexBufferFace.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_vertexBufferFace.create();
+    m_indexBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_indexBuffer.create();
+
+    // Static VAO
+    m_programStatic->bind();
+    m_vaoStatic.create();
+    m_vaoStatic.bind();
+    m_vertexBufferStatic.bind();
+    m_programStatic->enableAttributeArray(0);
+    m_programStatic->enableAttributeArray(1);
+    m_programStatic->setAttributeBuffer(0, GL_FLOAT, Vertex::positionOffset(),
+                                        Vertex::positionTupleSize,
+                                        Vertex::stride());
+    m_programStatic->setAttributeBuffer(1, GL_FLOAT, Vertex::texOffset(),
+                                        Vertex::texCoupleSize,
+                                        Vertex::stride());
+    m_indexBuffer.bind();
+    m_vaoStatic.release();
+    m_vertexBufferStatic.release();
+    m_programStatic->release();
+
+    // Face VAO
+    m_programFace->bind();
+    m_vaoFace.create();
+    m_vaoFace.bind();
+    m_vertexBufferFace.bind();
+    m_programFace->enableAttributeArray(0);
+    m_programFace->enableAttributeArray(1);
+    m_programFace->enableAttributeArray(2);
+    m_programFace->enableAttributeArray(3);
+    m_programFace->setAttributeBuffer(0, GL_FLOAT,
+                                      VertexBillboard::positionOffset(),
+                                      VertexBillboard::positionTupleSize,
+                                      VertexBillboard::stride());
+    m_programFace->setAttributeBuffer(1, GL_FLOAT,
+                                      VertexBillboard::texOffset(),
+                                      VertexBillboard::texCoupleSize,
+                                      VertexBillboard::stride());
+    m_programFace->setAttributeBuffer(2, GL_FLOAT,
+                                      VertexBillboard::sizeOffset(),
+                                      VertexBillboard::sizeCoupleSize,
+                                      VertexBillboard::stride());
+    m_programFace->setAttributeBuffer(3, GL_FLOAT,
+                                      VertexBillboard::modelOffset(),
+                                      VertexBillboard::modelTupleSize,
+                                      VertexBillboard::stride());
+    m_indexBuffer.bind();
+    m_vaoFace.release();
+    m_vertexBufferFace.release();
+    m_indexBuffer.release();
+    m_programFace->release();
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::updateGL() {
+    if (m_programStatic == nullptr)
+        return;
+
+    // All the indexes in one buffer
+    QVector<GLuint> indexes;
+    appendIndexes(indexes, m_indexesFloors, m_rangeFloors);
+    appendIndexes(indexes, m_indexesSprites, m_rangeSprites);
+    appendIndexes(indexes, m_indexesFace, m_rangeFace);
+    m_rangesAutotiles.clear();
+    QHash<int, QVector<GLuint>>::const_iterator i;
+    for (i = m_indexesAutotiles.begin(); i != m_indexesAutotiles.end(); i++) {
+        QPair<int, int> range;
+        appendIndexes(indexes, i.value(), range);
+        if (range.second > 0)
+            m_rangesAutotiles.insert(i.key(), range);
+    }
+    if (indexes.isEmpty())
+        return;
+
+    m_vertexBufferStatic.bind();
+    m_vertexBufferStatic.allocate(m_verticesStatic.constData(),
+                                  m_verticesStatic.size() * sizeof(Vertex));
+    m_vertexBufferStatic.release();
+    m_vertexBufferFace.bind();
+    m_vertexBufferFace.allocate(m_verticesFace.constData(),
+                                m_verticesFace.size() *
+                                sizeof(VertexBillboard));
+    m_vertexBufferFace.release();
+    m_indexBuffer.bind();
+    m_indexBuffer.allocate(indexes.constData(),
+                           indexes.size() * sizeof(GLuint));
+    m_indexBuffer.release();
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::appendIndexes(QVector<GLuint>& indexes,
+                               const QVector<GLuint>& added,
+                               QPair<int, int>& range)
+{
+    range.first = indexes.size();
+    range.second = added.size();
+    indexes += added;
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::paintRange(QOpenGLVertexArrayObject& vao,
+                            const QPair<int, int>& range)
+{
+    if (range.second == 0)
+        return;
+
+    vao.bind();
+    glDrawElements(GL_TRIANGLES, range.second, GL_UNSIGNED_INT,
+                   reinterpret_cast<const GLvoid*>(range.first *
+                                                   sizeof(GLuint)));
+    vao.release();
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::paintFloors() {
+    paintRange(m_vaoStatic, m_rangeFloors);
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::paintAutotiles(int textureID) {
+    paintRange(m_vaoStatic, m_rangesAutotiles.value(textureID));
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::paintSprites() {
+    paintRange(m_vaoStatic, m_rangeSprites);
+}
+
+// -------------------------------------------------------
+
+void MapOverlay::paintFaceSprites() {
+    paintRange(m_vaoFace, m_rangeFace);
+}
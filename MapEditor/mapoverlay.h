@@ -0,0 +1,92 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPOVERLAY_H
+#define MAPOVERLAY_H
+
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLTexture>
+#include "floor.h"
+#include "autotile.h"
+#include "sprite.h"
+
+// -------------------------------------------------------
+//
+//  CLASS MapOverlay
+//
+//  The geometry of the previews of the cursor (lands and sprites), drawn over
+//  the map portions that hide the squares being previewed. It has its own
+//  small dynamic buffers, so that a preview never builds again the geometry
+//  of the portions.
+//
+// -------------------------------------------------------
+
+class MapOverlay : protected QOpenGLFunctions
+{
+public:
+    MapOverlay();
+    virtual ~MapOverlay();
+    QList<int> autotilesTextures() const;
+    void clearVertices();
+    void addElements(QHash<Position, MapElement*>& preview, int squareSize,
+                     QOpenGLTexture* tileset,
+                     QList<TextureAutotile*>& texturesAutotiles);
+    void initializeGL(QOpenGLShaderProgram* programStatic,
+                      QOpenGLShaderProgram* programFace);
+    void updateGL();
+    void paintFloors();
+    void paintAutotiles(int textureID);
+    void paintSprites();
+    void paintFaceSprites();
+
+protected:
+    // Floors, autotiles and static sprites share the static vertices
+    QVector<Vertex> m_verticesStatic;
+    QVector<GLuint> m_indexesFloors;
+    QHash<int, QVector<GLuint>> m_indexesAutotiles;
+    QVector<GLuint> m_indexesSprites;
+    int m_countStatic;
+    QVector<VertexBillboard> m_verticesFace;
+    QVector<GLuint> m_indexesFace;
+    int m_countFace;
+
+    // OpenGL, each draw being a range of the indexes buffer
+    QOpenGLBuffer m_vertexBufferStatic;
+    QOpenGLBuffer m_vertexBufferFace;
+    QOpenGLBuffer m_indexBuffer;
+    QOpenGLVertexArrayObject m_vaoStatic;
+    QOpenGLVertexArrayObject m_vaoFace;
+    QOpenGLShaderProgram* m_programStatic;
+    QOpenGLShaderProgram* m_programFace;
+    QPair<int, int> m_rangeFloors;
+    QHash<int, QPair<int, int>> m_rangesAutotiles;
+    QPair<int, int> m_rangeSprites;
+    QPair<int, int> m_rangeFace;
+
+    static void appendIndexes(QVector<GLuint>& indexes,
+                              const QVector<GLuint>& added,
+                              QPair<int, int>& range);
+    void paintRange(QOpenGLVertexArrayObject& vao,
+                    const QPair<int, int>& range);
+};
+
+#endif // MAPOVERLAY_H
@@ -19,6 +19,21 @@
 
 #include "mapportion.h"
 
+// Approximative size of one element: its datas and the vertices of its quad
+const int MapPortion::MEMORY_SIZE_ELEMENT = 256;
+
+// Header of the binary portions files ("RPMP" + format version)
+const quint32 MapPortion::BINARY_MAGIC = 0x52504D50;
+const quint16 MapPortion::BINARY_VERSION = 1;
+
+// Layers of geometry that need to be uploaded again after an edition
+const int MapPortion::LAYER_FLOORS = 1;
+const int MapPortion::LAYER_AUTOTILES = 2;
+const int MapPortion::LAYER_SPRITES = 4;
+const int MapPortion::LAYER_WALLS = 8;
+const int MapPortion::LAYER_OBJECTS = 16;
+const int MapPortion::LAYER_ALL = 31;
+
 // -------------------------------------------------------
 //
 //  CONSTRUCTOR / DESTRUCTOR / GET / SET
@@ -29,7 +44,11 @@ MapPortion::MapPortion(Portion &globalPortion) :
     m_globalPortion(globalPortion),
     m_lands(new Lands),
     m_sprites(new Sprites),
-    m_mapObjects(new MapObjects)
+    m_mapObjects(new MapObjects),
+    m_isVisible(false),
+    m_isLoaded(false),
+    m_isReadOnly(false),
+    m_layersToUpdate(0)
 {
 
 }
@@ -50,7 +69,7 @@ void MapPortion::getGlobalPortion(Portion& portion) {
 MapObjects* MapPortion::mapObjects() const { return m_mapObjects; }
 
 bool MapPortion::isVisibleLoaded() const {
-    return isVisible();
+    return isVisible() && isLoaded();
 }
 
 bool MapPortion::isVisible() const {
@@ -61,6 +80,12 @@ bool MapPortion::isLoaded() const {
     return m_isLoaded;
 }
 
+// A portion that couldn't be read is shown as far as it was read, but never
+// edited: saving it would overwrite its real datas
+bool MapPortion::isReadOnly() const {
+    return m_isReadOnly;
+}
+
 void MapPortion::setIsVisible(bool b) {
     m_isVisible = b;
 }
@@ -69,26 +94,74 @@ void MapPortion::setIsLoaded(bool b) {
     m_isLoaded = b;
 }
 
+void MapPortion::setIsReadOnly(bool b) {
+    m_isReadOnly = b;
+}
+
 bool MapPortion::isEmpty() const {
     return m_lands->isEmpty() && m_sprites->isEmpty() &&
            m_mapObjects->isEmpty();
 }
 
+int MapPortion::getMemorySize() const {
+    return sizeof(MapPortion) + (m_lands->count() + m_sprites->count() +
+                                 m_mapObjects->count()) * MEMORY_SIZE_ELEMENT;
+}
+
+int MapPortion::layersToUpdate() const {
+    return m_layersToUpdate;
+}
+
+void MapPortion::addLayersToUpdate(int layers) {
+    m_layersToUpdate |= layers;
+}
+
+void MapPortion::clearLayersToUpdate() {
+    m_layersToUpdate = 0;
+}
+
+int MapPortion::getLayerOf(MapElement* element) const {
+    if (element->getKind() == MapEditorSelectionKind::Land)
+        return LAYER_FLOORS | LAYER_AUTOTILES;
+    if (element->getSubKind() == MapEditorSubSelectionKind::SpritesWall)
+        return LAYER_WALLS;
+
+    return LAYER_SPRITES;
+}
+
 // -------------------------------------------------------
 //
 //  INTERMEDIARY FUNCTIONS
 //
 // -------------------------------------------------------
 
+// The lands are given as copies, owned by the caller
+
 LandDatas* MapPortion::getLand(Position& p){
     return m_lands->getLand(p);
 }
 
+MapEditorSubSelectionKind MapPortion::getLandKind(Position& p,
+                                                  QRect& texture) const
+{
+    return m_lands->getLandKind(p, texture);
+}
+
+bool MapPortion::getAutotileTexture(Position& p, int& autotileID,
+                                    QRect& texture) const
+{
+    return m_lands->getAutotileTexture(p, autotileID, texture);
+}
+
 bool MapPortion::addLand(Position& p, LandDatas *land, QJsonObject& previous,
                          MapEditorSubSelectionKind& previousType,
-                         QSet<MapPortion*>& update, QSet<MapPortion*>& save)
+                         QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                         bool updateAutotiles)
 {
-    return m_lands->addLand(p, land, previous, previousType, update, save);
+    m_layersToUpdate |= LAYER_FLOORS | LAYER_AUTOTILES;
+
+    return m_lands->addLand(p, land, previous, previousType, update, save,
+                            updateAutotiles);
 }
 
 // -------------------------------------------------------
@@ -96,10 +169,35 @@ bool MapPortion::addLand(Position& p, LandDatas *land, QJsonObject& previous,
 bool MapPortion::deleteLand(Position& p, QList<QJsonObject> &previous,
                             QList<MapEditorSubSelectionKind> &previousType,
                             QList<Position> &positions,
-                            QSet<MapPortion*>& update, QSet<MapPortion*>& save)
+                            QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                            bool updateAutotiles)
 {
+    m_layersToUpdate |= LAYER_FLOORS | LAYER_AUTOTILES;
+
     return m_lands->deleteLand(p, previous, previousType, positions, update,
-                               save);
+                               save, true, updateAutotiles);
+}
+
+// -------------------------------------------------------
+
+bool MapPortion::updateAutotile(Position& p, Portion& portion) {
+    if (m_lands->updateAutotile(p, portion)) {
+        m_layersToUpdate |= LAYER_AUTOTILES;
+        return true;
+    }
+
+    return false;
+}
+
+// -------------------------------------------------------
+
+bool MapPortion::updateAutotileTileID(Position& p, int neighboursMask) {
+    if (m_lands->updateAutotileTileID(p, neighboursMask)) {
+        m_layersToUpdate |= LAYER_AUTOTILES;
+        return true;
+    }
+
+    return false;
 }
 
 // -------------------------------------------------------
@@ -108,6 +206,8 @@ bool MapPortion::addSprite(QSet<Portion>& portionsOverflow, Position& p,
                            SpriteDatas* sprite, QJsonObject &previous,
                            MapEditorSubSelectionKind &previousType)
 {
+    m_layersToUpdate |= LAYER_SPRITES;
+
     return m_sprites->addSprite(portionsOverflow, p, sprite, previous,
                                 previousType);
 }
@@ -124,6 +224,7 @@ bool MapPortion::deleteSprite(QSet<Portion> &portionsOverflow, Position& p,
     bool changed = m_sprites->deleteSprite(portionsOverflow, p, prev, kind);
 
     if (changed) {
+        m_layersToUpdate |= LAYER_SPRITES;
         previous.append(prev);
         previousType.append(kind);
         positions.append(p);
@@ -140,6 +241,8 @@ bool MapPortion::addSpriteWall(Position &position, SpriteWallDatas* sprite,
                                QJsonObject &previous,
                                MapEditorSubSelectionKind &previousType)
 {
+    m_layersToUpdate |= LAYER_WALLS;
+
     return m_sprites->addSpriteWall(position, sprite, previous,
                                     previousType);
 }
@@ -150,6 +253,8 @@ bool MapPortion::deleteSpriteWall(Position &position,
                                   QJsonObject &previous,
                                   MapEditorSubSelectionKind &previousType)
 {
+    m_layersToUpdate |= LAYER_WALLS;
+
     return m_sprites->deleteSpriteWall(position, previous, previousType);
 }
 
@@ -181,6 +286,8 @@ bool MapPortion::addObject(Position& p, SystemCommonObject* o,
                            QJsonObject &previous,
                            MapEditorSubSelectionKind &previousType)
 {
+    m_layersToUpdate |= LAYER_OBJECTS;
+
     return m_mapObjects->addObject(p, o, previous, previousType);
 }
 
@@ -188,6 +295,8 @@ bool MapPortion::addObject(Position& p, SystemCommonObject* o,
 
 bool MapPortion::deleteObject(Position& p, QJsonObject &previous,
                               MapEditorSubSelectionKind &previousType){
+    m_layersToUpdate |= LAYER_OBJECTS;
+
     return m_mapObjects->deleteObject(p, previous, previousType);
 }
 
@@ -227,22 +336,43 @@ void MapPortion::removeObjectsOut(QList<int> &listDeletedObjectsIDs,
 
 void MapPortion::clearPreview() {
     QHash<Position, MapElement*>::iterator i;
-    for (i = m_previewSquares.begin(); i != m_previewSquares.end(); i++)
+    for (i = m_previewSquares.begin(); i != m_previewSquares.end(); i++) {
+        m_layersToUpdate |= getLayerOf(i.value()) & LAYER_WALLS;
         delete i.value();
+    }
+    if (!m_previewDelete.isEmpty())
+        m_layersToUpdate |= LAYER_WALLS;
 
     m_previewSquares.clear();
     m_previewDelete.clear();
+    m_previewHiddenLands.clear();
+    m_previewHiddenSprites.clear();
 }
 
 // -------------------------------------------------------
 
 void MapPortion::addPreview(Position& p, MapElement* element) {
+    int layer = getLayerOf(element);
+
+    // The preview owns its elements, a replaced one is not used anymore
+    MapElement* previous = m_previewSquares.value(p);
+    if (previous != nullptr && previous != element)
+        delete previous;
     m_previewSquares.insert(p, element);
+
+    // Lands and sprites are drawn by the map overlay, hiding the base squares
+    if (layer == LAYER_WALLS)
+        m_layersToUpdate |= LAYER_WALLS;
+    else if (layer == LAYER_SPRITES)
+        m_previewHiddenSprites += p;
+    else
+        m_previewHiddenLands += p;
 }
 
 // -------------------------------------------------------
 
 void MapPortion::addPreviewDelete(Position &p) {
+    m_layersToUpdate |= LAYER_WALLS;
     m_previewDelete.append(p);
 }
 
@@ -329,22 +459,42 @@ const
 
 void MapPortion::initializeVertices(int squareSize, QOpenGLTexture *tileset,
                                     QList<TextureAutotile*>& autotiles,
-                                    QHash<int, QOpenGLTexture *> &characters,
-                                    QHash<int, QOpenGLTexture *> &walls)
+                                    const TextureAtlas& characters,
+                                    const TextureAtlas& walls,
+                                    int layers)
 {
-    m_lands->initializeVertices(autotiles, m_previewSquares, squareSize,
-                                tileset->width(), tileset->height());
-    m_sprites->initializeVertices(walls, m_previewSquares, m_previewDelete,
-                                  squareSize, tileset->width(),
-                                  tileset->height());
-    m_mapObjects->initializeVertices(squareSize, characters);
+    if (layers & LAYER_FLOORS) {
+        m_lands->initializeVerticesFloors(squareSize, tileset->width(),
+                                          tileset->height());
+    }
+    if (layers & LAYER_AUTOTILES)
+        m_lands->initializeVerticesAutotiles(autotiles, squareSize);
+    if (layers & LAYER_SPRITES) {
+        m_sprites->initializeVerticesSprites(squareSize, tileset->width(),
+                                             tileset->height());
+    }
+    if (layers & LAYER_WALLS) {
+        m_sprites->initializeVerticesWalls(walls, m_previewSquares,
+                                           m_previewDelete, squareSize);
+    }
+    if (layers & LAYER_OBJECTS)
+        initializeVerticesObjects(squareSize, characters);
+}
+
+// -------------------------------------------------------
+
+void MapPortion::initializeVerticesPreview(MapOverlay& overlay,
+                                           int squareSize,
+                                           QOpenGLTexture* tileset,
+                                           QList<TextureAutotile*>& autotiles)
+{
+    overlay.addElements(m_previewSquares, squareSize, tileset, autotiles);
 }
 
 // -------------------------------------------------------
 
 void MapPortion::initializeVerticesObjects(int squareSize,
-                                           QHash<int, QOpenGLTexture*>&
-                                           characters)
+                                           const TextureAtlas& characters)
 {
     m_mapObjects->initializeVertices(squareSize, characters);
 }
@@ -369,10 +519,17 @@ void MapPortion::initializeGLObjects(QOpenGLShaderProgram *programStatic,
 
 // -------------------------------------------------------
 
-void MapPortion::updateGL(){
-    m_lands->updateGL();
-    m_sprites->updateGL();
-    updateGLObjects();
+void MapPortion::updateGL(int layers){
+    if (layers & LAYER_FLOORS)
+        m_lands->updateGLFloors();
+    if (layers & LAYER_AUTOTILES)
+        m_lands->updateGLAutotiles();
+    if (layers & LAYER_SPRITES)
+        m_sprites->updateGLSprites();
+    if (layers & LAYER_WALLS)
+        m_sprites->updateGLWalls();
+    if (layers & LAYER_OBJECTS)
+        updateGLObjects();
 }
 
 
@@ -384,20 +541,28 @@ void MapPortion::updateGLObjects() {
 
 // -------------------------------------------------------
 
+void MapPortion::addToRenderList(MapRenderList& renderList) {
+    m_lands->addToRenderList(renderList, this);
+    m_sprites->addToRenderList(renderList, this);
+    m_mapObjects->addToRenderList(renderList, this);
+}
+
+// -------------------------------------------------------
+
 void MapPortion::paintFloors(){
-    m_lands->paintGL();
+    m_lands->paintGL(m_previewHiddenLands);
 }
 
 // -------------------------------------------------------
 
 void MapPortion::paintAutotiles(int textureID) {
-    m_lands->paintAutotilesGL(textureID);
+    m_lands->paintAutotilesGL(textureID, m_previewHiddenLands);
 }
 
 // -------------------------------------------------------
 
 void MapPortion::paintSprites(){
-    m_sprites->paintGL();
+    m_sprites->paintGL(m_previewHiddenSprites);
 }
 
 // -------------------------------------------------------
@@ -409,23 +574,19 @@ void MapPortion::paintSpritesWalls(int textureID) {
 // -------------------------------------------------------
 
 void MapPortion::paintFaceSprites(){
-    m_sprites->paintFaceGL();
+    m_sprites->paintFaceGL(m_previewHiddenSprites);
 }
 
 // -------------------------------------------------------
 
-void MapPortion::paintObjectsStaticSprites(int textureID,
-                                           QOpenGLTexture* texture)
-{
-    m_mapObjects->paintStaticSprites(textureID, texture);
+void MapPortion::paintObjectsStaticSprites(int textureID) {
+    m_mapObjects->paintStaticSprites(textureID);
 }
 
 // -------------------------------------------------------
 
-void MapPortion::paintObjectsFaceSprites(int textureID,
-                                         QOpenGLTexture* texture)
-{
-    m_mapObjects->paintFaceSprites(textureID, texture);
+void MapPortion::paintObjectsFaceSprites(int textureID) {
+    m_mapObjects->paintFaceSprites(textureID);
 }
 
 // -------------------------------------------------------
@@ -467,3 +628,32 @@ void MapPortion::write(QJsonObject & json) const{
     m_mapObjects->write(obj);
     json["objs"] = obj;
 }
+
+// -------------------------------------------------------
+
+bool MapPortion::readBinary(QDataStream& stream){
+    quint32 magic;
+    quint16 version;
+
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream >> magic >> version;
+    if (magic != BINARY_MAGIC || version > BINARY_VERSION)
+        return false;
+
+    m_lands->readBinary(stream);
+    m_sprites->readBinary(stream);
+    m_mapObjects->readBinary(stream);
+
+    return stream.status() == QDataStream::Ok;
+}
+
+// -------------------------------------------------------
+
+void MapPortion::writeBinary(QDataStream& stream) const{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << BINARY_MAGIC << BINARY_VERSION;
+
+    m_lands->writeBinary(stream);
+    m_sprites->writeBinary(stream);
+    m_mapObjects->writeBinary(stream);
+}
@@ -23,6 +23,7 @@
 #include "lands.h"
 #include "sprites.h"
 #include "mapobjects.h"
+#include "mapoverlay.h"
 #include "systemcommonobject.h"
 #include <QOpenGLTexture>
 
@@ -40,22 +41,43 @@ class MapPortion : public Serializable
 public:
     MapPortion(Portion& globalPortion);
     virtual ~MapPortion();
+    static const int MEMORY_SIZE_ELEMENT;
+    static const quint32 BINARY_MAGIC;
+    static const quint16 BINARY_VERSION;
+    static const int LAYER_FLOORS;
+    static const int LAYER_AUTOTILES;
+    static const int LAYER_SPRITES;
+    static const int LAYER_WALLS;
+    static const int LAYER_OBJECTS;
+    static const int LAYER_ALL;
     void getGlobalPortion(Portion& portion);
     MapObjects* mapObjects() const;
     bool isVisibleLoaded() const;
     bool isVisible() const;
     bool isLoaded() const;
+    bool isReadOnly() const;
     void setIsVisible(bool b);
     void setIsLoaded(bool b);
+    void setIsReadOnly(bool b);
     bool isEmpty() const;
+    int getMemorySize() const;
+    int layersToUpdate() const;
+    void addLayersToUpdate(int layers);
+    void clearLayersToUpdate();
     LandDatas* getLand(Position& p);
+    MapEditorSubSelectionKind getLandKind(Position& p, QRect& texture) const;
+    bool getAutotileTexture(Position& p, int& autotileID,
+                            QRect& texture) const;
     bool addLand(Position& p, LandDatas* land, QJsonObject &previous,
                  MapEditorSubSelectionKind &previousType,
-                 QSet<MapPortion*>& update, QSet<MapPortion*>& save);
+                 QSet<MapPortion*>& update, QSet<MapPortion*>& save,
+                 bool updateAutotiles = true);
     bool deleteLand(Position& p, QList<QJsonObject> &previous,
                     QList<MapEditorSubSelectionKind> &previousType,
                     QList<Position>& positions, QSet<MapPortion *> &update,
-                    QSet<MapPortion *> &save);
+                    QSet<MapPortion *> &save, bool updateAutotiles = true);
+    bool updateAutotile(Position& p, Portion& portion);
+    bool updateAutotileTileID(Position& p, int neighboursMask);
     bool addSprite(QSet<Portion>& portionsOverflow, Position& p,
                    SpriteDatas *sprite, QJsonObject &previous,
                    MapEditorSubSelectionKind &previousType);
@@ -105,27 +127,34 @@ public:
 
     void initializeVertices(int squareSize, QOpenGLTexture* tileset,
                             QList<TextureAutotile *> &autotiles,
-                            QHash<int, QOpenGLTexture*>& characters,
-                            QHash<int, QOpenGLTexture *> &walls);
+                            const TextureAtlas& characters,
+                            const TextureAtlas& walls,
+                            int layers = LAYER_ALL);
+    void initializeVerticesPreview(MapOverlay& overlay, int squareSize,
+                                   QOpenGLTexture* tileset,
+                                   QList<TextureAutotile*>& autotiles);
     void initializeVerticesObjects(int squareSize,
-                                   QHash<int, QOpenGLTexture*>& characters);
+                                   const TextureAtlas& characters);
     void initializeGL(QOpenGLShaderProgram *programStatic,
                       QOpenGLShaderProgram *programFace);
     void initializeGLObjects(QOpenGLShaderProgram *programStatic,
                              QOpenGLShaderProgram *programFace);
-    void updateGL();
+    void updateGL(int layers = LAYER_ALL);
     void updateGLObjects();
+    void addToRenderList(MapRenderList& renderList);
     void paintFloors();
     void paintAutotiles(int textureID);
     void paintSprites();
     void paintSpritesWalls(int textureID);
     void paintFaceSprites();
-    void paintObjectsStaticSprites(int textureID, QOpenGLTexture* texture);
-    void paintObjectsFaceSprites(int textureID, QOpenGLTexture* texture);
+    void paintObjectsStaticSprites(int textureID);
+    void paintObjectsFaceSprites(int textureID);
     void paintObjectsSquares();
 
     void read(const QJsonObject &json);
     void write(QJsonObject &json) const;
+    bool readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 private:
     Portion m_globalPortion;
@@ -134,8 +163,14 @@ private:
     MapObjects* m_mapObjects;
     QHash<Position, MapElement*> m_previewSquares;
     QList<Position> m_previewDelete;
+    QSet<Position> m_previewHiddenLands;
+    QSet<Position> m_previewHiddenSprites;
     bool m_isVisible;
     bool m_isLoaded;
+    bool m_isReadOnly;
+    int m_layersToUpdate;
+
+    int getLayerOf(MapElement* element) const;
 };
 
 #endif // MAPPORTION_H
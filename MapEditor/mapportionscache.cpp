@@ -0,0 +1,141 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mapportionscache.h"
+
+const int MapPortionsCache::DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapPortionsCache::MapPortionsCache(int memoryBudget) :
+    m_memoryBudget(memoryBudget),
+    m_memorySize(0),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0)
+{
+
+}
+
+MapPortionsCache::~MapPortionsCache()
+{
+    clear();
+}
+
+int MapPortionsCache::memoryBudget() const { return m_memoryBudget; }
+
+void MapPortionsCache::setMemoryBudget(int memoryBudget) {
+    m_memoryBudget = memoryBudget;
+    removeLeastRecentlyUsed();
+}
+
+int MapPortionsCache::memorySize() const { return m_memorySize; }
+
+int MapPortionsCache::count() const { return m_portions.size(); }
+
+int MapPortionsCache::hits() const { return m_hits; }
+
+int MapPortionsCache::misses() const { return m_misses; }
+
+int MapPortionsCache::evictions() const { return m_evictions; }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+bool MapPortionsCache::contains(Portion& portion) const {
+    return m_portions.contains(portion);
+}
+
+// -------------------------------------------------------
+
+void MapPortionsCache::add(Portion& portion, MapPortion* mapPortion) {
+    delete removePortion(portion);
+
+    int size = mapPortion->getMemorySize();
+    m_portions.insert(portion, mapPortion);
+    m_sizes.insert(portion, size);
+    m_order.append(portion);
+    m_memorySize += size;
+
+    removeLeastRecentlyUsed();
+}
+
+// -------------------------------------------------------
+
+MapPortion* MapPortionsCache::take(Portion& portion) {
+    MapPortion* mapPortion = removePortion(portion);
+
+    if (mapPortion == nullptr)
+        m_misses++;
+    else
+        m_hits++;
+
+    return mapPortion;
+}
+
+// -------------------------------------------------------
+
+void MapPortionsCache::remove(Portion& portion) {
+    delete removePortion(portion);
+}
+
+// -------------------------------------------------------
+
+void MapPortionsCache::clear() {
+    QHash<Portion, MapPortion*>::iterator i;
+    for (i = m_portions.begin(); i != m_portions.end(); i++)
+        delete *i;
+
+    m_portions.clear();
+    m_sizes.clear();
+    m_order.clear();
+    m_memorySize = 0;
+}
+
+// -------------------------------------------------------
+
+MapPortion* MapPortionsCache::removePortion(Portion& portion) {
+    MapPortion* mapPortion = m_portions.take(portion);
+
+    if (mapPortion != nullptr) {
+        m_memorySize -= m_sizes.take(portion);
+        m_order.removeOne(portion);
+    }
+
+    return mapPortion;
+}
+
+// -------------------------------------------------------
+
+void MapPortionsCache::removeLeastRecentlyUsed() {
+
+    // The most recent portion is always kept, even if over the budget
+    while (m_memorySize > m_memoryBudget && m_order.size() > 1) {
+        Portion portion = m_order.first();
+        remove(portion);
+        m_evictions++;
+    }
+}
@@ -0,0 +1,69 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPPORTIONSCACHE_H
+#define MAPPORTIONSCACHE_H
+
+#include "mapportion.h"
+
+// -------------------------------------------------------
+//
+//  CLASS MapPortionsCache
+//
+//  A least recently used cache of map portions that are not in the grid of
+//  the map: portions prefetched before the cursor reaches them and portions
+//  that recently left the grid (these ones keep their GL buffers). Its memory
+//  size is an estimation based on the number of elements of each portion.
+//
+// -------------------------------------------------------
+
+class MapPortionsCache
+{
+public:
+    MapPortionsCache(int memoryBudget = DEFAULT_MEMORY_BUDGET);
+    virtual ~MapPortionsCache();
+    static const int DEFAULT_MEMORY_BUDGET;
+    int memoryBudget() const;
+    void setMemoryBudget(int memoryBudget);
+    int memorySize() const;
+    int count() const;
+    int hits() const;
+    int misses() const;
+    int evictions() const;
+    bool contains(Portion& portion) const;
+    void add(Portion& portion, MapPortion* mapPortion);
+    MapPortion* take(Portion& portion);
+    void remove(Portion& portion);
+    void clear();
+
+protected:
+    int m_memoryBudget;
+    int m_memorySize;
+    QHash<Portion, MapPortion*> m_portions;
+    QHash<Portion, int> m_sizes;
+    QList<Portion> m_order;
+    int m_hits;
+    int m_misses;
+    int m_evictions;
+
+    MapPortion* removePortion(Portion& portion);
+    void removeLeastRecentlyUsed();
+};
+
+#endif // MAPPORTIONSCACHE_H
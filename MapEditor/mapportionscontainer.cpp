@@ -0,0 +1,196 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mapportionscontainer.h"
+#include <QSaveFile>
+
+const QString MapPortionsContainer::FILE_NAME = "portions.pak";
+
+// Header of the container file ("RPMC" + format version)
+const quint32 MapPortionsContainer::MAGIC = 0x52504D43;
+const quint16 MapPortionsContainer::VERSION = 1;
+
+// Sizes in the file of the header and of an index entry
+static const int HEADER_SIZE = 4 + 2 + 4;
+static const int INDEX_ENTRY_SIZE = 3 * 4 + 8 + 4;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapPortionsContainer::MapPortionsContainer() :
+    m_datas(nullptr),
+    m_size(0)
+{
+
+}
+
+MapPortionsContainer::~MapPortionsContainer()
+{
+    close();
+}
+
+bool MapPortionsContainer::isOpen() const { return m_datas != nullptr; }
+
+int MapPortionsContainer::count() const { return m_index.size(); }
+
+QList<Portion> MapPortionsContainer::portions() const {
+    return m_index.keys();
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+bool MapPortionsContainer::open(QString path) {
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+        return false;
+    m_size = m_file.size();
+    if (m_size < HEADER_SIZE) {
+        close();
+        return false;
+    }
+    m_datas = m_file.map(0, m_size);
+    if (m_datas == nullptr) {
+        close();
+        return false;
+    }
+
+    // Header
+    QByteArray datas = QByteArray::fromRawData(
+                reinterpret_cast<const char*>(m_datas), m_size);
+    QDataStream stream(datas);
+    quint32 magic, count;
+    quint16 version;
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream >> magic >> version >> count;
+    if (magic != MAGIC || version > VERSION ||
+        HEADER_SIZE + static_cast<qint64>(count) * INDEX_ENTRY_SIZE > m_size)
+    {
+        close();
+        return false;
+    }
+
+    // Index table
+    for (quint32 i = 0; i < count; i++) {
+        qint32 x, y, z;
+        quint64 offset;
+        quint32 size;
+        stream >> x >> y >> z >> offset >> size;
+        if (offset + size > static_cast<quint64>(m_size)) {
+            close();
+            return false;
+        }
+        m_index.insert(Portion(x, y, z), QPair<quint64, quint32>(offset,
+                                                                 size));
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------
+
+void MapPortionsContainer::close() {
+    if (m_datas != nullptr) {
+        m_file.unmap(m_datas);
+        m_datas = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_index.clear();
+}
+
+// -------------------------------------------------------
+
+bool MapPortionsContainer::contains(Portion& portion) const {
+    return m_index.contains(portion);
+}
+
+// -------------------------------------------------------
+
+QByteArray MapPortionsContainer::portionDatas(Portion& portion) const {
+    QHash<Portion, QPair<quint64, quint32>>::const_iterator i =
+            m_index.find(portion);
+    if (i == m_index.end())
+        return QByteArray();
+
+    return QByteArray(reinterpret_cast<const char*>(m_datas + i->first),
+                      i->second);
+}
+
+// -------------------------------------------------------
+
+bool MapPortionsContainer::readPortion(MapPortion& mapPortion) const {
+    Portion portion;
+    mapPortion.getGlobalPortion(portion);
+    QHash<Portion, QPair<quint64, quint32>>::const_iterator i =
+            m_index.find(portion);
+    if (i == m_index.end())
+        return false;
+
+    // No copy: the stream directly reads the mapped file
+    QByteArray datas = QByteArray::fromRawData(
+                reinterpret_cast<const char*>(m_datas + i->first), i->second);
+    QDataStream stream(datas);
+
+    return mapPortion.readBinary(stream);
+}
+
+// -------------------------------------------------------
+
+bool MapPortionsContainer::write(QString path,
+                                 const QHash<Portion, QByteArray>& portions)
+{
+    // Empty portions are not stored, so an empty map has no container
+    if (portions.isEmpty())
+        return !QFile(path).exists() || QFile(path).remove();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    // Header
+    stream << MAGIC << VERSION << static_cast<quint32>(portions.size());
+
+    // Index table
+    quint64 offset = HEADER_SIZE + portions.size() * INDEX_ENTRY_SIZE;
+    QHash<Portion, QByteArray>::const_iterator i;
+    for (i = portions.begin(); i != portions.end(); i++) {
+        stream << static_cast<qint32>(i.key().x())
+               << static_cast<qint32>(i.key().y())
+               << static_cast<qint32>(i.key().z()) << offset
+               << static_cast<quint32>(i.value().size());
+        offset += i.value().size();
+    }
+
+    // Portions datas, in the same order
+    for (i = portions.begin(); i != portions.end(); i++)
+        stream.writeRawData(i.value().constData(), i.value().size());
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
@@ -0,0 +1,62 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPPORTIONSCONTAINER_H
+#define MAPPORTIONSCONTAINER_H
+
+#include <QFile>
+#include "mapportion.h"
+
+// -------------------------------------------------------
+//
+//  CLASS MapPortionsContainer
+//
+//  A single file packing all the saved portions of a map in the binary
+//  format: a header, an index table giving the offset and size of each
+//  portion, then the portions datas. Only non empty portions are stored. The
+//  file is memory mapped so that reading a portion is an index lookup.
+//
+// -------------------------------------------------------
+
+class MapPortionsContainer
+{
+public:
+    MapPortionsContainer();
+    virtual ~MapPortionsContainer();
+    static const QString FILE_NAME;
+    static const quint32 MAGIC;
+    static const quint16 VERSION;
+    bool isOpen() const;
+    int count() const;
+    QList<Portion> portions() const;
+    bool open(QString path);
+    void close();
+    bool contains(Portion& portion) const;
+    QByteArray portionDatas(Portion& portion) const;
+    bool readPortion(MapPortion& mapPortion) const;
+    static bool write(QString path, const QHash<Portion, QByteArray>& portions);
+
+protected:
+    QFile m_file;
+    uchar* m_datas;
+    qint64 m_size;
+    QHash<Portion, QPair<quint64, quint32>> m_index;
+};
+
+#endif // MAPPORTIONSCONTAINER_H
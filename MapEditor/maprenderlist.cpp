@@ -0,0 +1,79 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "maprenderlist.h"
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapRenderList::MapRenderList() :
+    m_count(0),
+    m_isDirty(true)
+{
+
+}
+
+MapRenderList::~MapRenderList()
+{
+
+}
+
+bool MapRenderList::isDirty() const { return m_isDirty; }
+
+void MapRenderList::setDirty() { m_isDirty = true; }
+
+int MapRenderList::count() const { return m_count; }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void MapRenderList::clear() {
+    m_portions.clear();
+    m_count = 0;
+    m_isDirty = false;
+}
+
+// -------------------------------------------------------
+
+void MapRenderList::add(MapRenderKind kind, MapPortion* mapPortion,
+                        int textureID)
+{
+    m_portions[static_cast<int>(kind)][textureID].append(mapPortion);
+    m_count++;
+}
+
+// -------------------------------------------------------
+
+QList<int> MapRenderList::textures(MapRenderKind kind) const {
+    return m_portions.value(static_cast<int>(kind)).keys();
+}
+
+// -------------------------------------------------------
+
+QList<MapPortion*> MapRenderList::portions(MapRenderKind kind,
+                                           int textureID) const
+{
+    return m_portions.value(static_cast<int>(kind)).value(textureID);
+}
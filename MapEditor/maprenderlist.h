@@ -0,0 +1,59 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPRENDERLIST_H
+#define MAPRENDERLIST_H
+
+#include <QHash>
+#include <QList>
+#include "maprenderkind.h"
+
+class MapPortion;
+
+// -------------------------------------------------------
+//
+//  CLASS MapRenderList
+//
+//  The visible map portions that have something to draw, grouped by kind of
+//  draw and by texture. It is only built again when the portions in the grid
+//  or their geometry changed, so that drawing a frame doesn't iterate on all
+//  the portions of the grid for each texture.
+//
+// -------------------------------------------------------
+
+class MapRenderList
+{
+public:
+    MapRenderList();
+    virtual ~MapRenderList();
+    bool isDirty() const;
+    void setDirty();
+    int count() const;
+    void clear();
+    void add(MapRenderKind kind, MapPortion* mapPortion, int textureID = 0);
+    QList<int> textures(MapRenderKind kind) const;
+    QList<MapPortion*> portions(MapRenderKind kind, int textureID = 0) const;
+
+protected:
+    QHash<int, QHash<int, QList<MapPortion*>>> m_portions;
+    int m_count;
+    bool m_isDirty;
+};
+
+#endif // MAPRENDERLIST_H
@@ -0,0 +1,75 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mapssaver.h"
+#include "threadmapsaver.h"
+#include "wanok.h"
+#include "common.h"
+#include <QThreadPool>
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+MapsSaver::MapsSaver(QString pathMaps, QSet<int> ids) :
+    m_pathMaps(pathMaps),
+    m_ids(ids)
+{
+
+}
+
+QSet<int> MapsSaver::savedMaps() const {
+    QMutexLocker locker(&m_mutex);
+
+    return m_savedMaps;
+}
+
+void MapsSaver::setMapSaved(int id, bool saved) {
+    m_mutex.lock();
+    if (saved)
+        m_savedMaps.insert(id);
+    m_mutex.unlock();
+
+    emit mapSaved();
+}
+
+// -------------------------------------------------------
+//
+//  SLOTS
+//
+// -------------------------------------------------------
+
+void MapsSaver::save() {
+    emit progress(100, "Saving maps...");
+    emit count(m_ids.size());
+
+    // The maps don't share any file, they can all be written at once
+    QThreadPool pool;
+    QSet<int>::const_iterator i;
+    for (i = m_ids.begin(); i != m_ids.end(); i++) {
+        pool.start(new ThreadMapSaver(this, *i, Common::pathCombine(
+                                          m_pathMaps,
+                                          Wanok::generateMapName(*i))));
+    }
+    pool.waitForDone();
+
+    emit finished();
+}
@@ -0,0 +1,61 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPSSAVER_H
+#define MAPSSAVER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QSet>
+
+// -------------------------------------------------------
+//
+//  CLASS MapsSaver
+//
+//  Saves several maps at once: each map is written by a task of a thread
+//  pool, the files being replaced only once they are complete. Meant to be
+//  run in its own thread while a DialogProgress follows the signals.
+//
+// -------------------------------------------------------
+
+class MapsSaver : public QObject
+{
+    Q_OBJECT
+public:
+    MapsSaver(QString pathMaps, QSet<int> ids);
+    QSet<int> savedMaps() const;
+    void setMapSaved(int id, bool saved);
+
+protected:
+    QString m_pathMaps;
+    QSet<int> m_ids;
+    QSet<int> m_savedMaps;
+    mutable QMutex m_mutex;
+
+public slots:
+    void save();
+
+signals:
+    void progress(int, QString);
+    void count(int);
+    void mapSaved();
+    void finished();
+};
+
+#endif // MAPSSAVER_H
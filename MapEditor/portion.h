@@ -60,9 +60,16 @@ protected:
     int m_z;
 };
 
+// Mix a coordinate into a hash. A plain sum of the coordinates puts all the
+// squares of a same anti-diagonal in the same bucket, this one spreads them.
+inline uint hashCombine(uint seed, int value)
+{
+    return seed ^ (uint(value) + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
 inline uint qHash(const Portion& pos)
 {
-   return (pos.x() + pos.y() + pos.z());
+   return hashCombine(hashCombine(hashCombine(0, pos.x()), pos.y()), pos.z());
 }
 
 #endif // PORTION_H
@@ -249,3 +249,23 @@ void Position::write(QJsonArray &json) const{
     }
 }
 
+// -------------------------------------------------------
+
+void Position::readBinary(QDataStream& stream){
+    qint16 layer, centerX, centerZ, angle;
+
+    Position3D::readBinary(stream);
+    stream >> layer >> centerX >> centerZ >> angle;
+    m_layer = layer;
+    m_centerX = centerX;
+    m_centerZ = centerZ;
+    m_angle = angle;
+}
+
+// -------------------------------------------------------
+
+void Position::writeBinary(QDataStream& stream) const{
+    Position3D::writeBinary(stream);
+    stream << static_cast<qint16>(m_layer) << static_cast<qint16>(m_centerX)
+           << static_cast<qint16>(m_centerZ) << static_cast<qint16>(m_angle);
+}
@@ -69,6 +69,8 @@ public:
 
     void read(const QJsonArray &json);
     void write(QJsonArray & json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 protected:
     int m_layer;
@@ -81,8 +83,11 @@ protected:
 
 inline uint qHash(const Position& pos)
 {
-   return (pos.x() + pos.y() + pos.yPlus() + pos.z() + pos.layer()
-           + pos.centerX() + pos.centerZ() + pos.angle());
+   uint h = qHash(static_cast<const Position3D&>(pos));
+   h = hashCombine(h, pos.layer());
+   h = hashCombine(h, pos.centerX());
+   h = hashCombine(h, pos.centerZ());
+   return hashCombine(h, pos.angle());
 }
 
 #endif // POSITION_H
@@ -96,3 +96,22 @@ void Position3D::write(QJsonArray &json) const{
     json.append(m_y_plus);
     json.append(m_z);
 }
+
+// -------------------------------------------------------
+
+void Position3D::readBinary(QDataStream& stream){
+    qint32 x, y, yPlus, z;
+
+    stream >> x >> y >> yPlus >> z;
+    m_x = x;
+    m_y = y;
+    m_y_plus = yPlus;
+    m_z = z;
+}
+
+// -------------------------------------------------------
+
+void Position3D::writeBinary(QDataStream& stream) const{
+    stream << static_cast<qint32>(m_x) << static_cast<qint32>(m_y)
+           << static_cast<qint32>(m_y_plus) << static_cast<qint32>(m_z);
+}
@@ -21,6 +21,7 @@
 #define POSITION3D_H
 
 #include "portion.h"
+#include <QDataStream>
 
 // -------------------------------------------------------
 //
@@ -47,6 +48,8 @@ public:
 
     void read(const QJsonArray &json);
     void write(QJsonArray & json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 protected:
     int m_y_plus;
@@ -54,7 +57,10 @@ protected:
 
 inline uint qHash(const Position3D& pos)
 {
-   return (pos.x() + pos.y() + pos.yPlus() + pos.z());
+   uint h = hashCombine(0, pos.x());
+   h = hashCombine(h, pos.y());
+   h = hashCombine(h, pos.yPlus());
+   return hashCombine(h, pos.z());
 }
 
 #endif // POSITION3D_H
@@ -0,0 +1,170 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "raycastingbvh.h"
+#include <cmath>
+
+// Maximum number of elements in a leaf
+const int RaycastingBVH::LEAF_SIZE = 4;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+RaycastingBVH::RaycastingBVH()
+{
+
+}
+
+RaycastingBVH::~RaycastingBVH()
+{
+
+}
+
+bool RaycastingBVH::isEmpty() const { return m_boxes.isEmpty(); }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void RaycastingBVH::clear() {
+    m_boxes.clear();
+    m_positions.clear();
+    m_nodesBoxes.clear();
+    m_nodesFirst.clear();
+    m_nodesCount.clear();
+    m_nodesNext.clear();
+}
+
+// -------------------------------------------------------
+
+void RaycastingBVH::add(const QBox3D& box, const Position& position) {
+    if (box.isNull())
+        return;
+
+    m_boxes.append(box);
+    m_positions.append(position);
+}
+
+// -------------------------------------------------------
+
+void RaycastingBVH::build() {
+    m_nodesBoxes.clear();
+    m_nodesFirst.clear();
+    m_nodesCount.clear();
+    m_nodesNext.clear();
+    if (!m_boxes.isEmpty())
+        buildNode(0, m_boxes.size());
+}
+
+// -------------------------------------------------------
+
+void RaycastingBVH::getPositions(QRay3D& ray,
+                                 QList<Position>& positions) const
+{
+    if (m_nodesBoxes.isEmpty())
+        return;
+
+    QVector<int> stack;
+    stack.append(0);
+    while (!stack.isEmpty()) {
+        int node = stack.takeLast();
+        if (!isCrossed(m_nodesBoxes.at(node), ray))
+            continue;
+
+        int count = m_nodesCount.at(node);
+        if (count == 0) {
+            stack.append(m_nodesNext.at(node));
+            stack.append(node + 1);
+        }
+        else {
+            int first = m_nodesFirst.at(node);
+            for (int i = first; i < first + count; i++) {
+                if (isCrossed(m_boxes.at(i), ray))
+                    positions.append(m_positions.at(i));
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+int RaycastingBVH::buildNode(int first, int count) {
+    int node = m_nodesBoxes.size();
+    QBox3D box, centers;
+    for (int i = first; i < first + count; i++) {
+        box.unite(m_boxes.at(i));
+        centers.unite(m_boxes.at(i).center());
+    }
+    m_nodesBoxes.append(box);
+    m_nodesFirst.append(first);
+    m_nodesCount.append(count);
+    m_nodesNext.append(-1);
+    if (count <= LEAF_SIZE)
+        return node;
+
+    // Split on the middle of the longest axis of the centers
+    QVector3D size = centers.size();
+    int axis = 0;
+    if (size.y() > size[axis])
+        axis = 1;
+    if (size.z() > size[axis])
+        axis = 2;
+    float middle = centers.center()[axis];
+    int left = first;
+    for (int i = first; i < first + count; i++) {
+        if (m_boxes.at(i).center()[axis] < middle)
+            swap(i, left++);
+    }
+
+    // All the centers are at the same place: split in two halves
+    int leftCount = left - first;
+    if (leftCount == 0 || leftCount == count)
+        leftCount = count / 2;
+
+    m_nodesCount[node] = 0;
+    buildNode(first, leftCount);
+    m_nodesNext[node] = buildNode(first + leftCount, count - leftCount);
+
+    return node;
+}
+
+// -------------------------------------------------------
+
+void RaycastingBVH::swap(int i, int j) {
+    if (i == j)
+        return;
+
+    QBox3D box = m_boxes.at(i);
+    m_boxes[i] = m_boxes.at(j);
+    m_boxes[j] = box;
+    Position position = m_positions.at(i);
+    m_positions[i] = m_positions.at(j);
+    m_positions[j] = position;
+}
+
+// -------------------------------------------------------
+
+bool RaycastingBVH::isCrossed(const QBox3D& box, QRay3D& ray) {
+    return !std::isnan(box.intersection(ray));
+}
@@ -0,0 +1,67 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RAYCASTINGBVH_H
+#define RAYCASTINGBVH_H
+
+#include <QVector>
+#include <QList>
+#include "position.h"
+#include "qbox3d.h"
+#include "qray3d.h"
+
+// -------------------------------------------------------
+//
+//  CLASS RaycastingBVH
+//
+//  A bounding volume hierarchy over the boxes of the elements of a portion,
+//  so that picking only tests the elements whose box is crossed by the ray.
+//  The elements are identified by their position.
+//
+// -------------------------------------------------------
+
+class RaycastingBVH
+{
+public:
+    RaycastingBVH();
+    virtual ~RaycastingBVH();
+    static const int LEAF_SIZE;
+    bool isEmpty() const;
+    void clear();
+    void add(const QBox3D& box, const Position& position);
+    void build();
+    void getPositions(QRay3D& ray, QList<Position>& positions) const;
+
+protected:
+    QVector<QBox3D> m_boxes;
+    QVector<Position> m_positions;
+
+    // Nodes: the children of an internal node are the next node and
+    // m_nodesNext, a leaf has m_nodesCount elements from m_nodesFirst
+    QVector<QBox3D> m_nodesBoxes;
+    QVector<int> m_nodesFirst;
+    QVector<int> m_nodesCount;
+    QVector<int> m_nodesNext;
+
+    int buildNode(int first, int count);
+    void swap(int i, int j);
+    static bool isCrossed(const QBox3D& box, QRay3D& ray);
+};
+
+#endif // RAYCASTINGBVH_H
@@ -0,0 +1,107 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "raycastinglevels.h"
+#include "land.h"
+#include <QtMath>
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+RaycastingLevels::RaycastingLevels()
+{
+
+}
+
+RaycastingLevels::~RaycastingLevels()
+{
+
+}
+
+bool RaycastingLevels::isEmpty() const { return m_levels.isEmpty(); }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void RaycastingLevels::add(const Position& position) {
+    m_levels[getLevel(position)]++;
+}
+
+// -------------------------------------------------------
+
+void RaycastingLevels::remove(const Position& position) {
+    Position level = getLevel(position);
+    QHash<Position, int>::iterator i = m_levels.find(level);
+    if (i != m_levels.end() && --i.value() <= 0)
+        m_levels.erase(i);
+}
+
+// -------------------------------------------------------
+
+void RaycastingLevels::clear() {
+    m_levels.clear();
+}
+
+// -------------------------------------------------------
+
+void RaycastingLevels::getPositions(QRay3D& ray, int squareSize,
+                                    QList<Position>& positions) const
+{
+    QVector3D origin = ray.origin(), direction = ray.direction();
+    if (qFuzzyIsNull(direction.y()))
+        return;
+
+    QHash<Position, int>::const_iterator i;
+    for (i = m_levels.begin(); i != m_levels.end(); i++) {
+        Position level = i.key();
+
+        // Lands up and down of a layer are not on the same plane
+        for (int j = 0; j < 2; j++) {
+            bool up = (j == 0);
+            if (!up && level.layer() == 0)
+                break;
+
+            QVector3D pos, size;
+            LandDatas::getPosSize(pos, size, squareSize, level, up);
+            float t = (pos.y() - origin.y()) / direction.y();
+            if (t < 0)
+                continue;
+
+            QVector3D point = origin + t * direction;
+            Position position(level);
+            position.setX(qFloor(point.x() / squareSize));
+            position.setZ(qFloor(point.z() / squareSize));
+            if (!positions.contains(position))
+                positions.append(position);
+        }
+    }
+}
+
+// -------------------------------------------------------
+
+Position RaycastingLevels::getLevel(const Position& position) {
+    return Position(0, position.y(), position.yPlus(), 0, position.layer(),
+                    position.centerX(), position.centerZ(), position.angle());
+}
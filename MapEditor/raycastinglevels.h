@@ -0,0 +1,57 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RAYCASTINGLEVELS_H
+#define RAYCASTINGLEVELS_H
+
+#include <QHash>
+#include <QList>
+#include "position.h"
+#include "qray3d.h"
+
+// -------------------------------------------------------
+//
+//  CLASS RaycastingLevels
+//
+//  The levels (height and layer) having lands in a portion. Lands are flat
+//  squares, so a ray can only hit the square under the point where it
+//  crosses the plane of a level: picking only tests these squares instead
+//  of all the lands of the portion.
+//
+// -------------------------------------------------------
+
+class RaycastingLevels
+{
+public:
+    RaycastingLevels();
+    virtual ~RaycastingLevels();
+    bool isEmpty() const;
+    void add(const Position& position);
+    void remove(const Position& position);
+    void clear();
+    void getPositions(QRay3D& ray, int squareSize,
+                      QList<Position>& positions) const;
+
+protected:
+    QHash<Position, int> m_levels;
+
+    static Position getLevel(const Position& position);
+};
+
+#endif // RAYCASTINGLEVELS_H
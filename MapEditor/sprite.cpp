@@ -366,6 +366,36 @@ float SpriteDatas::intersection(int squareSize, QRay3D& ray, Position& position,
 
 // -------------------------------------------------------
 
+QBox3D SpriteDatas::boundingBox(int squareSize, Position& position) {
+    QBox3D box;
+
+    if (m_kind == MapEditorSubSelectionKind::SpritesFace) {
+
+        // Turning around its center with the camera
+        QVector3D pos, size, center, off;
+        getPosSizeCenter(pos, size, center, off, squareSize, position);
+        float radius = 0;
+        for (int i = 0; i < Sprite::nbVerticesQuad; i++) {
+            QVector3D vec = Sprite::modelQuad[i] * size + pos;
+            box.unite(vec);
+            radius = qMax(radius, QVector2D(vec.x() - center.x(),
+                                            vec.z() - center.z()).length());
+        }
+        box.setExtents(QVector3D(center.x() - radius, box.minimum().y(),
+                                 center.z() - radius),
+                       QVector3D(center.x() + radius, box.maximum().y(),
+                                 center.z() + radius));
+    }
+    else {
+        for (int i = 0; i + 1 < m_vertices.size(); i += 2)
+            box.unite(QBox3D(m_vertices.at(i), m_vertices.at(i + 1)));
+    }
+
+    return box;
+}
+
+// -------------------------------------------------------
+
 float SpriteDatas::intersectionPlane(int angle, QRay3D& ray)
 {
     QVector3D normal(0, 0, 1);
@@ -420,6 +450,32 @@ void SpriteDatas::write(QJsonObject & json) const{
         json[jsonFront] = m_front;
 }
 
+// -------------------------------------------------------
+
+void SpriteDatas::readBinary(QDataStream& stream){
+    qint8 kind;
+    qint16 x, y, width, height;
+
+    MapElement::readBinary(stream);
+    stream >> kind >> x >> y >> width >> height >> m_front;
+    m_kind = static_cast<MapEditorSubSelectionKind>(kind);
+    m_textureRect->setLeft(x);
+    m_textureRect->setTop(y);
+    m_textureRect->setWidth(width);
+    m_textureRect->setHeight(height);
+}
+
+// -------------------------------------------------------
+
+void SpriteDatas::writeBinary(QDataStream& stream) const{
+    MapElement::writeBinary(stream);
+    stream << static_cast<qint8>(m_kind)
+           << static_cast<qint16>(m_textureRect->left())
+           << static_cast<qint16>(m_textureRect->top())
+           << static_cast<qint16>(m_textureRect->width())
+           << static_cast<qint16>(m_textureRect->height()) << m_front;
+}
+
 // -------------------------------------------------------
 //
 //
@@ -434,11 +490,8 @@ void SpriteDatas::write(QJsonObject & json) const{
 //
 // -------------------------------------------------------
 
-SpriteObject::SpriteObject(SpriteDatas &datas, QOpenGLTexture* texture) :
-    m_datas(datas),
-    m_texture(texture),
-    m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
-    m_indexBuffer(QOpenGLBuffer::IndexBuffer),
+SpriteObject::SpriteObject() :
+    m_count(0),
     m_programStatic(nullptr),
     m_programFace(nullptr)
 {
@@ -456,17 +509,29 @@ SpriteObject::~SpriteObject()
 //
 // -------------------------------------------------------
 
-void SpriteObject::initializeVertices(int squareSize, Position& position)
+void SpriteObject::initializeVertices(SpriteDatas& datas, int squareSize,
+                                      Position& position,
+                                      const TextureAtlas& atlas, int textureID)
 {
-    m_verticesStatic.clear();
-    m_verticesFace.clear();
-    m_indexes.clear();
-    int count = 0;
-    m_datas.initializeVertices(squareSize,
-                               m_texture->width(),
-                               m_texture->height(),
-                               m_verticesStatic, m_indexes, m_verticesFace,
-                               m_indexes, position, count, count);
+    int firstStatic = m_verticesStatic.size();
+    int firstFace = m_verticesFace.size();
+    QRect rect = atlas.rect(textureID);
+    datas.initializeVertices(squareSize, rect.width(), rect.height(),
+                             m_verticesStatic, m_indexes, m_verticesFace,
+                             m_indexes, position, m_count, m_count);
+
+    // Texture coordinates in the atlas page
+    QVector2D tex;
+    for (int i = firstStatic; i < m_verticesStatic.size(); i++) {
+        tex = m_verticesStatic.at(i).tex();
+        atlas.remap(textureID, tex);
+        m_verticesStatic[i].setTex(tex);
+    }
+    for (int i = firstFace; i < m_verticesFace.size(); i++) {
+        tex = m_verticesFace.at(i).tex();
+        atlas.remap(textureID, tex);
+        m_verticesFace[i].setTex(tex);
+    }
 }
 
 // -------------------------------------------------------
@@ -494,14 +559,14 @@ void SpriteObject::initializeFaceGL(QOpenGLShaderProgram *programFace){
 // -------------------------------------------------------
 
 void SpriteObject::updateStaticGL(){
-    Map::updateGLStatic(m_vertexBuffer, m_indexBuffer, m_verticesStatic,
+    Map::updateGLStatic(m_vertexRange, m_indexRange, m_verticesStatic,
                         m_indexes, m_vao, m_programStatic);
 }
 
 // -------------------------------------------------------
 
 void SpriteObject::updateFaceGL(){
-    Map::updateGLFace(m_vertexBuffer, m_indexBuffer, m_verticesFace,
+    Map::updateGLFace(m_vertexRange, m_indexRange, m_verticesFace,
                       m_indexes, m_vao, m_programFace);
 }
 
@@ -509,7 +574,8 @@ void SpriteObject::updateFaceGL(){
 
 void SpriteObject::paintGL(){
     m_vao.bind();
-    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT,
+                   m_indexRange.indexesOffset());
     m_vao.release();
 }
 
@@ -734,6 +800,12 @@ float SpriteWallDatas::intersection(QRay3D& ray)
 
 // -------------------------------------------------------
 
+QBox3D SpriteWallDatas::boundingBox() const {
+    return QBox3D(m_vecA, m_vecC);
+}
+
+// -------------------------------------------------------
+
 float SpriteWallDatas::intersectionPlane(int angle, QRay3D& ray) {
     QVector3D normal(0, 0, 1);
     QMatrix4x4 m;
@@ -767,3 +839,20 @@ void SpriteWallDatas::write(QJsonObject & json) const{
     json["w"] = m_wallID;
     json["k"] = (int) m_wallKind;
 }
+
+// -------------------------------------------------------
+
+void SpriteWallDatas::readBinary(QDataStream& stream){
+    qint32 wallID;
+    qint8 wallKind;
+
+    stream >> wallID >> wallKind;
+    m_wallID = wallID;
+    m_wallKind = static_cast<SpriteWallKind>(wallKind);
+}
+
+// -------------------------------------------------------
+
+void SpriteWallDatas::writeBinary(QDataStream& stream) const{
+    stream << static_cast<qint32>(m_wallID) << static_cast<qint8>(m_wallKind);
+}
@@ -22,7 +22,8 @@
 
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
-#include <QOpenGLBuffer>
+#include "glbufferarena.h"
+#include "textureatlas.h"
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLTexture>
 #include <QHash>
@@ -36,6 +37,7 @@
 #include "mapelement.h"
 #include "spritewallkind.h"
 #include "qray3d.h"
+#include "qbox3d.h"
 
 // -------------------------------------------------------
 //
@@ -101,11 +103,14 @@ public:
     float intersection(int squareSize, QRay3D& ray, Position& position,
                        int cameraHAngle);
     float intersectionPlane(int angle, QRay3D& ray);
+    QBox3D boundingBox(int squareSize, Position& position);
 
     static QString jsonFront;
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    virtual void readBinary(QDataStream& stream);
+    virtual void writeBinary(QDataStream& stream) const;
 
 protected:
     MapEditorSubSelectionKind m_kind;
@@ -118,16 +123,19 @@ protected:
 //
 //  CLASS SpriteObject
 //
-//  A sprite object in a portion of the map.
+//  The sprites of the objects in a portion of the map that use the same
+//  texture atlas page, merged in order to be drawn at once.
 //
 // -------------------------------------------------------
 
 class SpriteObject : protected QOpenGLFunctions
 {
 public:
-    SpriteObject(SpriteDatas& datas, QOpenGLTexture* texture);
+    SpriteObject();
     virtual ~SpriteObject();
-    void initializeVertices(int squareSize, Position &position);
+    void initializeVertices(SpriteDatas& datas, int squareSize,
+                            Position &position, const TextureAtlas& atlas,
+                            int textureID);
     void initializeStaticGL(QOpenGLShaderProgram* programStatic);
     void initializeFaceGL(QOpenGLShaderProgram *programFace);
     void updateStaticGL();
@@ -135,12 +143,11 @@ public:
     void paintGL();
 
 protected:
-    SpriteDatas& m_datas;
-    QOpenGLTexture* m_texture;
+    int m_count;
 
     // OpenGL static
-    QOpenGLBuffer m_vertexBuffer;
-    QOpenGLBuffer m_indexBuffer;
+    GLBufferRange m_vertexRange;
+    GLBufferRange m_indexRange;
     QVector<Vertex> m_verticesStatic;
     QVector<GLuint> m_indexes;
     QOpenGLVertexArrayObject m_vao;
@@ -183,10 +190,13 @@ public:
                                     Position& position, int& count);
     float intersection(QRay3D& ray);
     float intersectionPlane(int angle, QRay3D& ray);
+    QBox3D boundingBox() const;
     virtual QString toString() const;
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    virtual void readBinary(QDataStream& stream);
+    virtual void writeBinary(QDataStream& stream) const;
 
 protected:
     int m_wallID;
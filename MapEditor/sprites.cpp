@@ -37,8 +37,6 @@
 
 SpritesWalls::SpritesWalls() :
     m_count(0),
-    m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
-    m_indexBuffer(QOpenGLBuffer::IndexBuffer),
     m_program(nullptr)
 {
 
@@ -55,12 +53,37 @@ SpritesWalls::~SpritesWalls()
 //
 // -------------------------------------------------------
 
+bool SpritesWalls::isEmpty() const {
+    return m_indexes.isEmpty();
+}
+
+// -------------------------------------------------------
+
+void SpritesWalls::clearVertices() {
+    m_vertices.clear();
+    m_indexes.clear();
+    m_count = 0;
+}
+
+// -------------------------------------------------------
+
 void SpritesWalls::initializeVertices(Position &position,
                                       SpriteWallDatas* sprite,
-                                      int squareSize, int width, int height)
+                                      int squareSize,
+                                      const TextureAtlas& atlas, int textureID)
 {
-    sprite->initializeVertices(squareSize, width, height, m_vertices,
-                               m_indexes, position, m_count);
+    int first = m_vertices.size();
+    QRect rect = atlas.rect(textureID);
+    sprite->initializeVertices(squareSize, rect.width(), rect.height(),
+                               m_vertices, m_indexes, position, m_count);
+
+    // Texture coordinates in the atlas page
+    QVector2D tex;
+    for (int i = first; i < m_vertices.size(); i++) {
+        tex = m_vertices.at(i).tex();
+        atlas.remap(textureID, tex);
+        m_vertices[i].setTex(tex);
+    }
 }
 
 // -------------------------------------------------------
@@ -77,7 +100,7 @@ void SpritesWalls::initializeGL(QOpenGLShaderProgram* program) {
 // -------------------------------------------------------
 
 void SpritesWalls::updateGL(){
-    Map::updateGLStatic(m_vertexBuffer, m_indexBuffer, m_vertices, m_indexes,
+    Map::updateGLStatic(m_vertexRange, m_indexRange, m_vertices, m_indexes,
                         m_vao, m_program);
 }
 
@@ -85,7 +108,8 @@ void SpritesWalls::updateGL(){
 
 void SpritesWalls::paintGL(){
     m_vao.bind();
-    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT,
+                   m_indexRange.indexesOffset());
     m_vao.release();
 }
 
@@ -104,11 +128,9 @@ void SpritesWalls::paintGL(){
 // -------------------------------------------------------
 
 Sprites::Sprites() :
-    m_vertexBufferStatic(QOpenGLBuffer::VertexBuffer),
-    m_indexBufferStatic(QOpenGLBuffer::IndexBuffer),
+    m_spritesBVHDirty(true),
+    m_wallsBVHDirty(true),
     m_programStatic(nullptr),
-    m_vertexBufferFace(QOpenGLBuffer::VertexBuffer),
-    m_indexBufferFace(QOpenGLBuffer::IndexBuffer),
     m_programFace(nullptr)
 {
 
@@ -149,6 +171,12 @@ bool Sprites::isEmpty() const{
 
 // -------------------------------------------------------
 
+int Sprites::count() const {
+    return m_all.size() + m_walls.size();
+}
+
+// -------------------------------------------------------
+
 bool Sprites::contains(Position& position) const {
     return m_all.contains(position);
 }
@@ -159,6 +187,7 @@ void Sprites::changePosition(Position& position, Position& newPosition) {
     SpriteDatas* sprite = m_all.value(position);
     m_all.remove(position);
     m_all.insert(newPosition, sprite);
+    m_spritesBVHDirty = true;
 }
 
 // -------------------------------------------------------
@@ -172,6 +201,7 @@ SpriteDatas* Sprites::spriteAt(Position& position) const {
 void Sprites::setSprite(QSet<Portion>& portionsOverflow, Position& p,
                         SpriteDatas* sprite){
     m_all[p] = sprite;
+    m_spritesBVHDirty = true;
 
     // Getting overflowing portions
     getSetPortionsOverflow(portionsOverflow, p, sprite);
@@ -311,6 +341,7 @@ bool Sprites::deleteSprite(QSet<Portion>& portionsOverflow, Position& p,
 
 void Sprites::setSpriteWall(Position &p, SpriteWallDatas* sprite) {
     m_walls[p] = sprite;
+    m_wallsBVHDirty = true;
 }
 
 // -------------------------------------------------------
@@ -464,13 +495,17 @@ MapElement* Sprites::updateRaycasting(int squareSize, float &finalDistance,
 {
     MapElement* element = nullptr;
 
-    for (QHash<Position, SpriteDatas*>::iterator i = m_all.begin();
-         i != m_all.end(); i++)
-    {
-        Position position = i.key();
-        SpriteDatas *sprite = i.value();
-        if (updateRaycastingAt(position, sprite, squareSize, finalDistance,
-                               finalPosition, ray, cameraHAngle))
+    // Only the sprites whose box is crossed by the ray
+    if (m_spritesBVHDirty)
+        updateSpritesBVH(squareSize);
+    QList<Position> positions;
+    m_spritesBVH.getPositions(ray, positions);
+    for (int i = 0; i < positions.size(); i++) {
+        Position position = positions.at(i);
+        SpriteDatas *sprite = m_all.value(position);
+        if (sprite != nullptr && updateRaycastingAt(
+                position, sprite, squareSize, finalDistance, finalPosition,
+                ray, cameraHAngle))
         {
             element = sprite;
         }
@@ -494,13 +529,15 @@ MapElement* Sprites::updateRaycasting(int squareSize, float &finalDistance,
 
     // If layer on, also check the walls
     if (layerOn) {
-        for (QHash<Position, SpriteWallDatas*>::iterator i =
-             m_walls.begin(); i != m_walls.end(); i++)
-        {
-            Position position = i.key();
-            SpriteWallDatas *wall = i.value();
-            if (updateRaycastingWallAt(position, wall, finalDistance,
-                                       finalPosition, ray))
+        if (m_wallsBVHDirty)
+            updateWallsBVH();
+        positions.clear();
+        m_wallsBVH.getPositions(ray, positions);
+        for (int i = 0; i < positions.size(); i++) {
+            Position position = positions.at(i);
+            SpriteWallDatas *wall = m_walls.value(position);
+            if (wall != nullptr && updateRaycastingWallAt(
+                    position, wall, finalDistance, finalPosition, ray))
             {
                 element = wall;
             }
@@ -544,6 +581,34 @@ bool Sprites::updateRaycastingWallAt(
 
 // -------------------------------------------------------
 
+void Sprites::updateSpritesBVH(int squareSize) {
+    m_spritesBVH.clear();
+    for (QHash<Position, SpriteDatas*>::iterator i = m_all.begin();
+         i != m_all.end(); i++)
+    {
+        Position position = i.key();
+        m_spritesBVH.add(i.value()->boundingBox(squareSize, position),
+                         position);
+    }
+    m_spritesBVH.build();
+    m_spritesBVHDirty = false;
+}
+
+// -------------------------------------------------------
+
+void Sprites::updateWallsBVH() {
+    m_wallsBVH.clear();
+    for (QHash<Position, SpriteWallDatas*>::iterator i = m_walls.begin();
+         i != m_walls.end(); i++)
+    {
+        m_wallsBVH.add(i.value()->boundingBox(), i.key());
+    }
+    m_wallsBVH.build();
+    m_wallsBVHDirty = false;
+}
+
+// -------------------------------------------------------
+
 MapElement* Sprites::getMapElementAt(Position& position,
                                      MapEditorSubSelectionKind subKind)
 {
@@ -608,10 +673,19 @@ void Sprites::updateRemoveLayer(QSet<Portion> portionsOverflow,
 //
 // -------------------------------------------------------
 
-void Sprites::initializeVertices(QHash<int, QOpenGLTexture *> &texturesWalls,
+void Sprites::initializeVertices(const TextureAtlas& texturesWalls,
                                  QHash<Position, MapElement *> &previewSquares,
                                  QList<Position> &previewDelete,
                                  int squareSize, int width, int height)
+{
+    initializeVerticesSprites(squareSize, width, height);
+    initializeVerticesWalls(texturesWalls, previewSquares, previewDelete,
+                            squareSize);
+}
+
+// -------------------------------------------------------
+
+void Sprites::initializeVerticesSprites(int squareSize, int width, int height)
 {
     int countStatic = 0;
     int countFace = 0;
@@ -619,42 +693,47 @@ void Sprites::initializeVertices(QHash<int, QOpenGLTexture *> &texturesWalls,
     // Clear
     m_verticesStatic.clear();
     m_indexesStatic.clear();
+    m_rangesStatic.clear();
     m_verticesFace.clear();
     m_indexesFace.clear();
-    for (QHash<int, SpritesWalls*>::iterator i = m_wallsGL.begin();
-         i != m_wallsGL.end(); i++)
-    {
-        delete *i;
-    }
-    m_wallsGL.clear();
-
-    // Create temp hash for preview
-    QHash<Position, SpriteDatas*> spritesWithPreview(m_all);
-    for (QHash<Position, MapElement*>::iterator i = previewSquares.begin();
-         i != previewSquares.end(); i++)
-    {
-        MapElement* element = i.value();
-        if (element->getKind() == MapEditorSelectionKind::Sprites &&
-            element->getSubKind() != MapEditorSubSelectionKind::SpritesWall)
-        {
-            spritesWithPreview[i.key()] = (SpriteDatas*) element;
-        }
-    }
-    QHash<Position, SpriteWallDatas*> spritesWallWithPreview;
-    getWallsWithPreview(spritesWallWithPreview, previewSquares, previewDelete);
+    m_rangesFace.clear();
+    m_spritesBVHDirty = true;
 
-    // Initialize vertices in squares
-    for (QHash<Position, SpriteDatas*>::iterator i = spritesWithPreview.begin();
-         i != spritesWithPreview.end(); i++)
+    // Initialize vertices in squares (the previews are in the overlay)
+    for (QHash<Position, SpriteDatas*>::iterator i = m_all.begin();
+         i != m_all.end(); i++)
     {
         Position position = i.key();
         SpriteDatas* sprite = i.value();
+        int beginStatic = m_indexesStatic.size();
+        int beginFace = m_indexesFace.size();
 
         sprite->initializeVertices(squareSize, width, height,
                                    m_verticesStatic, m_indexesStatic,
                                    m_verticesFace, m_indexesFace,
                                    position, countStatic, countFace);
+        m_rangesStatic.add(position, beginStatic, m_indexesStatic.size());
+        m_rangesFace.add(position, beginFace, m_indexesFace.size());
+    }
+}
+
+// -------------------------------------------------------
+
+void Sprites::initializeVerticesWalls(
+        const TextureAtlas& texturesWalls,
+        QHash<Position, MapElement *> &previewSquares,
+        QList<Position> &previewDelete, int squareSize)
+{
+    // Clear, keeping the GL buffers of the previous vertices
+    for (QHash<int, SpritesWalls*>::iterator i = m_wallsGL.begin();
+         i != m_wallsGL.end(); i++)
+    {
+        i.value()->clearVertices();
     }
+    m_wallsBVHDirty = true;
+
+    QHash<Position, SpriteWallDatas*> spritesWallWithPreview;
+    getWallsWithPreview(spritesWallWithPreview, previewSquares, previewDelete);
 
     // Initialize vertices for walls
     for (QHash<Position, SpriteWallDatas*>::iterator i =
@@ -663,17 +742,18 @@ void Sprites::initializeVertices(QHash<int, QOpenGLTexture *> &texturesWalls,
         Position position = i.key();
         SpriteWallDatas* sprite = i.value();
         int id = sprite->wallID();
-        SpritesWalls* sprites = m_wallsGL.value(id);
+        if (!texturesWalls.contains(id))
+            id = -1;
+
+        // Walls are grouped by atlas page
+        int page = texturesWalls.page(id);
+        SpritesWalls* sprites = m_wallsGL.value(page);
         if (sprites == nullptr) {
             sprites = new SpritesWalls;
-            m_wallsGL[id] = sprites;
+            m_wallsGL[page] = sprites;
         }
-        QOpenGLTexture* texture = texturesWalls.value(id);
-        if (texture == nullptr)
-            texture = texturesWalls.value(-1);
-
         sprites->initializeVertices(position, sprite, squareSize,
-                                    texture->width(), texture->height());
+                                    texturesWalls, id);
     }
 }
 
@@ -698,12 +778,24 @@ void Sprites::initializeGL(QOpenGLShaderProgram* programStatic,
 // -------------------------------------------------------
 
 void Sprites::updateGL() {
-    Map::updateGLStatic(m_vertexBufferStatic, m_indexBufferStatic,
+    updateGLSprites();
+    updateGLWalls();
+}
+
+// -------------------------------------------------------
+
+void Sprites::updateGLSprites() {
+    Map::updateGLStatic(m_vertexRangeStatic, m_indexRangeStatic,
                         m_verticesStatic, m_indexesStatic, m_vaoStatic,
                         m_programStatic);
-    Map::updateGLFace(m_vertexBufferFace, m_indexBufferFace,
+    Map::updateGLFace(m_vertexRangeFace, m_indexRangeFace,
                       m_verticesFace, m_indexesFace, m_vaoFace,
                       m_programFace);
+}
+
+// -------------------------------------------------------
+
+void Sprites::updateGLWalls() {
     QHash<int, SpritesWalls*>::iterator i;
     for (i = m_wallsGL.begin(); i != m_wallsGL.end(); i++)
         i.value()->updateGL();
@@ -711,17 +803,51 @@ void Sprites::updateGL() {
 
 // -------------------------------------------------------
 
-void Sprites::paintGL(){
+void Sprites::addToRenderList(MapRenderList& renderList,
+                              MapPortion* mapPortion)
+{
+    if (!m_indexesStatic.isEmpty())
+        renderList.add(MapRenderKind::Sprites, mapPortion);
+    if (!m_indexesFace.isEmpty())
+        renderList.add(MapRenderKind::FaceSprites, mapPortion);
+    QHash<int, SpritesWalls*>::iterator i;
+    for (i = m_wallsGL.begin(); i != m_wallsGL.end(); i++) {
+        if (!i.value()->isEmpty())
+            renderList.add(MapRenderKind::Walls, mapPortion, i.key());
+    }
+}
+
+// -------------------------------------------------------
+
+void Sprites::paintGL(const QSet<Position>& hidden){
     m_vaoStatic.bind();
-    glDrawElements(GL_TRIANGLES, m_indexesStatic.size(), GL_UNSIGNED_INT, 0);
+    if (hidden.isEmpty()) {
+        glDrawElements(GL_TRIANGLES, m_indexesStatic.size(), GL_UNSIGNED_INT,
+                       m_indexRangeStatic.indexesOffset());
+    }
+    else {
+        QList<QPair<int, int>> hiddenRanges;
+        m_rangesStatic.getRanges(hidden, hiddenRanges);
+        GLElementsRanges::paint(this, m_indexRangeStatic.indexesOffset(),
+                                m_indexesStatic.size(), hiddenRanges);
+    }
     m_vaoStatic.release();
 }
 
 // -------------------------------------------------------
 
-void Sprites::paintFaceGL(){
+void Sprites::paintFaceGL(const QSet<Position>& hidden){
     m_vaoFace.bind();
-    glDrawElements(GL_TRIANGLES, m_indexesFace.size(), GL_UNSIGNED_INT, 0);
+    if (hidden.isEmpty()) {
+        glDrawElements(GL_TRIANGLES, m_indexesFace.size(), GL_UNSIGNED_INT,
+                       m_indexRangeFace.indexesOffset());
+    }
+    else {
+        QList<QPair<int, int>> hiddenRanges;
+        m_rangesFace.getRanges(hidden, hiddenRanges);
+        GLElementsRanges::paint(this, m_indexRangeFace.indexesOffset(),
+                                m_indexesFace.size(), hiddenRanges);
+    }
     m_vaoFace.release();
 }
 
@@ -824,3 +950,68 @@ void Sprites::write(QJsonObject & json) const{
     }
     json["overflow"] = tabOverflow;
 }
+
+// -------------------------------------------------------
+
+void Sprites::readBinary(QDataStream& stream){
+    qint32 count;
+
+    // Globals
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++){
+        Position p;
+        p.readBinary(stream);
+        SpriteDatas* sprite = new SpriteDatas;
+        sprite->readBinary(stream);
+        m_all[p] = sprite;
+    }
+
+    // Walls
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++){
+        Position p;
+        p.readBinary(stream);
+        SpriteWallDatas* sprite = new SpriteWallDatas;
+        sprite->readBinary(stream);
+        m_walls[p] = sprite;
+    }
+
+    // Overflow
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++){
+        Position position;
+        position.readBinary(stream);
+        m_overflow += position;
+    }
+}
+
+// -------------------------------------------------------
+
+void Sprites::writeBinary(QDataStream& stream) const{
+
+    // Globals
+    stream << static_cast<qint32>(m_all.size());
+    for (QHash<Position, SpriteDatas*>::const_iterator i = m_all.begin();
+         i != m_all.end(); i++)
+    {
+        i.key().writeBinary(stream);
+        i.value()->writeBinary(stream);
+    }
+
+    // Walls
+    stream << static_cast<qint32>(m_walls.size());
+    for (QHash<Position, SpriteWallDatas*>::const_iterator i =
+         m_walls.begin(); i != m_walls.end(); i++)
+    {
+        i.key().writeBinary(stream);
+        i.value()->writeBinary(stream);
+    }
+
+    // Overflow
+    stream << static_cast<qint32>(m_overflow.size());
+    for (QSet<Position>::const_iterator i = m_overflow.begin();
+         i != m_overflow.end(); i++)
+    {
+        i->writeBinary(stream);
+    }
+}
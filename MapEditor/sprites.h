@@ -21,6 +21,9 @@
 #define SPRITES_H
 
 #include "sprite.h"
+#include "maprenderlist.h"
+#include "raycastingbvh.h"
+#include "glelementsranges.h"
 
 // -------------------------------------------------------
 //
@@ -35,8 +38,11 @@ class SpritesWalls : protected QOpenGLFunctions
 public:
     SpritesWalls();
     virtual ~SpritesWalls();
+    bool isEmpty() const;
+    void clearVertices();
     void initializeVertices(Position& position, SpriteWallDatas* sprite,
-                            int squareSize, int width, int height);
+                            int squareSize, const TextureAtlas& atlas,
+                            int textureID);
     void initializeGL(QOpenGLShaderProgram* program);
     void updateGL();
     void paintGL();
@@ -45,8 +51,8 @@ protected:
     int m_count;
 
     // OpenGL
-    QOpenGLBuffer m_vertexBuffer;
-    QOpenGLBuffer m_indexBuffer;
+    GLBufferRange m_vertexRange;
+    GLBufferRange m_indexRange;
     QVector<Vertex> m_vertices;
     QVector<GLuint> m_indexes;
     QOpenGLVertexArrayObject m_vao;
@@ -69,6 +75,7 @@ public:
     void addOverflow(Position& p);
     void removeOverflow(Position& p);
     bool isEmpty() const;
+    int count() const;
     bool contains(Position& position) const;
     void changePosition(Position& position, Position& newPosition);
     SpriteDatas* spriteAt(Position& position) const;
@@ -113,6 +120,8 @@ public:
     bool updateRaycastingWallAt(
             Position &position, SpriteWallDatas* wall,
             float &finalDistance, Position &finalPosition, QRay3D& ray);
+    void updateSpritesBVH(int squareSize);
+    void updateWallsBVH();
     MapElement* getMapElementAt(Position& position,
                                 MapEditorSubSelectionKind subKind);
     int getLastLayerAt(Position& position) const;
@@ -122,19 +131,29 @@ public:
             QList<MapEditorSubSelectionKind> previousType,
             QList<Position> positions);
 
-    void initializeVertices(QHash<int, QOpenGLTexture*>& texturesWalls,
+    void initializeVertices(const TextureAtlas& texturesWalls,
                             QHash<Position, MapElement*>& previewSquares,
                             QList<Position>& previewDelete,
                             int squareSize, int width, int height);
+    void initializeVerticesSprites(int squareSize, int width, int height);
+    void initializeVerticesWalls(const TextureAtlas& texturesWalls,
+                                 QHash<Position, MapElement*>& previewSquares,
+                                 QList<Position>& previewDelete,
+                                 int squareSize);
     void initializeGL(QOpenGLShaderProgram* programStatic,
                       QOpenGLShaderProgram* programFace);
     void updateGL();
-    void paintGL();
-    void paintFaceGL();
+    void updateGLSprites();
+    void updateGLWalls();
+    void addToRenderList(MapRenderList& renderList, MapPortion* mapPortion);
+    void paintGL(const QSet<Position>& hidden);
+    void paintFaceGL(const QSet<Position>& hidden);
     void paintSpritesWalls(int textureID);
 
     virtual void read(const QJsonObject &json);
     virtual void write(QJsonObject &json) const;
+    void readBinary(QDataStream& stream);
+    void writeBinary(QDataStream& stream) const;
 
 protected:
     QHash<Position, SpriteDatas*> m_all;
@@ -142,19 +161,27 @@ protected:
     QHash<int, SpritesWalls*> m_wallsGL;
     QSet<Position> m_overflow;
 
+    // Picking, built again after the vertices changed
+    RaycastingBVH m_spritesBVH;
+    RaycastingBVH m_wallsBVH;
+    bool m_spritesBVHDirty;
+    bool m_wallsBVHDirty;
+
     // OpenGL static
-    QOpenGLBuffer m_vertexBufferStatic;
-    QOpenGLBuffer m_indexBufferStatic;
+    GLBufferRange m_vertexRangeStatic;
+    GLBufferRange m_indexRangeStatic;
     QVector<Vertex> m_verticesStatic;
     QVector<GLuint> m_indexesStatic;
+    GLElementsRanges m_rangesStatic;
     QOpenGLVertexArrayObject m_vaoStatic;
     QOpenGLShaderProgram* m_programStatic;
 
     // OpenGL face
-    QOpenGLBuffer m_vertexBufferFace;
-    QOpenGLBuffer m_indexBufferFace;
+    GLBufferRange m_vertexRangeFace;
+    GLBufferRange m_indexRangeFace;
     QVector<VertexBillboard> m_verticesFace;
     QVector<GLuint> m_indexesFace;
+    GLElementsRanges m_rangesFace;
     QOpenGLVertexArrayObject m_vaoFace;
     QOpenGLShaderProgram* m_programFace;
 };
@@ -0,0 +1,153 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "textureatlas.h"
+
+// Transparent pixels between two pictures, avoiding bleeding at their edges
+const int TextureAtlas::PADDING = 2;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+TextureAtlas::TextureAtlas()
+{
+
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    clear();
+}
+
+bool TextureAtlas::isEmpty() const { return m_rects.isEmpty(); }
+
+int TextureAtlas::pagesCount() const { return m_pagesSizes.size(); }
+
+QOpenGLTexture* TextureAtlas::texture(int page) const {
+    return m_textures.value(page);
+}
+
+void TextureAtlas::setTexture(int page, QOpenGLTexture* texture) {
+    m_textures[page] = texture;
+}
+
+QSize TextureAtlas::pageSize(int page) const {
+    return m_pagesSizes.value(page);
+}
+
+bool TextureAtlas::contains(int id) const { return m_rects.contains(id); }
+
+int TextureAtlas::page(int id) const { return m_pages.value(id); }
+
+QRect TextureAtlas::rect(int id) const { return m_rects.value(id); }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+void TextureAtlas::addPicture(int id, const QSize& size) {
+    m_sizes[id] = size;
+}
+
+// -------------------------------------------------------
+
+void TextureAtlas::build(int pageSize) {
+
+    // Place the highest pictures first, row by row (shelves)
+    QList<QPair<int, QSize>> pictures;
+    QHash<int, QSize>::const_iterator i;
+    for (i = m_sizes.begin(); i != m_sizes.end(); i++)
+        pictures.append(QPair<int, QSize>(i.key(), i.value()));
+    qSort(pictures.begin(), pictures.end(), TextureAtlas::isHigher);
+
+    int page = -1, x = 0, y = 0, shelfHeight = 0;
+    for (int j = 0; j < pictures.size(); j++) {
+        int id = pictures.at(j).first;
+        QSize size = pictures.at(j).second;
+
+        // A picture bigger than a page gets its own page, of its size
+        if (size.width() > pageSize || size.height() > pageSize) {
+            m_pages[id] = m_pagesSizes.size();
+            m_rects[id] = QRect(QPoint(0, 0), size);
+            m_pagesSizes.append(size);
+            continue;
+        }
+
+        // Next shelf, or next page
+        if (page != -1 && x > 0 && x + size.width() > pageSize) {
+            x = 0;
+            y += shelfHeight + PADDING;
+            shelfHeight = 0;
+        }
+        if (page == -1 || y + size.height() > pageSize) {
+            page = m_pagesSizes.size();
+            m_pagesSizes.append(QSize(0, 0));
+            x = 0;
+            y = 0;
+            shelfHeight = 0;
+        }
+
+        m_pages[id] = page;
+        m_rects[id] = QRect(QPoint(x, y), size);
+        x += size.width() + PADDING;
+        shelfHeight = qMax(shelfHeight, size.height());
+        m_pagesSizes[page] = m_pagesSizes.at(page).expandedTo(
+                    QSize(x, y + size.height()));
+    }
+
+    // No texture until given by the map
+    for (int j = 0; j < m_pagesSizes.size(); j++)
+        m_textures.append(nullptr);
+    m_sizes.clear();
+}
+
+// -------------------------------------------------------
+
+void TextureAtlas::clear() {
+    m_textures.clear();
+    m_pagesSizes.clear();
+    m_sizes.clear();
+    m_pages.clear();
+    m_rects.clear();
+}
+
+// -------------------------------------------------------
+
+bool TextureAtlas::isHigher(const QPair<int, QSize>& a,
+                            const QPair<int, QSize>& b)
+{
+    return a.second.height() > b.second.height();
+}
+
+// -------------------------------------------------------
+
+void TextureAtlas::remap(int id, QVector2D& tex) const {
+    QRect rect = m_rects.value(id);
+    QOpenGLTexture* texture = m_textures.value(m_pages.value(id));
+    if (texture == nullptr)
+        return;
+
+    tex.setX((rect.x() + tex.x() * rect.width()) / texture->width());
+    tex.setY((rect.y() + tex.y() * rect.height()) / texture->height());
+}
@@ -0,0 +1,72 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <QHash>
+#include <QSize>
+#include <QRect>
+#include <QVector2D>
+#include <QOpenGLTexture>
+
+// -------------------------------------------------------
+//
+//  CLASS TextureAtlas
+//
+//  Pictures packed in one or a few big textures (pages), so that all the
+//  elements using these pictures can be drawn with one texture bind. The
+//  texture coordinates computed for a single picture are remapped to its
+//  place in the page. A picture bigger than a page has its own page. The
+//  pages are placed from the pictures sizes only, their textures being given
+//  afterwards (they are owned by the project textures cache).
+//
+// -------------------------------------------------------
+
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+    virtual ~TextureAtlas();
+    static const int PADDING;
+    bool isEmpty() const;
+    int pagesCount() const;
+    QOpenGLTexture* texture(int page) const;
+    void setTexture(int page, QOpenGLTexture* texture);
+    QSize pageSize(int page) const;
+    bool contains(int id) const;
+    int page(int id) const;
+    QRect rect(int id) const;
+    void addPicture(int id, const QSize& size);
+    void build(int pageSize);
+    void clear();
+    void remap(int id, QVector2D& tex) const;
+
+protected:
+    QHash<int, QSize> m_sizes;
+    QHash<int, int> m_pages;
+    QHash<int, QRect> m_rects;
+    QList<QSize> m_pagesSizes;
+    QList<QOpenGLTexture*> m_textures;
+
+    static bool isHigher(const QPair<int, QSize>& a,
+                         const QPair<int, QSize>& b);
+};
+
+#endif // TEXTUREATLAS_H
@@ -25,14 +25,15 @@
 //
 // -------------------------------------------------------
 
-TextureAutotile::TextureAutotile()
+TextureAutotile::TextureAutotile() :
+    m_texture(nullptr)
 {
 
 }
 
 TextureAutotile::~TextureAutotile()
 {
-    delete m_texture;
+
 }
 
 QOpenGLTexture* TextureAutotile::texture() {
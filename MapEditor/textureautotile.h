@@ -26,7 +26,8 @@
 //
 //  CLASS TextureAutotile
 //
-//  A texture for an autotile.
+//  A texture for an autotile. The texture is owned by the project textures
+//  cache.
 //
 // -------------------------------------------------------
 
@@ -0,0 +1,145 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "texturecomposition.h"
+#include "map.h"
+#include <QImageReader>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QPainter>
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+TextureComposition::TextureComposition(const QSize& size) :
+    m_size(size.isEmpty() ? QSize(1, 1) : size)
+{
+
+}
+
+TextureComposition::~TextureComposition()
+{
+
+}
+
+QSize TextureComposition::size() const { return m_size; }
+
+bool TextureComposition::isEmpty() const { return m_paths.isEmpty(); }
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+QString TextureComposition::key() const {
+    QString key = QString::number(m_size.width()) + "x" +
+            QString::number(m_size.height());
+
+    // A picture modified on the disk gives another key
+    for (int i = 0; i < m_paths.size(); i++) {
+        const QString& path = m_paths.at(i);
+        const QPoint& point = m_points.at(i);
+        key += "|" + path + "|" +
+                QString::number(QFileInfo(path).lastModified()
+                                .toMSecsSinceEpoch()) + "|" +
+                QString::number(static_cast<int>(m_kinds.at(i))) + "|" +
+                QString::number(point.x()) + "," +
+                QString::number(point.y()) + "|" +
+                QString::number(m_offsets.at(i));
+    }
+
+    return key;
+}
+
+// -------------------------------------------------------
+
+QSize TextureComposition::pictureSize(const QString& path, PictureKind kind,
+                                      int squareSize)
+{
+    if (path.isEmpty())
+        return QSize();
+
+    // Only the header of the picture is read
+    QImageReader reader(path);
+    QSize size = reader.size();
+    if (!size.isValid() && reader.canRead())
+        size = reader.read().size();
+    if (size.isValid() && kind == PictureKind::Walls)
+        size.rwidth() += squareSize;
+
+    return size;
+}
+
+// -------------------------------------------------------
+
+void TextureComposition::addPicture(const QString& path, PictureKind kind,
+                                    const QPoint& point, int offset)
+{
+    m_paths.append(path);
+    m_kinds.append(kind);
+    m_points.append(point);
+    m_offsets.append(offset);
+}
+
+// -------------------------------------------------------
+
+QImage TextureComposition::compose(int squareSize) const {
+    QHash<QString, QImage> images;
+    QImage image(m_size, QImage::Format_ARGB32);
+    image.fill(QColor(0, 0, 0, 0));
+
+    QPainter painter;
+    painter.begin(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int i = 0; i < m_paths.size(); i++) {
+
+        // Each picture is decoded once, even if drawn several times
+        QString path = m_paths.at(i);
+        if (!images.contains(path))
+            images.insert(path, QImage(path));
+        QImage picture = images.value(path);
+        if (picture.isNull())
+            continue;
+
+        QPoint point = m_points.at(i);
+        switch (m_kinds.at(i)) {
+        case PictureKind::Walls:
+        {
+            QImage wall;
+            Map::editPictureWall(picture, wall);
+            painter.drawImage(point, wall);
+            break;
+        }
+        case PictureKind::Autotiles:
+            Map::paintPictureAutotile(painter, picture, m_offsets.at(i), point,
+                                      squareSize);
+            break;
+        default:
+            painter.drawImage(point, picture);
+            break;
+        }
+    }
+    painter.end();
+
+    return image.convertToFormat(QImage::Format_RGBA8888);
+}
@@ -0,0 +1,65 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEXTURECOMPOSITION_H
+#define TEXTURECOMPOSITION_H
+
+#include <QImage>
+#include <QList>
+#include <QPoint>
+#include <QSize>
+#include <QStringList>
+#include "picturekind.h"
+
+// -------------------------------------------------------
+//
+//  CLASS TextureComposition
+//
+//  The pictures drawn in one texture of a map, described by their paths and
+//  places only. The size of the texture is known without reading any
+//  picture, the pixels being decoded and composed later (in a loader
+//  thread). The kind of a picture tells how it is drawn: walls get their
+//  borders, autotiles are drawn as every combination of their corners.
+//
+// -------------------------------------------------------
+
+class TextureComposition
+{
+public:
+    TextureComposition(const QSize& size = QSize(1, 1));
+    virtual ~TextureComposition();
+    QSize size() const;
+    bool isEmpty() const;
+    QString key() const;
+    static QSize pictureSize(const QString& path, PictureKind kind,
+                             int squareSize);
+
+    void addPicture(const QString& path, PictureKind kind,
+                    const QPoint& point, int offset = 0);
+    QImage compose(int squareSize) const;
+
+protected:
+    QSize m_size;
+    QStringList m_paths;
+    QList<PictureKind> m_kinds;
+    QList<QPoint> m_points;
+    QList<int> m_offsets;
+};
+
+#endif // TEXTURECOMPOSITION_H
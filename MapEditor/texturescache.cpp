@@ -0,0 +1,142 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "texturescache.h"
+
+// Bytes of the unused textures kept for the next loaded maps
+const qint64 TexturesCache::MAX_UNUSED_SIZE = 256 * 1024 * 1024;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+TexturesCache::TexturesCache() :
+    m_unusedSize(0)
+{
+
+}
+
+TexturesCache::~TexturesCache()
+{
+    clear();
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+QOpenGLTexture* TexturesCache::acquire(const QString& key) {
+    QOpenGLTexture* texture = m_textures.value(key);
+    if (texture == nullptr || !m_loaded.value(texture))
+        return nullptr;
+
+    if (m_references.value(texture) == 0) {
+        m_unused.removeOne(texture);
+        m_unusedSize -= textureSize(texture);
+    }
+    m_references[texture]++;
+
+    return texture;
+}
+
+// -------------------------------------------------------
+
+void TexturesCache::add(const QString& key, QOpenGLTexture* texture) {
+
+    // Already loading for another map: this texture is only used by its map
+    if (m_textures.contains(key))
+        return;
+
+    m_textures.insert(key, texture);
+    m_keys.insert(texture, key);
+    m_references.insert(texture, 1);
+    m_loaded.insert(texture, false);
+}
+
+// -------------------------------------------------------
+
+void TexturesCache::setLoaded(QOpenGLTexture* texture) {
+    if (m_loaded.contains(texture))
+        m_loaded[texture] = true;
+}
+
+// -------------------------------------------------------
+
+void TexturesCache::release(QOpenGLTexture* texture) {
+    if (texture == nullptr)
+        return;
+
+    // Not shared
+    if (!m_keys.contains(texture)) {
+        delete texture;
+        return;
+    }
+
+    int references = m_references.value(texture) - 1;
+    m_references[texture] = references;
+    if (references > 0)
+        return;
+
+    // A texture never loaded would stay transparent
+    if (!m_loaded.value(texture)) {
+        remove(texture);
+        return;
+    }
+
+    m_unused.append(texture);
+    m_unusedSize += textureSize(texture);
+    while (m_unusedSize > MAX_UNUSED_SIZE && !m_unused.isEmpty()) {
+        QOpenGLTexture* oldest = m_unused.takeFirst();
+        m_unusedSize -= textureSize(oldest);
+        remove(oldest);
+    }
+}
+
+// -------------------------------------------------------
+
+void TexturesCache::clear() {
+    QHash<QString, QOpenGLTexture*>::iterator i;
+    for (i = m_textures.begin(); i != m_textures.end(); i++)
+        delete *i;
+    m_textures.clear();
+    m_keys.clear();
+    m_references.clear();
+    m_loaded.clear();
+    m_unused.clear();
+    m_unusedSize = 0;
+}
+
+// -------------------------------------------------------
+
+qint64 TexturesCache::textureSize(QOpenGLTexture* texture) {
+    return static_cast<qint64>(texture->width()) * texture->height() * 4;
+}
+
+// -------------------------------------------------------
+
+void TexturesCache::remove(QOpenGLTexture* texture) {
+    m_textures.remove(m_keys.take(texture));
+    m_references.remove(texture);
+    m_loaded.remove(texture);
+    delete texture;
+}
@@ -0,0 +1,66 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEXTURESCACHE_H
+#define TEXTURESCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QOpenGLTexture>
+
+// -------------------------------------------------------
+//
+//  CLASS TexturesCache
+//
+//  The textures of the maps of a project, shared between the maps using
+//  the same pictures (see TextureComposition::key). A texture is counted
+//  for each map using it. Once not used anymore, it is kept for the next
+//  loaded map while the unused textures are small enough, the oldest being
+//  deleted first. Only the textures with their image uploaded are shared.
+//
+// -------------------------------------------------------
+
+class TexturesCache
+{
+public:
+    TexturesCache();
+    virtual ~TexturesCache();
+    static const qint64 MAX_UNUSED_SIZE;
+
+    QOpenGLTexture* acquire(const QString& key);
+    void add(const QString& key, QOpenGLTexture* texture);
+    void setLoaded(QOpenGLTexture* texture);
+    void release(QOpenGLTexture* texture);
+    void clear();
+
+protected:
+    QHash<QString, QOpenGLTexture*> m_textures;
+    QHash<QOpenGLTexture*, QString> m_keys;
+    QHash<QOpenGLTexture*, int> m_references;
+    QHash<QOpenGLTexture*, bool> m_loaded;
+
+    // Textures not used by any map, from the oldest
+    QList<QOpenGLTexture*> m_unused;
+    qint64 m_unusedSize;
+
+    static qint64 textureSize(QOpenGLTexture* texture);
+    void remove(QOpenGLTexture* texture);
+};
+
+#endif // TEXTURESCACHE_H
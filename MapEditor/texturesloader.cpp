@@ -0,0 +1,143 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "texturesloader.h"
+#include "threadtextureloader.h"
+#include <QThread>
+
+// Textures uploaded at most in one update, keeping the frames short
+const int TexturesLoader::UPLOADS_PER_UPDATE = 2;
+
+// -------------------------------------------------------
+//
+//  CONSTRUCTOR / DESTRUCTOR / GET / SET
+//
+// -------------------------------------------------------
+
+TexturesLoader::TexturesLoader() :
+    m_lastID(0)
+{
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+TexturesLoader::~TexturesLoader()
+{
+    clear();
+}
+
+bool TexturesLoader::isLoading() const {
+    return !m_textures.isEmpty();
+}
+
+// -------------------------------------------------------
+//
+//  INTERMEDIARY FUNCTIONS
+//
+// -------------------------------------------------------
+
+QOpenGLTexture* TexturesLoader::createTexture(const QSize& size) {
+    QOpenGLTexture* texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+    texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    texture->setSize(qMax(1, size.width()), qMax(1, size.height()));
+    texture->setMipLevels(1);
+    texture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+    texture->setMinificationFilter(QOpenGLTexture::Filter::Nearest);
+    texture->setMagnificationFilter(QOpenGLTexture::Filter::Nearest);
+
+    // Transparent until the real image is uploaded
+    QByteArray pixels(texture->width() * texture->height() * 4, 0);
+    texture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8,
+                     pixels.constData());
+
+    return texture;
+}
+
+// -------------------------------------------------------
+
+void TexturesLoader::load(QOpenGLTexture* texture,
+                          const TextureComposition& composition,
+                          int squareSize)
+{
+    if (composition.isEmpty())
+        return;
+
+    int id = ++m_lastID;
+    m_textures.insert(id, texture);
+    m_pool.start(new ThreadTextureLoader(this, id, composition, squareSize));
+}
+
+// -------------------------------------------------------
+
+void TexturesLoader::cancel(QOpenGLTexture* texture) {
+    QHash<int, QOpenGLTexture*>::iterator i = m_textures.begin();
+    while (i != m_textures.end()) {
+        if (i.value() == texture)
+            i = m_textures.erase(i);
+        else
+            i++;
+    }
+}
+
+// -------------------------------------------------------
+
+void TexturesLoader::clear() {
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_textures.clear();
+    m_mutex.lock();
+    m_images.clear();
+    m_mutex.unlock();
+}
+
+// -------------------------------------------------------
+
+QList<QOpenGLTexture*> TexturesLoader::update() {
+    QList<QPair<int, QImage>> images;
+    QList<QOpenGLTexture*> textures;
+
+    m_mutex.lock();
+    if (m_textures.isEmpty())
+        m_images.clear();
+    for (int i = 0; i < UPLOADS_PER_UPDATE && !m_images.isEmpty(); i++)
+        images.append(m_images.takeFirst());
+    m_mutex.unlock();
+
+    // The images of cancelled textures are dropped
+    for (int i = 0; i < images.size(); i++) {
+        QOpenGLTexture* texture = m_textures.take(images.at(i).first);
+        const QImage& image = images.at(i).second;
+        if (texture != nullptr && image.width() == texture->width() &&
+            image.height() == texture->height())
+        {
+            texture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8,
+                             image.constBits());
+            textures.append(texture);
+        }
+    }
+
+    return textures;
+}
+
+// -------------------------------------------------------
+
+void TexturesLoader::setImage(int id, const QImage& image) {
+    m_mutex.lock();
+    m_images.append(QPair<int, QImage>(id, image));
+    m_mutex.unlock();
+}
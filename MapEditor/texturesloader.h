@@ -0,0 +1,66 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEXTURESLOADER_H
+#define TEXTURESLOADER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QOpenGLTexture>
+#include <QThreadPool>
+#include "texturecomposition.h"
+
+// -------------------------------------------------------
+//
+//  CLASS TexturesLoader
+//
+//  Decode and compose the textures of a map in a pool of threads. The
+//  textures are created right away with their final size (so that the
+//  portions vertices can be computed) and stay transparent until their
+//  image is uploaded, a few textures per update of the map editor.
+//
+// -------------------------------------------------------
+
+class TexturesLoader
+{
+public:
+    TexturesLoader();
+    virtual ~TexturesLoader();
+    static const int UPLOADS_PER_UPDATE;
+    bool isLoading() const;
+    static QOpenGLTexture* createTexture(const QSize& size);
+
+    void load(QOpenGLTexture* texture, const TextureComposition& composition,
+              int squareSize);
+    void cancel(QOpenGLTexture* texture);
+    void clear();
+    QList<QOpenGLTexture*> update();
+    void setImage(int id, const QImage& image);
+
+protected:
+    QThreadPool m_pool;
+    QHash<int, QOpenGLTexture*> m_textures;
+    int m_lastID;
+
+    // Images composed by the threads, waiting for upload
+    QMutex m_mutex;
+    QList<QPair<int, QImage>> m_images;
+};
+
+#endif // TEXTURESLOADER_H
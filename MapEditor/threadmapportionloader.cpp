@@ -26,9 +26,8 @@
 //
 // -------------------------------------------------------
 
-ThreadMapPortionLoader::ThreadMapPortionLoader(Map *map, MapPortion *mapPortion) :
-    m_map(map),
-    m_mapPortion(mapPortion)
+ThreadMapPortionLoader::ThreadMapPortionLoader(Map *map) :
+    m_map(map)
 {
 
 }
@@ -40,6 +39,11 @@ ThreadMapPortionLoader::ThreadMapPortionLoader(Map *map, MapPortion *mapPortion)
 // -------------------------------------------------------
 
 void ThreadMapPortionLoader::run() {
-    m_map->loadPortionThread(m_mapPortion);
-    m_mapPortion->setIsLoaded(true);
+    MapPortion* mapPortion;
+
+    // Returns nullptr only when the map is stopping the loaders
+    while ((mapPortion = m_map->takePortionToLoad()) != nullptr) {
+        m_map->loadPortionThread(mapPortion);
+        m_map->setPortionThreadLoaded(mapPortion);
+    }
 }
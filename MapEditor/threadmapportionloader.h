@@ -23,13 +23,14 @@
 #include <QThread>
 
 class Map;
-class MapPortion;
 
 // -------------------------------------------------------
 //
 //  CLASS ThreadMapPortionLoader
 //
-//  A thread used for loading a portion asynchronously.
+//  A worker thread of the map portions loading pool. It takes the portions
+//  queued by the map, reads them and computes their vertices. The GL
+//  buffers are then created by the map in the GL thread.
 //
 // -------------------------------------------------------
 
@@ -37,18 +38,10 @@ class ThreadMapPortionLoader : public QThread
 {
     Q_OBJECT
 public:
-    ThreadMapPortionLoader(Map* map, MapPortion* mapPortion);
+    ThreadMapPortionLoader(Map* map);
 
 protected:
     Map* m_map;
-    MapPortion* m_mapPortion;
-    /*
-    int m_realX;
-    int m_realY;
-    int m_realZ;
-    int m_x;
-    int m_y;
-    int m_z;*/
 
     void run();
 };
@@ -0,0 +1,54 @@
+/*
+    RPG Paper Maker Copyright (C) 2017 Marie Laporte
+
+    This file is part of RPG Paper Maker.
+
+    RPG Paper Maker is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPG Paper Maker is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef THREADTEXTURELOADER_H
+#define THREADTEXTURELOADER_H
+
+#include <QRunnable>
+#include "texturecomposition.h"
+
+class TexturesLoader;
+
+// -------------------------------------------------------
+//
+//  CLASS ThreadTextureLoader
+//
+//  A task of the textures loading pool. It decodes and composes the
+//  pictures of one texture and gives the image to the loader, which uploads
+//  it later in the OpenGL context.
+//
+// -------------------------------------------------------
+
+class ThreadTextureLoader : public QRunnable
+{
+public:
+    ThreadTextureLoader(TexturesLoader* loader, int id,
+                        const TextureComposition& composition,
+                        int squareSize);
+
+protected:
+    TexturesLoader* m_loader;
+    int m_id;
+    TextureComposition m_composition;
+    int m_squareSize;
+
+    void run();
+};
+
+#endif // THREADTEXTURELOADER_H
@@ -30,7 +30,11 @@
 
 EngineSettings::EngineSettings() :
     m_keyBoardDatas(new KeyBoardDatas),
-    m_zoomPictures(0)
+    m_zoomPictures(0),
+    m_binaryPortions(false),
+    m_maxFPS(60),
+    m_undoRedoMemory(8192),
+    m_portionsCacheMemory(65536)
 {
 
 }
@@ -63,6 +67,42 @@ void EngineSettings::setZoomPictures(int z) {
     write();
 }
 
+bool EngineSettings::binaryPortions() const {
+    return m_binaryPortions;
+}
+
+void EngineSettings::setBinaryPortions(bool b) {
+    m_binaryPortions = b;
+    write();
+}
+
+int EngineSettings::maxFPS() const {
+    return m_maxFPS;
+}
+
+void EngineSettings::setMaxFPS(int fps) {
+    m_maxFPS = fps;
+    write();
+}
+
+int EngineSettings::undoRedoMemory() const {
+    return m_undoRedoMemory;
+}
+
+void EngineSettings::setUndoRedoMemory(int kb) {
+    m_undoRedoMemory = kb;
+    write();
+}
+
+int EngineSettings::portionsCacheMemory() const {
+    return m_portionsCacheMemory;
+}
+
+void EngineSettings::setPortionsCacheMemory(int kb) {
+    m_portionsCacheMemory = kb;
+    write();
+}
+
 // -------------------------------------------------------
 //
 //  INTERMEDIARY FUNCTIONS
@@ -84,6 +124,14 @@ void EngineSettings::read(const QJsonObject &json){
 
     if (json.contains("zp"))
         m_zoomPictures = json["zp"].toInt();
+    if (json.contains("bp"))
+        m_binaryPortions = json["bp"].toBool();
+    if (json.contains("fps"))
+        m_maxFPS = json["fps"].toInt();
+    if (json.contains("urm"))
+        m_undoRedoMemory = json["urm"].toInt();
+    if (json.contains("pcm"))
+        m_portionsCacheMemory = json["pcm"].toInt();
 }
 
 // -------------------------------------------------------
@@ -94,4 +142,8 @@ void EngineSettings::write(QJsonObject &json) const{
     m_keyBoardDatas->write(obj);
     json["kb"] = obj;
     json["zp"] = m_zoomPictures;
+    json["bp"] = m_binaryPortions;
+    json["fps"] = m_maxFPS;
+    json["urm"] = m_undoRedoMemory;
+    json["pcm"] = m_portionsCacheMemory;
 }
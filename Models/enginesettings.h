@@ -40,6 +40,14 @@ public:
     KeyBoardDatas* keyBoardDatas() const;
     int zoomPictures() const;
     void setZoomPictures(int z);
+    bool binaryPortions() const;
+    void setBinaryPortions(bool b);
+    int maxFPS() const;
+    void setMaxFPS(int fps);
+    int undoRedoMemory() const;
+    void setUndoRedoMemory(int kb);
+    int portionsCacheMemory() const;
+    void setPortionsCacheMemory(int kb);
     void setDefault();
 
     virtual void read(const QJsonObject &json);
@@ -48,6 +56,10 @@ public:
 protected:
     KeyBoardDatas* m_keyBoardDatas;
     int m_zoomPictures;
+    bool m_binaryPortions;
+    int m_maxFPS;
+    int m_undoRedoMemory;
+    int m_portionsCacheMemory;
 };
 
 #endif // ENGINESETTINGS_H
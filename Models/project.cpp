@@ -44,7 +44,8 @@ Project::Project() :
     m_picturesDatas(new PicturesDatas),
     m_songsDatas(new SongsDatas),
     m_keyBoardDatas(new KeyBoardDatas),
-    m_specialElementsDatas(new SpecialElementsDatas)
+    m_specialElementsDatas(new SpecialElementsDatas),
+    m_texturesCache(new TexturesCache)
 {
 
 }
@@ -59,6 +60,7 @@ Project::~Project()
     delete m_songsDatas;
     delete m_keyBoardDatas;
     delete m_specialElementsDatas;
+    delete m_texturesCache;
 }
 
 // Gets
@@ -96,6 +98,8 @@ SpecialElementsDatas* Project::specialElementsDatas() const {
     return m_specialElementsDatas;
 }
 
+TexturesCache* Project::texturesCache() const { return m_texturesCache; }
+
 QString Project::version() const { return m_version; }
 
 // -------------------------------------------------------
@@ -117,9 +121,11 @@ void Project::setDefault(){
 
 // -------------------------------------------------------
 
-void Project::saveCurrentMap(){
-    p_currentMap->save();
-    p_currentMap->setSaved(true);
+bool Project::saveCurrentMap(){
+    bool saved = p_currentMap->save();
+    p_currentMap->setSaved(saved);
+
+    return saved;
 }
 
 // -------------------------------------------------------
@@ -29,6 +29,7 @@
 #include "songsdatas.h"
 #include "keyboarddatas.h"
 #include "specialelementsdatas.h"
+#include "texturescache.h"
 #include "oskind.h"
 
 // -------------------------------------------------------
@@ -59,6 +60,7 @@ public:
     SongsDatas* songsDatas() const;
     KeyBoardDatas* keyBoardDatas() const;
     SpecialElementsDatas* specialElementsDatas() const;
+    TexturesCache* texturesCache() const;
     QString version() const;
 
     bool read(QString path);
@@ -89,7 +91,7 @@ public:
     void writeSpecialsDatas();
     void writeSystemDatas();
     void writeTilesetsDatas();
-    void saveCurrentMap();
+    bool saveCurrentMap();
     QString createRPMFile();
 
 private:
@@ -104,6 +106,7 @@ private:
     SongsDatas* m_songsDatas;
     KeyBoardDatas* m_keyBoardDatas;
     SpecialElementsDatas* m_specialElementsDatas;
+    TexturesCache* m_texturesCache;
     QString m_version;
 };
 
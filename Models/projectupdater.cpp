@@ -168,6 +168,38 @@ void ProjectUpdater::copySystemScripts() {
     Common::copyPath(pathScripts, pathProjectScripts);
 }
 
+// -------------------------------------------------------
+
+void ProjectUpdater::convertMapsPortions(QString pathMaps, bool binary) {
+    QDirIterator directories(pathMaps, QDir::Dirs | QDir::NoDotAndDotDot);
+
+    while (directories.hasNext()) {
+        directories.next();
+        QString dirMap = directories.filePath();
+
+        // Binary portions are packed in a single container
+        if (binary)
+            Map::packPortions(dirMap);
+        else {
+            Map::unpackPortions(dirMap, false);
+            QStringList filters;
+            filters << "*.bin";
+            QStringList files = QDir(dirMap).entryList(filters, QDir::Files);
+            for (int i = 0; i < files.size(); i++) {
+                Portion portion;
+                if (Map::getPortionFromFileName(files.at(i), portion)) {
+                    MapPortion mapPortion(portion);
+                    if (Map::readPortion(Common::pathCombine(
+                                             dirMap, files.at(i)), mapPortion))
+                    {
+                        Map::writePortion(dirMap, mapPortion, false);
+                    }
+                }
+            }
+        }
+    }
+}
+
 // -------------------------------------------------------
 //
 //  SLOTS
@@ -202,6 +234,10 @@ void ProjectUpdater::check() {
     emit progress(95, "Copying recent executable and scripts");
     copyExecutable();
     copySystemScripts();
+    emit progress(97, "Converting maps portions...");
+    convertMapsPortions(Common::pathCombine(m_project->pathCurrentProject(),
+                                           Wanok::pathMaps),
+                        Wanok::get()->engineSettings()->binaryPortions());
     emit progress(99, "Correcting the BR path");
     QThread::sleep(1);
     m_project->readLangsDatas();
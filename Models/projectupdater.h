@@ -47,6 +47,7 @@ public:
     void updateVersion(QString& version);
     void copyExecutable();
     void copySystemScripts();
+    static void convertMapsPortions(QString pathMaps, bool binary);
 
 protected:
     Project* m_project;
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include <QDirIterator>
+#include <QSaveFile>
 
 Common::Common()
 {
@@ -40,10 +41,13 @@ QString Common::pathCombine(const QString & p1, const QString & p2){
 void Common::writeOtherJSON(QString path, const QJsonObject &obj,
                            QJsonDocument::JsonFormat format)
 {
-    QFile saveFile(path);
+    // Written next to the file and renamed once synced, so that a crash
+    // never leaves a half written file
+    QSaveFile saveFile(path);
     if (!saveFile.open(QIODevice::WriteOnly)) { return; }
     QJsonDocument saveDoc(obj);
     saveFile.write(saveDoc.toJson(format));
+    saveFile.commit();
 }
 
 // -------------------------------------------------------
@@ -58,10 +62,11 @@ void Common::readOtherJSON(QString path, QJsonDocument& loadDoc){
 // -------------------------------------------------------
 
 void Common::writeArrayJSON(QString path, const QJsonArray &tab){
-    QFile saveFile(path);
+    QSaveFile saveFile(path);
     if (!saveFile.open(QIODevice::WriteOnly)) { return; }
     QJsonDocument saveDoc(tab);
     saveFile.write(saveDoc.toJson(QJsonDocument::Compact));
+    saveFile.commit();
 }
 
 // -------------------------------------------------------
@@ -110,16 +115,25 @@ bool Common::isDirEmpty(QString path){
 
 // -------------------------------------------------------
 
-void Common::copyAllFiles(QString pathSource, QString pathTarget){
+bool Common::copyAllFiles(QString pathSource, QString pathTarget){
     QDirIterator files(pathSource, QDir::Files);
-    QString path;
+    bool copied = true;
 
+    // The target files are replaced at once instead of removed then copied
     while (files.hasNext()){
         files.next();
-        path = Common::pathCombine(pathTarget, files.fileName());
-        QFile::remove(path);
-        QFile::copy(files.filePath(), path);
+        QFile source(files.filePath());
+        QSaveFile target(Common::pathCombine(pathTarget, files.fileName()));
+        if (!source.open(QIODevice::ReadOnly) ||
+            !target.open(QIODevice::WriteOnly) ||
+            target.write(source.readAll()) != source.size() ||
+            !target.commit())
+        {
+            copied = false;
+        }
     }
+
+    return copied;
 }
 
 // -------------------------------------------------------
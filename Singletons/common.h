@@ -38,7 +38,7 @@ public:
     static bool copyPath(QString src, QString dst);
     static QString getDirectoryPath(QString& file);
     static bool isDirEmpty(QString path);
-    static void copyAllFiles(QString pathSource, QString pathTarget);
+    static bool copyAllFiles(QString pathSource, QString pathTarget);
     static void copyAll(QString pathSource, QString pathTarget);
     static void deleteAllFiles(QString pathSource);
     static QString getFormatNumber(int number, int format = 4, int type = 10);
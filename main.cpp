@@ -39,6 +39,9 @@ int main(int argc, char *argv[])
         Wanok::shadersExtension = "";
     #endif
 
+    // The maps textures are shared by all the maps editors
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+
     QApplication a(argc, argv);
 
     //EngineUpdater::writeTrees();